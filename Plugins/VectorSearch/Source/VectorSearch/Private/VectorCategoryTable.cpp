@@ -0,0 +1,49 @@
+#include "VectorCategoryTable.h"
+
+int32 FVectorCategoryTable::Intern(const FString& Category)
+{
+    if (const int32* Existing = Ids.Find(Category))
+    {
+        return *Existing;
+    }
+
+    const int32 NewId = Names.Add(Category);
+    Ids.Add(Category, NewId);
+    return NewId;
+}
+
+int32 FVectorCategoryTable::Find(const FString& Category) const
+{
+    const int32* Existing = Ids.Find(Category);
+    return Existing ? *Existing : INDEX_NONE;
+}
+
+void FVectorCategoryTable::Empty()
+{
+    Names.Empty();
+    Ids.Empty();
+}
+
+FVectorCategoryFilter FVectorCategoryTable::CompileFilter(const TArray<FString>& Categories) const
+{
+    FVectorCategoryFilter Filter;
+    if (Categories.Num() == 0)
+    {
+        return Filter;
+    }
+
+    Filter.bAcceptAll = false;
+    Filter.Bits.Init(false, Names.Num());
+
+    // Names the database has never seen cannot match any row and are simply left out
+    for (const FString& Category : Categories)
+    {
+        const int32 CategoryId = Find(Category);
+        if (CategoryId != INDEX_NONE)
+        {
+            Filter.Bits[CategoryId] = true;
+        }
+    }
+
+    return Filter;
+}
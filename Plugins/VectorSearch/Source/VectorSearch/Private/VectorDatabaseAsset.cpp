@@ -1,13 +1,126 @@
 #include "VectorDatabaseAsset.h"
+#include "VectorDatabaseFile.h"
 #include "JsonObjectConverter.h"
+#include "Algo/AllOf.h"
+#include "Algo/Count.h"
+#include "Async/Async.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "UObject/ObjectSaveContext.h"
+
+/** Change to invalidate every index and quantizer cached by earlier versions of the build code */
+#define VECTORDATABASE_DERIVEDDATA_VER TEXT("3B9F6E1C2D4A4C8E9F0B7A5D1E6C3F28")
+#endif
+
+/** Versions of the sections UVectorDatabaseAsset serializes after its tagged properties */
+struct FVectorDatabaseAssetVersion
+{
+    enum Type
+    {
+        /** Every entry was a tagged property holding its own wrapper object */
+        BeforeCustomVersionWasAdded = 0,
+
+        /** Vectors are stored as bulk data and payloads as native columns */
+        NativeSections,
+
+        /** The index built over the vectors is stored as bulk data */
+        SavedIndex,
+
+        /** The quantizer trained over the vectors is stored as bulk data */
+        SavedQuantizer,
+
+        /** The checksum of the vector block is stored */
+        VectorChecksum,
+
+        /** Editor data stores the settings the saved index and quantizer were built with */
+        SearchStructuresKey,
+
+        VersionPlusOne,
+        LatestVersion = VersionPlusOne - 1
+    };
+
+    static const FGuid GUID;
+};
+
+const FGuid FVectorDatabaseAssetVersion::GUID(0x5C1F3A2E, 0x8B47496D, 0xA0E6D3B1, 0x7F924C58);
+
+static FCustomVersionRegistration GRegisterVectorDatabaseAssetVersion(FVectorDatabaseAssetVersion::GUID, FVectorDatabaseAssetVersion::LatestVersion, TEXT("VectorDatabaseAsset"));
+
+// Helper function to null actor references inside a stored struct value, which cannot be saved with the asset
+void ClearActorReferences(UScriptStruct* StructType, void* StructData)
+{
+    if (!StructType || !StructData)
+    {
+        return;
+    }
+
+    for (TFieldIterator<FProperty> It(StructType); It; ++It)
+    {
+        FProperty* Property = *It;
+
+        if (FStructProperty* StructProp = CastField<FStructProperty>(Property))
+        {
+            ClearActorReferences(StructProp->Struct, StructProp->ContainerPtrToValuePtr<void>(StructData));
+        }
+        else if (FObjectProperty* ObjectProp = CastField<FObjectProperty>(Property))
+        {
+            if (ObjectProp->PropertyClass && ObjectProp->PropertyClass->IsChildOf(AActor::StaticClass())
+                && ObjectProp->GetPropertyValue_InContainer(StructData))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("Actor reference detected in struct '%s' property '%s'. Actor references cannot be safely serialized and will be skipped."),
+                       *StructType->GetName(), *Property->GetName());
+
+                ObjectProp->SetPropertyValue_InContainer(StructData, nullptr);
+            }
+        }
+    }
+}
+
+// Helper functions to move a saved index or quantizer between bulk data and the arrays of a database file
+static void ReadBulkDataBytes(FByteBulkData& BulkData, TArray<uint8>& OutBytes)
+{
+    OutBytes.Reset();
+    if (BulkData.GetBulkDataSize() > 0)
+    {
+        // Payloads that can be read from disk again are dropped from memory once copied
+        void* Bytes = nullptr;
+        BulkData.GetCopy(&Bytes, true);
+        OutBytes.Append(static_cast<const uint8*>(Bytes), BulkData.GetBulkDataSize());
+        FMemory::Free(Bytes);
+    }
+}
+
+static void WriteBulkDataBytes(FByteBulkData& BulkData, const TArray<uint8>& Bytes)
+{
+    BulkData.Lock(LOCK_READ_WRITE);
+    void* Data = BulkData.Realloc(Bytes.Num());
+    FMemory::Memcpy(Data, Bytes.GetData(), Bytes.Num());
+    BulkData.Unlock();
+}
 
 UVectorDatabaseAsset::UVectorDatabaseAsset()
 {
     CreationDate = FDateTime::Now();
     LastModifiedDate = CreationDate;
     VectorDimension = 0;
+    StoragePrecision = EVectorStoragePrecision::Float32;
+    DistanceMetric = EVectorDistanceMetric::Euclidean;
+
+    // Keep the vectors out of the export so they are only read when a database is loaded from the asset
+    VectorBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+    IndexBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+    QuantizerBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+    VectorChecksum = 0;
+
+#if WITH_EDITORONLY_DATA
+    bSearchStructuresCached = false;
+#endif
 }
 
 void UVectorDatabaseAsset::PostInitProperties()
@@ -21,55 +134,100 @@ void UVectorDatabaseAsset::PostInitProperties()
     }
 }
 
-void UVectorDatabaseAsset::SaveFromVectorDatabase(UVectorDatabase* Database)
+void UVectorDatabaseAsset::Serialize(FArchive& Ar)
 {
-    if (!Database)
+    Super::Serialize(Ar);
+
+    Ar.UsingCustomVersion(FVectorDatabaseAssetVersion::GUID);
+    if (Ar.IsLoading() && Ar.CustomVer(FVectorDatabaseAssetVersion::GUID) < FVectorDatabaseAssetVersion::NativeSections)
     {
-        UE_LOG(LogTemp, Error, TEXT("Invalid Database provided to SaveFromVectorDatabase"));
+        // Older assets only have the Entries property, which PostLoad migrates
         return;
     }
 
-    Entries.Empty();
-    Categories.Empty();
-    TArray<FVectorDatabaseEntry> AllEntries = Database->GetAllVectorEntries(TArray<FString>());
+    Ar << RowCategories;
+    Ar << RowNorms;
+    Payloads.Serialize(Ar);
+    VectorBulkData.Serialize(Ar, this);
 
-    // Update metadata
-    LastModifiedDate = FDateTime::Now();
-    VectorDimension = AllEntries.Num() > 0 ? AllEntries[0].Vector.Num() : 0;
+    if (!Ar.IsLoading() || Ar.CustomVer(FVectorDatabaseAssetVersion::GUID) >= FVectorDatabaseAssetVersion::SavedIndex)
+    {
+        IndexBulkData.Serialize(Ar, this);
+    }
 
-    // Process all entries
-    for (const FVectorDatabaseEntry& Entry : AllEntries)
+    if (!Ar.IsLoading() || Ar.CustomVer(FVectorDatabaseAssetVersion::GUID) >= FVectorDatabaseAssetVersion::SavedQuantizer)
     {
-        FVectorDatabaseEntry NewEntry;
-        NewEntry.Distance = Entry.Distance;
-        NewEntry.Vector = Entry.Vector;
+        QuantizerBulkData.Serialize(Ar, this);
+    }
 
-        if (Entry.Entry)
-        {
-            NewEntry.Entry = NewObject<UVectorEntryWrapper>(this);
-            NewEntry.Entry->StringValue = Entry.Entry->StringValue;
-            NewEntry.Entry->ObjectValue = Entry.Entry->ObjectValue;
-            NewEntry.Entry->EntryType = Entry.Entry->EntryType;
-            NewEntry.Entry->Category = Entry.Entry->Category;
+    if (!Ar.IsLoading() || Ar.CustomVer(FVectorDatabaseAssetVersion::GUID) >= FVectorDatabaseAssetVersion::VectorChecksum)
+    {
+        Ar << VectorChecksum;
+    }
 
-            // Add category to our list if it's not empty and not already included
-            if (!NewEntry.Entry->Category.IsEmpty() && !Categories.Contains(NewEntry.Entry->Category))
-            {
-                Categories.Add(NewEntry.Entry->Category);
-            }
+#if WITH_EDITORONLY_DATA
+    if (!Ar.IsFilterEditorOnly() && (!Ar.IsLoading() || Ar.CustomVer(FVectorDatabaseAssetVersion::GUID) >= FVectorDatabaseAssetVersion::SearchStructuresKey))
+    {
+        Ar << SavedSearchStructuresKey;
+    }
+#endif
 
-            if (Entry.Entry->EntryType == EEntryType::Struct && Entry.Entry->StructType)
-            {
-                NewEntry.Entry->StructType = Entry.Entry->StructType;
-                int32 StructSize = Entry.Entry->StructType->GetStructureSize();
-                NewEntry.Entry->StructData.SetNum(StructSize);
-                
-                // Use our safe DeepCopyStruct method to handle actor references
-                DeepCopyStruct(Entry.Entry->StructType, NewEntry.Entry->StructData.GetData(), Entry.Entry->StructData.GetData());
-            }
-        }
+    const auto IsValidCategory = [this](int32 CategoryIndex) { return CategoryIndex == INDEX_NONE || Categories.IsValidIndex(CategoryIndex); };
+    if (Ar.IsLoading() && (Ar.IsError() || RowCategories.Num() != Payloads.Num() || !Algo::AllOf(RowCategories, IsValidCategory)))
+    {
+        UE_LOG(LogTemp, Error, TEXT("UVectorDatabaseAsset::Serialize: The sections of %s are corrupt"), *GetName());
+        RowCategories.Empty();
+        RowNorms.Empty();
+        Payloads.Empty();
+        VectorBulkData.RemoveBulkData();
+        IndexBulkData.RemoveBulkData();
+        QuantizerBulkData.RemoveBulkData();
+        VectorChecksum = 0;
+#if WITH_EDITORONLY_DATA
+        SavedSearchStructuresKey.Empty();
+#endif
+    }
+}
+
+void UVectorDatabaseAsset::PostLoad()
+{
+    Super::PostLoad();
 
-        Entries.Add(NewEntry);
+    if (Entries.Num() > 0)
+    {
+        MigrateEntries();
+    }
+}
+
+void UVectorDatabaseAsset::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+    CastChecked<UVectorDatabaseAsset>(InThis)->Payloads.AddReferencedObjects(Collector);
+
+    Super::AddReferencedObjects(InThis, Collector);
+}
+
+void UVectorDatabaseAsset::SaveFromVectorDatabase(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Invalid Database provided to SaveFromVectorDatabase"));
+        return;
+    }
+
+    FVectorDatabaseFileContents Contents;
+    Database->ExportFileContents(Contents);
+    Contents.DatabaseName = DatabaseName;
+    Contents.Description = Description;
+    Contents.CreationDate = CreationDate;
+    Contents.LastModifiedDate = FDateTime::Now();
+    ApplyFileContents(Contents);
+
+    for (int32 Row = 0; Row < Payloads.Num(); ++Row)
+    {
+        if (Payloads.GetType(Row) == EEntryType::Struct)
+        {
+            ClearActorReferences(Payloads.GetStructType(Row), Payloads.GetMutableStructData(Row));
+        }
     }
 
     // Mark the asset as modified
@@ -78,31 +236,98 @@ void UVectorDatabaseAsset::SaveFromVectorDatabase(UVectorDatabase* Database)
 
 UVectorDatabase* UVectorDatabaseAsset::LoadToVectorDatabase() const
 {
-    UVectorDatabase* Database = NewObject<UVectorDatabase>();
+    return CreateVectorDatabase(nullptr);
+}
 
-    for (const FVectorDatabaseEntry& Entry : Entries)
+void UVectorDatabaseAsset::LoadToVectorDatabaseAsync(const FOnVectorDatabaseLoaded& OnLoaded)
+{
+    // Blocks already in memory, or never written to a package, have nothing to stream
+    if (VectorBulkData.GetBulkDataSize() == 0 || VectorBulkData.IsBulkDataLoaded() || !VectorBulkData.CanLoadFromDisk())
+    {
+        OnLoaded.ExecuteIfBound(LoadToVectorDatabase());
+        return;
+    }
+
+    TWeakObjectPtr<UVectorDatabaseAsset> WeakThis(this);
+    const int64 StreamedSize = VectorBulkData.GetBulkDataSize();
+    const uint64 StreamedChecksum = VectorChecksum;
+    FBulkDataIORequestCallBack OnRowsRead = [WeakThis, OnLoaded, StreamedSize, StreamedChecksum](bool bWasCancelled, IBulkDataIORequest* Request)
     {
-        if (Entry.Entry)
+        // The read finishes on an IO thread, while databases are objects created on the game thread
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, OnLoaded, StreamedSize, StreamedChecksum, bWasCancelled, Request]()
         {
-            UVectorEntryWrapper* NewEntry = NewObject<UVectorEntryWrapper>(Database);
-            NewEntry->StringValue = Entry.Entry->StringValue;
-            NewEntry->ObjectValue = Entry.Entry->ObjectValue;
-            NewEntry->EntryType = Entry.Entry->EntryType;
-            NewEntry->Category = Entry.Entry->Category;
+            Request->WaitCompletion();
+            uint8* Rows = bWasCancelled ? nullptr : Request->GetReadResults();
+            delete Request;
 
-            if (Entry.Entry->EntryType == EEntryType::Struct && Entry.Entry->StructType)
+            if (UVectorDatabaseAsset* Asset = WeakThis.Get())
             {
-                NewEntry->StructType = Entry.Entry->StructType;
-                int32 StructSize = Entry.Entry->StructType->GetStructureSize();
-                NewEntry->StructData.SetNum(StructSize);
-                
-                // Use our safe DeepCopyStruct method to handle actor references
-                DeepCopyStruct(Entry.Entry->StructType, NewEntry->StructData.GetData(), Entry.Entry->StructData.GetData());
+                // Rows streamed before the asset was saved over no longer match its payloads
+                const bool bRowsCurrent = Rows && Asset->VectorBulkData.GetBulkDataSize() == StreamedSize && Asset->VectorChecksum == StreamedChecksum;
+                OnLoaded.ExecuteIfBound(bRowsCurrent ? Asset->CreateVectorDatabase(Rows) : Asset->LoadToVectorDatabase());
             }
 
-            Database->AddEntry(Entry.Vector, NewEntry, NewEntry->Category);
+            // The streamed rows belong to whoever takes them from the request
+            FMemory::Free(Rows);
+        });
+    };
+
+    if (!VectorBulkData.CreateStreamingRequest(AIOP_Normal, &OnRowsRead, nullptr))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("LoadToVectorDatabaseAsync: Could not stream the vector data of %s, loading it synchronously"), *GetName());
+        OnLoaded.ExecuteIfBound(LoadToVectorDatabase());
+    }
+}
+
+UVectorDatabase* UVectorDatabaseAsset::CreateVectorDatabase(const uint8* StreamedRows) const
+{
+    UVectorDatabase* Database = NewObject<UVectorDatabase>();
+    Database->SetStoragePrecision(StoragePrecision);
+    Database->SetDistanceMetric(DistanceMetric);
+
+    FVectorDatabaseFileContents Contents;
+    if (!GatherFileContents(Contents, StreamedRows))
+    {
+        UE_LOG(LogTemp, Error, TEXT("LoadToVectorDatabase: The vector data of %s does not match its entries"), *GetName());
+        return Database;
+    }
+
+#if WITH_EDITOR
+    // The saved structures are restored as long as they were built for the current settings. Once the settings changed,
+    // editor loads share the structures cooks cache, so they are built once rather than on every load.
+    FString SearchStructuresKey;
+    bool bFetched = false;
+    if (HasSearchStructures())
+    {
+        if (Contents.VectorChecksum == 0)
+        {
+            // Assets saved before the checksum was stored are hashed once; the reset below reuses the result
+            Contents.VectorChecksum = Contents.Vectors.ComputeChecksum();
+        }
+
+        const FString Key = GetSearchStructuresKey(Contents.VectorChecksum);
+        if (Key != SavedSearchStructuresKey)
+        {
+            // The saved structures may have been built with other parameters, so they are only replaced, never restored
+            Contents.IndexData.Empty();
+            Contents.QuantizerData.Empty();
+            SearchStructuresKey = Key;
+            bFetched = FetchSearchStructures(SearchStructuresKey, Contents);
         }
     }
+#endif
+
+    // The copied sections are taken over whole, so no entry is added one at a time
+    Database->ResetFromFileContents(Contents);
+
+#if WITH_EDITOR
+    if (!SearchStructuresKey.IsEmpty() && !bFetched)
+    {
+        TArray<uint8> IndexData;
+        TArray<uint8> QuantizerData;
+        StoreSearchStructures(SearchStructuresKey, *Database, Contents.VectorChecksum, IndexData, QuantizerData);
+    }
+#endif
 
     return Database;
 }
@@ -405,7 +630,204 @@ void DeserializeJsonToStruct(UScriptStruct* StructType, void* StructData, const
     }
 }
 
+bool UVectorDatabaseAsset::LoadVectors(FVectorStorage& OutVectors, const uint8* StreamedRows) const
+{
+    OutVectors.Empty();
+    OutVectors.SetPrecision(StoragePrecision);
+
+    const int32 NumRows = Payloads.Num();
+    if (NumRows == 0)
+    {
+        return true;
+    }
+
+    if (VectorDimension <= 0)
+    {
+        return false;
+    }
+
+    OutVectors.SetDimension(VectorDimension);
+    if (VectorBulkData.GetBulkDataSize() != static_cast<int64>(NumRows) * OutVectors.GetStrideInBytes())
+    {
+        OutVectors.Empty();
+        return false;
+    }
+
+    const TArrayView<const float> Norms = RowNorms.Num() == NumRows ? TArrayView<const float>(RowNorms) : TArrayView<const float>();
+    if (StreamedRows)
+    {
+        OutVectors.CopyRawData(StreamedRows, VectorDimension, NumRows, Norms);
+        return true;
+    }
+
+    // Reads the bulk data from disk if needed. Payloads that can be read again are dropped from memory once copied,
+    // so the asset does not keep a second copy of every row alongside the databases loaded from it.
+    void* Rows = nullptr;
+    VectorBulkData.GetCopy(&Rows, true);
+    OutVectors.CopyRawData(static_cast<const uint8*>(Rows), VectorDimension, NumRows, Norms);
+    FMemory::Free(Rows);
+
+    return true;
+}
+
+bool UVectorDatabaseAsset::GatherFileContents(FVectorDatabaseFileContents& OutContents, const uint8* StreamedRows) const
+{
+    OutContents.DatabaseName = DatabaseName;
+    OutContents.Description = Description;
+    OutContents.CreationDate = CreationDate;
+    OutContents.LastModifiedDate = LastModifiedDate;
+    OutContents.DistanceMetric = DistanceMetric;
+    OutContents.Categories = Categories;
+    OutContents.RowCategories = RowCategories;
+    OutContents.Payloads = Payloads;
+    OutContents.IndexSettings = IndexSettings;
+    OutContents.QuantizationSettings = QuantizationSettings;
+    OutContents.VectorChecksum = VectorChecksum;
+    ReadBulkDataBytes(IndexBulkData, OutContents.IndexData);
+    ReadBulkDataBytes(QuantizerBulkData, OutContents.QuantizerData);
+
+    return LoadVectors(OutContents.Vectors, StreamedRows);
+}
+
+void UVectorDatabaseAsset::ApplyFileContents(FVectorDatabaseFileContents& Contents)
+{
+    DatabaseName = Contents.DatabaseName;
+    Description = Contents.Description;
+    CreationDate = Contents.CreationDate;
+    LastModifiedDate = Contents.LastModifiedDate;
+    DistanceMetric = Contents.DistanceMetric;
+    StoragePrecision = Contents.Vectors.GetPrecision();
+    VectorDimension = Contents.Vectors.GetDimension();
+    Categories = MoveTemp(Contents.Categories);
+    RowCategories = MoveTemp(Contents.RowCategories);
+    Payloads = MoveTemp(Contents.Payloads);
+
+    TArrayView<const float> Norms = Contents.Vectors.GetRowNorms();
+    RowNorms.Reset();
+    RowNorms.Append(Norms.GetData(), Norms.Num());
+
+    // Sources that did not save a checksum are hashed once here rather than on every load
+    VectorChecksum = Contents.VectorChecksum != 0 ? Contents.VectorChecksum : Contents.Vectors.ComputeChecksum();
+
+    TArrayView64<const uint8> RawData = Contents.Vectors.GetRawData();
+    VectorBulkData.Lock(LOCK_READ_WRITE);
+    void* Rows = VectorBulkData.Realloc(RawData.Num());
+    FMemory::Memcpy(Rows, RawData.GetData(), RawData.Num());
+    VectorBulkData.Unlock();
+
+    IndexSettings = Contents.IndexSettings;
+    QuantizationSettings = Contents.QuantizationSettings;
+    WriteBulkDataBytes(IndexBulkData, Contents.IndexData);
+    WriteBulkDataBytes(QuantizerBulkData, Contents.QuantizerData);
+
+#if WITH_EDITOR
+    // Sources without saved structures, such as JSON imports, leave them to be fetched or built on the next load
+    SavedSearchStructuresKey = Contents.IndexData.Num() > 0 || Contents.QuantizerData.Num() > 0 ? GetSearchStructuresKey(VectorChecksum) : FString();
+#endif
+
+    Contents.Vectors.Empty();
+    Contents.IndexData.Empty();
+    Contents.QuantizerData.Empty();
+    Entries.Empty();
+
+#if WITH_EDITORONLY_DATA
+    bSearchStructuresCached = false;
+#endif
+}
+
+void UVectorDatabaseAsset::MigrateEntries()
+{
+    FVectorDatabaseFileContents Contents;
+    Contents.DatabaseName = DatabaseName;
+    Contents.Description = Description;
+    Contents.CreationDate = CreationDate;
+    Contents.LastModifiedDate = LastModifiedDate;
+    Contents.DistanceMetric = DistanceMetric;
+    Contents.IndexSettings = IndexSettings;
+    Contents.QuantizationSettings = QuantizationSettings;
+    Contents.Categories = Categories;
+
+    TMap<FString, int32> CategoryIndices;
+    for (int32 CategoryIndex = 0; CategoryIndex < Categories.Num(); ++CategoryIndex)
+    {
+        CategoryIndices.Add(Categories[CategoryIndex], CategoryIndex);
+    }
+
+    FVectorStorage& Vectors = Contents.Vectors;
+    Vectors.SetPrecision(StoragePrecision);
+    Vectors.SetDimension(VectorDimension);
+    Vectors.Reserve(Entries.Num());
+    Contents.Payloads.Reserve(Entries.Num());
+    Contents.RowCategories.Reserve(Entries.Num());
+
+    for (const FVectorDatabaseEntry& Entry : Entries)
+    {
+        if (!Entry.Entry)
+        {
+            continue;
+        }
+
+        if (Vectors.Add(Entry.Vector) == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("UVectorDatabaseAsset::PostLoad: Skipping an entry of %s whose vector does not match the database dimension"), *GetName());
+            continue;
+        }
+
+        Contents.Payloads.AddFromWrapper(*Entry.Entry);
+
+        const FString& Category = Entry.Entry->Category;
+        if (Category.IsEmpty())
+        {
+            Contents.RowCategories.Add(INDEX_NONE);
+        }
+        else if (const int32* CategoryIndex = CategoryIndices.Find(Category))
+        {
+            Contents.RowCategories.Add(*CategoryIndex);
+        }
+        else
+        {
+            Contents.RowCategories.Add(CategoryIndices.Add(Category, Contents.Categories.Add(Category)));
+        }
+    }
+
+    // The wrapper objects are dropped with Entries; saving the asset again writes the sections instead
+    ApplyFileContents(Contents);
+}
+
 bool UVectorDatabaseAsset::SaveToFile(const FString& FilePath)
+{
+    FVectorDatabaseFileContents Contents;
+    if (!GatherFileContents(Contents))
+    {
+        UE_LOG(LogTemp, Error, TEXT("SaveToFile: The vector data of %s does not match its entries"), *GetName());
+        return false;
+    }
+    return VectorDatabaseFile::Save(FilePath, Contents);
+}
+
+bool UVectorDatabaseAsset::LoadFromFile(const FString& FilePath)
+{
+    if (!VectorDatabaseFile::IsDatabaseFile(FilePath))
+    {
+        UE_LOG(LogTemp, Log, TEXT("LoadFromFile: %s is not a binary database file, reading it as JSON"), *FilePath);
+        return ImportFromJsonFile(FilePath);
+    }
+
+    FVectorDatabaseFileContents Contents;
+    if (!VectorDatabaseFile::Load(FilePath, Contents))
+    {
+        return false;
+    }
+
+    ApplyFileContents(Contents);
+
+    // Mark the asset as modified
+    MarkPackageDirty();
+
+    return true;
+}
+
+bool UVectorDatabaseAsset::ExportToJsonFile(const FString& FilePath)
 {
     // Create a JSON object to store our data
     TSharedPtr<FJsonObject> JsonObject = MakeShared<FJsonObject>();
@@ -416,6 +838,8 @@ bool UVectorDatabaseAsset::SaveToFile(const FString& FilePath)
     JsonObject->SetStringField(TEXT("CreationDate"), CreationDate.ToString());
     JsonObject->SetStringField(TEXT("LastModifiedDate"), LastModifiedDate.ToString());
     JsonObject->SetNumberField(TEXT("VectorDimension"), VectorDimension);
+    JsonObject->SetNumberField(TEXT("StoragePrecision"), static_cast<int32>(StoragePrecision));
+    JsonObject->SetNumberField(TEXT("DistanceMetric"), static_cast<int32>(DistanceMetric));
     
     // Add categories
     TArray<TSharedPtr<FJsonValue>> CategoriesArray;
@@ -425,46 +849,52 @@ bool UVectorDatabaseAsset::SaveToFile(const FString& FilePath)
     }
     JsonObject->SetArrayField(TEXT("Categories"), CategoriesArray);
     
+    FVectorStorage Vectors;
+    if (!LoadVectors(Vectors))
+    {
+        UE_LOG(LogTemp, Error, TEXT("ExportToJsonFile: The vector data of %s does not match its entries"), *GetName());
+        return false;
+    }
+
     // Add entries
     TArray<TSharedPtr<FJsonValue>> EntriesArray;
-    for (const FVectorDatabaseEntry& Entry : Entries)
+    for (int32 Row = 0; Row < Payloads.Num(); ++Row)
     {
         TSharedPtr<FJsonObject> EntryObject = MakeShared<FJsonObject>();
         
         // Add vector data
         TArray<TSharedPtr<FJsonValue>> VectorArray;
-        for (float Value : Entry.Vector)
+        for (float Value : Vectors.CopyRow(Row))
         {
             VectorArray.Add(MakeShared<FJsonValueNumber>(Value));
         }
         EntryObject->SetArrayField(TEXT("Vector"), VectorArray);
         
-        // Add entry wrapper data if it exists
-        if (Entry.Entry)
+        // Add entry data
+        const EEntryType EntryType = Payloads.GetType(Row);
+        EntryObject->SetStringField(TEXT("EntryType"), FString::FromInt(static_cast<int32>(EntryType)));
+        EntryObject->SetStringField(TEXT("Category"), RowCategories[Row] != INDEX_NONE ? Categories[RowCategories[Row]] : FString());
+        
+        if (EntryType == EEntryType::String)
         {
-            EntryObject->SetStringField(TEXT("EntryType"), FString::FromInt(static_cast<int32>(Entry.Entry->EntryType)));
-            EntryObject->SetStringField(TEXT("Category"), Entry.Entry->Category);
+            EntryObject->SetStringField(TEXT("StringValue"), Payloads.GetString(Row));
+        }
+        else if (EntryType == EEntryType::Struct && Payloads.GetStructType(Row) && Payloads.GetStructData(Row).Num() > 0)
+        {
+            UScriptStruct* StructType = Payloads.GetStructType(Row);
+            EntryObject->SetStringField(TEXT("StructTypeName"), StructType->GetName());
             
-            if (Entry.Entry->EntryType == EEntryType::String)
-            {
-                EntryObject->SetStringField(TEXT("StringValue"), Entry.Entry->StringValue);
-            }
-            else if (Entry.Entry->EntryType == EEntryType::Struct && Entry.Entry->StructType)
-            {
-                EntryObject->SetStringField(TEXT("StructTypeName"), Entry.Entry->StructType->GetName());
-                
-                // Use our safe serialization function for struct data
-                TSharedPtr<FJsonObject> StructJsonObject = MakeShared<FJsonObject>();
-                SerializeStructToJson(Entry.Entry->StructType, Entry.Entry->StructData.GetData(), StructJsonObject);
-                
-                // Convert struct JSON to string
-                FString StructJsonString;
-                TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&StructJsonString);
-                FJsonSerializer::Serialize(StructJsonObject.ToSharedRef(), Writer);
-                
-                // Store the struct JSON as a string
-                EntryObject->SetStringField(TEXT("StructData"), StructJsonString);
-            }
+            // Use our safe serialization function for struct data
+            TSharedPtr<FJsonObject> StructJsonObject = MakeShared<FJsonObject>();
+            SerializeStructToJson(StructType, Payloads.GetStructData(Row).GetData(), StructJsonObject);
+            
+            // Convert struct JSON to string
+            FString StructJsonString;
+            TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&StructJsonString);
+            FJsonSerializer::Serialize(StructJsonObject.ToSharedRef(), Writer);
+            
+            // Store the struct JSON as a string
+            EntryObject->SetStringField(TEXT("StructData"), StructJsonString);
         }
         
         EntriesArray.Add(MakeShared<FJsonValueObject>(EntryObject));
@@ -479,7 +909,7 @@ bool UVectorDatabaseAsset::SaveToFile(const FString& FilePath)
     return FFileHelper::SaveStringToFile(OutputString, *FilePath);
 }
 
-bool UVectorDatabaseAsset::LoadFromFile(const FString& FilePath)
+bool UVectorDatabaseAsset::ImportFromJsonFile(const FString& FilePath)
 {
     // Read the file
     FString JsonString;
@@ -498,33 +928,58 @@ bool UVectorDatabaseAsset::LoadFromFile(const FString& FilePath)
         return false;
     }
     
-    // Clear existing data
-    Entries.Empty();
-    Categories.Empty();
+    FVectorDatabaseFileContents Contents;
     
     // Load metadata
-    DatabaseName = JsonObject->GetStringField(TEXT("DatabaseName"));
-    Description = JsonObject->GetStringField(TEXT("Description"));
+    Contents.DatabaseName = JsonObject->GetStringField(TEXT("DatabaseName"));
+    Contents.Description = JsonObject->GetStringField(TEXT("Description"));
     
     FString CreationDateStr = JsonObject->GetStringField(TEXT("CreationDate"));
-    FDateTime::Parse(CreationDateStr, CreationDate);
+    FDateTime::Parse(CreationDateStr, Contents.CreationDate);
     
     FString LastModifiedDateStr = JsonObject->GetStringField(TEXT("LastModifiedDate"));
-    FDateTime::Parse(LastModifiedDateStr, LastModifiedDate);
-    
-    VectorDimension = JsonObject->GetIntegerField(TEXT("VectorDimension"));
+    FDateTime::Parse(LastModifiedDateStr, Contents.LastModifiedDate);
+
+    // Files written before precision was configurable hold float32 vectors
+    int32 PrecisionValue = static_cast<int32>(EVectorStoragePrecision::Float32);
+    JsonObject->TryGetNumberField(TEXT("StoragePrecision"), PrecisionValue);
+
+    int32 MetricValue = static_cast<int32>(EVectorDistanceMetric::Euclidean);
+    JsonObject->TryGetNumberField(TEXT("DistanceMetric"), MetricValue);
+
+    const int32 Dimension = JsonObject->GetIntegerField(TEXT("VectorDimension"));
+
+    // Range-check the enums like binary files are, so a hand-edited or corrupt file cannot select a storage or kernel that does not exist
+    if (PrecisionValue < 0 || PrecisionValue > static_cast<int32>(EVectorStoragePrecision::BFloat16)
+        || MetricValue < 0 || MetricValue > static_cast<int32>(EVectorDistanceMetric::DotProduct)
+        || Dimension < 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ImportFromJsonFile: %s has an invalid storage precision, distance metric or vector dimension"), *FilePath);
+        return false;
+    }
+
+    Contents.Vectors.SetPrecision(static_cast<EVectorStoragePrecision>(PrecisionValue));
+    Contents.Vectors.SetDimension(Dimension);
+    Contents.DistanceMetric = static_cast<EVectorDistanceMetric>(MetricValue);
+
+    // The index and quantizer are not exported, so databases loaded from the asset build them with the settings it already has
+    Contents.IndexSettings = IndexSettings;
+    Contents.QuantizationSettings = QuantizationSettings;
     
     // Load categories
+    TMap<FString, int32> CategoryIndices;
     const TArray<TSharedPtr<FJsonValue>>* CategoriesArray;
     if (JsonObject->TryGetArrayField(TEXT("Categories"), CategoriesArray))
     {
         for (const TSharedPtr<FJsonValue>& CategoryValue : *CategoriesArray)
         {
-            Categories.Add(CategoryValue->AsString());
+            const FString Category = CategoryValue->AsString();
+            CategoryIndices.Add(Category, Contents.Categories.Add(Category));
         }
     }
     
     // Load entries
+    const TMap<FString, FString> NoMetadata;
     const TArray<TSharedPtr<FJsonValue>>* EntriesArray;
     if (JsonObject->TryGetArrayField(TEXT("Entries"), EntriesArray))
     {
@@ -532,61 +987,87 @@ bool UVectorDatabaseAsset::LoadFromFile(const FString& FilePath)
         {
             TSharedPtr<FJsonObject> EntryObject = EntryValue->AsObject();
             
-            FVectorDatabaseEntry NewEntry;
-            
+            // Entries without entry data have no payload to load
+            if (!EntryObject->HasField(TEXT("EntryType")))
+            {
+                continue;
+            }
+
             // Load vector data
+            TArray<float> Vector;
             const TArray<TSharedPtr<FJsonValue>>* VectorArray;
             if (EntryObject->TryGetArrayField(TEXT("Vector"), VectorArray))
             {
                 for (const TSharedPtr<FJsonValue>& VectorValue : *VectorArray)
                 {
-                    NewEntry.Vector.Add(VectorValue->AsNumber());
+                    Vector.Add(VectorValue->AsNumber());
                 }
             }
+
+            if (Contents.Vectors.Add(Vector) == INDEX_NONE)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("ImportFromJsonFile: Skipping an entry whose vector does not match the database dimension"));
+                continue;
+            }
             
-            // Load entry wrapper data
-            if (EntryObject->HasField(TEXT("EntryType")))
+            // Load entry data
+            const EEntryType EntryType = static_cast<EEntryType>(FCString::Atoi(*EntryObject->GetStringField(TEXT("EntryType"))));
+            if (EntryType == EEntryType::Struct)
             {
-                NewEntry.Entry = NewObject<UVectorEntryWrapper>(this);
-                NewEntry.Entry->EntryType = static_cast<EEntryType>(FCString::Atoi(*EntryObject->GetStringField(TEXT("EntryType"))));
-                NewEntry.Entry->Category = EntryObject->GetStringField(TEXT("Category"));
+                FString StructTypeName = EntryObject->GetStringField(TEXT("StructTypeName"));
+                UScriptStruct* StructType = FindObject<UScriptStruct>(nullptr, *StructTypeName);
+                
+                // Get the struct data as a JSON string
+                FString StructJsonString = EntryObject->GetStringField(TEXT("StructData"));
                 
-                if (NewEntry.Entry->EntryType == EEntryType::String)
+                // Parse the struct JSON
+                TSharedPtr<FJsonObject> StructJsonObject;
+                TSharedRef<TJsonReader<>> StructReader = TJsonReaderFactory<>::Create(StructJsonString);
+                if (StructType && FJsonSerializer::Deserialize(StructReader, StructJsonObject))
                 {
-                    NewEntry.Entry->StringValue = EntryObject->GetStringField(TEXT("StringValue"));
+                    // Build the struct in a scratch instance, which the payloads copy
+                    TArray<uint8> StructData;
+                    StructData.SetNumUninitialized(StructType->GetStructureSize());
+                    StructType->InitializeStruct(StructData.GetData());
+                    
+                    // Deserialize the JSON to the struct
+                    DeserializeJsonToStruct(StructType, StructData.GetData(), StructJsonObject);
+
+                    Contents.Payloads.AddStruct(StructType, StructData.GetData(), NoMetadata);
+                    StructType->DestroyStruct(StructData.GetData());
                 }
-                else if (NewEntry.Entry->EntryType == EEntryType::Struct)
+                else
                 {
-                    FString StructTypeName = EntryObject->GetStringField(TEXT("StructTypeName"));
-                    NewEntry.Entry->StructType = FindObject<UScriptStruct>(nullptr, *StructTypeName);
-                    
-                    if (NewEntry.Entry->StructType)
-                    {
-                        // Get the struct data as a JSON string
-                        FString StructJsonString = EntryObject->GetStringField(TEXT("StructData"));
-                        
-                        // Parse the struct JSON
-                        TSharedPtr<FJsonObject> StructJsonObject;
-                        TSharedRef<TJsonReader<>> StructReader = TJsonReaderFactory<>::Create(StructJsonString);
-                        if (FJsonSerializer::Deserialize(StructReader, StructJsonObject))
-                        {
-                            // Allocate memory for the struct
-                            int32 StructSize = NewEntry.Entry->StructType->GetStructureSize();
-                            NewEntry.Entry->StructData.SetNum(StructSize);
-                            
-                            // Initialize the struct
-                            NewEntry.Entry->StructType->InitializeStruct(NewEntry.Entry->StructData.GetData());
-                            
-                            // Deserialize the JSON to the struct
-                            DeserializeJsonToStruct(NewEntry.Entry->StructType, NewEntry.Entry->StructData.GetData(), StructJsonObject);
-                        }
-                    }
+                    Contents.Payloads.AddStruct(StructType, nullptr, NoMetadata);
                 }
             }
-            
-            Entries.Add(NewEntry);
+            else if (EntryType == EEntryType::Object)
+            {
+                // Object values are not exported
+                Contents.Payloads.AddObject(nullptr, NoMetadata);
+            }
+            else
+            {
+                Contents.Payloads.AddString(EntryObject->GetStringField(TEXT("StringValue")), NoMetadata);
+            }
+
+            const FString Category = EntryObject->GetStringField(TEXT("Category"));
+            if (Category.IsEmpty())
+            {
+                Contents.RowCategories.Add(INDEX_NONE);
+            }
+            else if (const int32* CategoryIndex = CategoryIndices.Find(Category))
+            {
+                Contents.RowCategories.Add(*CategoryIndex);
+            }
+            else
+            {
+                Contents.RowCategories.Add(CategoryIndices.Add(Category, Contents.Categories.Add(Category)));
+            }
         }
     }
+
+    ApplyFileContents(Contents);
     
     // Mark the asset as modified
     MarkPackageDirty();
@@ -599,106 +1080,193 @@ TArray<FString> UVectorDatabaseAsset::GetUniqueCategories() const
     return Categories;
 }
 
+int32 UVectorDatabaseAsset::GetNumberOfEntries() const
+{
+    return Payloads.Num();
+}
+
 int32 UVectorDatabaseAsset::GetEntryCountForCategory(const FString& Category) const
 {
-    int32 Count = 0;
-    for (const FVectorDatabaseEntry& Entry : Entries)
+    const int32 CategoryIndex = Categories.IndexOfByKey(Category);
+    if (CategoryIndex == INDEX_NONE && !Category.IsEmpty())
     {
-        if (Entry.Entry && Entry.Entry->Category == Category)
-        {
-            Count++;
-        }
+        return 0;
     }
-    return Count;
+    return Algo::Count(RowCategories, CategoryIndex);
 }
 
 TArray<FVectorDatabaseEntry> UVectorDatabaseAsset::GetEntriesForCategory(const FString& Category) const
 {
     TArray<FVectorDatabaseEntry> Result;
-    for (const FVectorDatabaseEntry& Entry : Entries)
+
+    const int32 CategoryIndex = Categories.IndexOfByKey(Category);
+    if (CategoryIndex == INDEX_NONE && !Category.IsEmpty())
+    {
+        return Result;
+    }
+
+    FVectorStorage Vectors;
+    if (!LoadVectors(Vectors))
     {
-        if (Entry.Entry && Entry.Entry->Category == Category)
+        UE_LOG(LogTemp, Error, TEXT("GetEntriesForCategory: The vector data of %s does not match its entries"), *GetName());
+        return Result;
+    }
+
+    for (int32 Row = 0; Row < RowCategories.Num(); ++Row)
+    {
+        if (RowCategories[Row] == CategoryIndex)
         {
-            Result.Add(Entry);
+            FVectorDatabaseEntry& Entry = Result.AddDefaulted_GetRef();
+            Entry.Vector = Vectors.CopyRow(Row);
+            Entry.Entry = Payloads.MakeWrapper(Row, Category);
         }
     }
     return Result;
 }
 
-void UVectorDatabaseAsset::DeepCopyStruct(UScriptStruct* StructType, void* Dest, const void* Src)
+#if WITH_EDITOR
+void UVectorDatabaseAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // Update LastModifiedDate when properties change
+    LastModifiedDate = FDateTime::Now();
+
+    // The settings the cached structures were built with may have changed
+    bSearchStructuresCached = false;
+}
+
+void UVectorDatabaseAsset::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
 {
-    if (!StructType || !Dest || !Src)
+    Super::BeginCacheForCookedPlatformData(TargetPlatform);
+
+    // The structures do not depend on the platform, so one build serves every platform being cooked
+    if (!bSearchStructuresCached)
     {
-        UE_LOG(LogTemp, Error, TEXT("DeepCopyStruct: Invalid arguments"));
-        return;
+        CacheSearchStructures();
     }
+}
+
+bool UVectorDatabaseAsset::IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform)
+{
+    return bSearchStructuresCached;
+}
+
+void UVectorDatabaseAsset::ClearAllCachedCookedPlatformData()
+{
+    Super::ClearAllCachedCookedPlatformData();
 
-    StructType->InitializeStruct(Dest);
+    bSearchStructuresCached = false;
+}
 
-    for (TFieldIterator<FProperty> It(StructType); It; ++It)
+void UVectorDatabaseAsset::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+    Super::PreSave(ObjectSaveContext);
+
+    // Serialize cannot create the database the build needs, so cooks that skipped BeginCacheForCookedPlatformData build here
+    if (ObjectSaveContext.IsCooking() && !bSearchStructuresCached)
     {
-        FProperty* Property = *It;
+        CacheSearchStructures();
+    }
+}
 
-        if (FStructProperty* StructProp = CastField<FStructProperty>(Property))
-        {
-            void* DestNestedStruct = StructProp->ContainerPtrToValuePtr<void>(Dest);
-            const void* SrcNestedStruct = StructProp->ContainerPtrToValuePtr<const void>(Src);
+bool UVectorDatabaseAsset::HasSearchStructures() const
+{
+    return IndexSettings.IndexType != EVectorIndexType::None || QuantizationSettings.QuantizationType != EVectorQuantizationType::None;
+}
 
-            UScriptStruct* NestedStructType = StructProp->Struct;
-            if (DestNestedStruct && SrcNestedStruct && NestedStructType)
-            {
-                DeepCopyStruct(NestedStructType, DestNestedStruct, SrcNestedStruct);
-            }
-        }
-        else if (FObjectProperty* ObjectProp = CastField<FObjectProperty>(Property))
-        {
-            // Check if this is an actor reference
-            if (ObjectProp->PropertyClass && ObjectProp->PropertyClass->IsChildOf(AActor::StaticClass()))
-            {
-                // Get the actor reference
-                UObject* ObjRef = ObjectProp->GetPropertyValue_InContainer(Src);
-                AActor* ActorRef = Cast<AActor>(ObjRef);
-                
-                // If there's an actor reference, log a warning and skip it
-                if (ActorRef)
-                {
-                    UE_LOG(LogTemp, Warning, TEXT("Actor reference detected in struct '%s' property '%s'. Actor references cannot be safely serialized and will be skipped."), 
-                           *StructType->GetName(), *Property->GetName());
-                    
-                    // Set the destination to null to avoid crashes
-                    ObjectProp->SetPropertyValue_InContainer(Dest, nullptr);
-                }
-                else
-                {
-                    // If the reference is already null, just copy it
-                    void* DestValuePtr = Property->ContainerPtrToValuePtr<void>(Dest);
-                    const void* SrcValuePtr = Property->ContainerPtrToValuePtr<const void>(Src);
-                    Property->CopyCompleteValue(DestValuePtr, SrcValuePtr);
-                }
-            }
-            else
-            {
-                // For non-actor object references, copy normally
-                void* DestValuePtr = Property->ContainerPtrToValuePtr<void>(Dest);
-                const void* SrcValuePtr = Property->ContainerPtrToValuePtr<const void>(Src);
-                Property->CopyCompleteValue(DestValuePtr, SrcValuePtr);
-            }
-        }
-        else
-        {
-            void* DestValuePtr = Property->ContainerPtrToValuePtr<void>(Dest);
-            const void* SrcValuePtr = Property->ContainerPtrToValuePtr<const void>(Src);
-            Property->CopyCompleteValue(DestValuePtr, SrcValuePtr);
-        }
+FString UVectorDatabaseAsset::GetSearchStructuresKey(uint64 InVectorChecksum) const
+{
+    // The checksum covers the dimension, the precision and every row, so it stands for the whole vector block
+    const FString KeySuffix = FString::Printf(TEXT("%016llX_%d_%d_%d_I%d_%d_%d_%d_Q%d_%d_%d"),
+        InVectorChecksum, Payloads.Num(), static_cast<int32>(DistanceMetric),
+        static_cast<int32>(EVectorIndexVersion::Latest), static_cast<int32>(IndexSettings.IndexType), IndexSettings.M, IndexSettings.EfConstruction, IndexSettings.NumLists,
+        static_cast<int32>(EVectorQuantizerVersion::Latest), static_cast<int32>(QuantizationSettings.QuantizationType), QuantizationSettings.NumSubQuantizers);
+
+    return FDerivedDataCacheInterface::BuildCacheKey(TEXT("VECTORDB"), VECTORDATABASE_DERIVEDDATA_VER, *KeySuffix);
+}
+
+bool UVectorDatabaseAsset::FetchSearchStructures(const FString& Key, FVectorDatabaseFileContents& Contents) const
+{
+    TArray<uint8> DerivedData;
+    if (!GetDerivedDataCacheRef().GetSynchronous(*Key, DerivedData, GetPathName()))
+    {
+        return false;
+    }
+
+    TArray<uint8> IndexData;
+    TArray<uint8> QuantizerData;
+    FMemoryReader Reader(DerivedData);
+    Reader << IndexData;
+    Reader << QuantizerData;
+    if (Reader.IsError())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FetchSearchStructures: The cached search structures of %s are corrupt, building them again"), *GetName());
+        return false;
     }
+
+    Contents.IndexData = MoveTemp(IndexData);
+    Contents.QuantizerData = MoveTemp(QuantizerData);
+    return true;
 }
 
-#if WITH_EDITOR
-void UVectorDatabaseAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+void UVectorDatabaseAsset::StoreSearchStructures(const FString& Key, const UVectorDatabase& Database, uint64 InVectorChecksum, TArray<uint8>& OutIndexData, TArray<uint8>& OutQuantizerData) const
 {
-    Super::PostEditChangeProperty(PropertyChangedEvent);
+    // A database freshly loaded from the asset has no removed rows, so its structures always cover exactly the stored rows
+    Database.SaveSearchStructures(InVectorChecksum, OutIndexData, OutQuantizerData);
 
-    // Update LastModifiedDate when properties change
-    LastModifiedDate = FDateTime::Now();
+    TArray<uint8> DerivedData;
+    FMemoryWriter Writer(DerivedData);
+    Writer << OutIndexData;
+    Writer << OutQuantizerData;
+    GetDerivedDataCacheRef().Put(*Key, DerivedData, GetPathName());
+}
+
+void UVectorDatabaseAsset::CacheSearchStructures()
+{
+    bSearchStructuresCached = true;
+
+    if (!HasSearchStructures())
+    {
+        // Nothing is built from them, so cooked builds do not carry structures left over from other settings
+        IndexBulkData.RemoveBulkData();
+        QuantizerBulkData.RemoveBulkData();
+        return;
+    }
+
+    if (VectorChecksum != 0 && GetSearchStructuresKey(VectorChecksum) == SavedSearchStructuresKey)
+    {
+        // The saved structures were built for the current settings, so the vectors are not even read
+        return;
+    }
+
+    FVectorDatabaseFileContents Contents;
+    if (!GatherFileContents(Contents))
+    {
+        UE_LOG(LogTemp, Error, TEXT("CacheSearchStructures: The vector data of %s does not match its entries"), *GetName());
+        return;
+    }
+
+    if (Contents.VectorChecksum == 0)
+    {
+        // Assets saved before the checksum was stored keep it from now on
+        VectorChecksum = Contents.Vectors.ComputeChecksum();
+        Contents.VectorChecksum = VectorChecksum;
+    }
+
+    const FString Key = GetSearchStructuresKey(VectorChecksum);
+    if (!FetchSearchStructures(Key, Contents))
+    {
+        // The saved structures may have been built with other parameters, so they are built again rather than restored
+        Contents.IndexData.Empty();
+        Contents.QuantizerData.Empty();
+        UVectorDatabase* Database = NewObject<UVectorDatabase>();
+        Database->ResetFromFileContents(Contents);
+        StoreSearchStructures(Key, *Database, VectorChecksum, Contents.IndexData, Contents.QuantizerData);
+    }
+
+    WriteBulkDataBytes(IndexBulkData, Contents.IndexData);
+    WriteBulkDataBytes(QuantizerBulkData, Contents.QuantizerData);
+    SavedSearchStructuresKey = Key;
 }
 #endif
\ No newline at end of file
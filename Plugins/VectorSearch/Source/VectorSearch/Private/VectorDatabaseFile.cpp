@@ -0,0 +1,451 @@
+#include "VectorDatabaseFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Database files hold little-endian values and copy vector blocks in native byte order");
+
+namespace
+{
+    /** "VDBF" read as a little-endian uint32 */
+    constexpr uint32 FileMagic = 0x46424456;
+
+    /** Fixed-size header at the start of every database file */
+    struct FVectorDatabaseFileHeader
+    {
+        uint32 Magic = FileMagic;
+
+        int32 Version = static_cast<int32>(EVectorDatabaseFileVersion::Latest);
+
+        int32 Dimension = 0;
+
+        int32 NumRows = 0;
+
+        /** Bytes between the start of two consecutive rows in the vector block */
+        int32 StrideInBytes = 0;
+
+        EVectorDistanceMetric DistanceMetric = EVectorDistanceMetric::Euclidean;
+
+        EVectorStoragePrecision StoragePrecision = EVectorStoragePrecision::Float32;
+
+        int64 PayloadsOffset = 0;
+
+        int64 VectorsOffset = 0;
+
+        /** Offset of the row norms; files older than RowNorms have none */
+        int64 NormsOffset = 0;
+
+        /** Offset of the index section; files older than Index have none */
+        int64 IndexOffset = 0;
+
+        /** Offset of the quantizer section; files older than Quantizer have none */
+        int64 QuantizerOffset = 0;
+
+        /** FVectorStorage::ComputeChecksum of the vector block; 0 in files older than VectorChecksum */
+        uint64 VectorChecksum = 0;
+
+        friend FArchive& operator<<(FArchive& Ar, FVectorDatabaseFileHeader& Header)
+        {
+            Ar << Header.Magic;
+            Ar << Header.Version;
+            Ar << Header.Dimension;
+            Ar << Header.NumRows;
+            Ar << Header.StrideInBytes;
+            Ar << Header.DistanceMetric;
+            Ar << Header.StoragePrecision;
+            Ar << Header.PayloadsOffset;
+            Ar << Header.VectorsOffset;
+
+            if (Header.Version >= static_cast<int32>(EVectorDatabaseFileVersion::RowNorms))
+            {
+                Ar << Header.NormsOffset;
+            }
+
+            if (Header.Version >= static_cast<int32>(EVectorDatabaseFileVersion::Index))
+            {
+                Ar << Header.IndexOffset;
+            }
+
+            if (Header.Version >= static_cast<int32>(EVectorDatabaseFileVersion::Quantizer))
+            {
+                Ar << Header.QuantizerOffset;
+            }
+
+            if (Header.Version >= static_cast<int32>(EVectorDatabaseFileVersion::VectorChecksum))
+            {
+                Ar << Header.VectorChecksum;
+            }
+            return Ar;
+        }
+    };
+
+    void SerializeIndexSettings(FArchive& Ar, FVectorIndexSettings& Settings)
+    {
+        Ar << Settings.IndexType;
+        Ar << Settings.M;
+        Ar << Settings.EfConstruction;
+        Ar << Settings.EfSearch;
+        Ar << Settings.NumLists;
+        Ar << Settings.NumProbes;
+        Ar << Settings.MinEntriesForIndex;
+        Ar << Settings.ExactScanSelectivity;
+    }
+
+    void SerializeQuantizationSettings(FArchive& Ar, FVectorQuantizationSettings& Settings)
+    {
+        Ar << Settings.QuantizationType;
+        Ar << Settings.NumSubQuantizers;
+        Ar << Settings.bRescore;
+        Ar << Settings.RescoreMultiplier;
+    }
+
+    bool ValidateHeader(const FVectorDatabaseFileHeader& Header, const FString& FilePath)
+    {
+        if (Header.Magic != FileMagic)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s is not a vector database file"), *FilePath);
+            return false;
+        }
+
+        if (Header.Version < static_cast<int32>(EVectorDatabaseFileVersion::Initial) || Header.Version > static_cast<int32>(EVectorDatabaseFileVersion::Latest))
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s has unsupported version %d"), *FilePath, Header.Version);
+            return false;
+        }
+
+        if (Header.Dimension < 0 || Header.NumRows < 0
+            || Header.DistanceMetric > EVectorDistanceMetric::DotProduct
+            || Header.StoragePrecision > EVectorStoragePrecision::BFloat16)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s has a corrupt header"), *FilePath);
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Keeps the mapped vector block of a file alive for the storage reading it */
+    class FMappedVectorRows : public IVectorStorageMemory
+    {
+    public:
+        TUniquePtr<IMappedFileHandle> Handle;
+
+        /** Declared after Handle so it is unmapped before the file is closed */
+        TUniquePtr<IMappedFileRegion> Region;
+    };
+
+    bool ValidateRowCategories(const FVectorDatabaseFileContents& Contents)
+    {
+        if (Contents.RowCategories.Num() != Contents.Vectors.Num())
+        {
+            return false;
+        }
+
+        for (const int32 CategoryIndex : Contents.RowCategories)
+        {
+            if (CategoryIndex != INDEX_NONE && !Contents.Categories.IsValidIndex(CategoryIndex))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Read the header and every section except the vector block. Returns false if the file cannot be used. */
+    bool ReadSections(FArchive& Ar, const FString& FilePath, FVectorDatabaseFileHeader& OutHeader, FVectorDatabaseFileContents& OutContents, TArray<float>& OutRowNorms)
+    {
+        Ar << OutHeader;
+        if (Ar.IsError() || !ValidateHeader(OutHeader, FilePath))
+        {
+            return false;
+        }
+
+        OutContents.DistanceMetric = OutHeader.DistanceMetric;
+        OutContents.VectorChecksum = OutHeader.VectorChecksum;
+        Ar << OutContents.DatabaseName;
+        Ar << OutContents.Description;
+        Ar << OutContents.CreationDate;
+        Ar << OutContents.LastModifiedDate;
+        Ar << OutContents.Categories;
+        Ar << OutContents.RowCategories;
+
+        Ar.Seek(OutHeader.PayloadsOffset);
+        FObjectAndNameAsStringProxyArchive PayloadAr(Ar, false);
+        OutContents.Payloads.Serialize(PayloadAr);
+
+        if (OutHeader.NormsOffset > 0 && OutHeader.NumRows > 0)
+        {
+            Ar.Seek(OutHeader.NormsOffset);
+            OutRowNorms.SetNumUninitialized(OutHeader.NumRows);
+            Ar.Serialize(OutRowNorms.GetData(), OutRowNorms.Num() * sizeof(float));
+        }
+
+        if (OutHeader.IndexOffset > 0)
+        {
+            Ar.Seek(OutHeader.IndexOffset);
+            SerializeIndexSettings(Ar, OutContents.IndexSettings);
+            Ar << OutContents.IndexData;
+
+            if (OutContents.IndexSettings.IndexType > EVectorIndexType::IVF)
+            {
+                UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s has corrupt index settings"), *FilePath);
+                return false;
+            }
+        }
+
+        if (OutHeader.QuantizerOffset > 0)
+        {
+            Ar.Seek(OutHeader.QuantizerOffset);
+            SerializeQuantizationSettings(Ar, OutContents.QuantizationSettings);
+            Ar << OutContents.QuantizerData;
+
+            if (OutContents.QuantizationSettings.QuantizationType > EVectorQuantizationType::Binary)
+            {
+                UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s has corrupt quantization settings"), *FilePath);
+                return false;
+            }
+        }
+
+        // The stride depends on the row alignment of the version that wrote the file
+        OutContents.Vectors.Empty();
+        OutContents.Vectors.SetPrecision(OutHeader.StoragePrecision);
+        OutContents.Vectors.SetDimension(OutHeader.Dimension);
+        if (OutHeader.NumRows > 0 && OutContents.Vectors.GetStrideInBytes() != OutHeader.StrideInBytes)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s has an unsupported row stride of %d bytes"), *FilePath, OutHeader.StrideInBytes);
+            return false;
+        }
+
+        if (Ar.IsError() || PayloadAr.IsError() || OutContents.Payloads.Num() != OutHeader.NumRows
+            || OutContents.RowCategories.Num() != OutHeader.NumRows)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile: %s is truncated or corrupt"), *FilePath);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+FVectorDatabaseFileContents::FVectorDatabaseFileContents()
+    : CreationDate(0),
+      LastModifiedDate(0),
+      DistanceMetric(EVectorDistanceMetric::Euclidean),
+      VectorChecksum(0)
+{
+}
+
+bool VectorDatabaseFile::IsDatabaseFile(const FString& FilePath)
+{
+    TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*FilePath));
+    if (!Ar || Ar->TotalSize() < static_cast<int64>(sizeof(uint32)))
+    {
+        return false;
+    }
+
+    uint32 Magic = 0;
+    *Ar << Magic;
+    return Magic == FileMagic;
+}
+
+bool VectorDatabaseFile::Save(const FString& FilePath, const FVectorDatabaseFileContents& Contents)
+{
+    const FVectorStorage& Vectors = Contents.Vectors;
+    if (Contents.Payloads.Num() != Vectors.Num() || !ValidateRowCategories(Contents))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Save: Sections hold different numbers of rows"));
+        return false;
+    }
+
+    TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*FilePath));
+    if (!Ar)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Save: Failed to open %s for writing"), *FilePath);
+        return false;
+    }
+
+    FVectorDatabaseFileHeader Header;
+    Header.Dimension = Vectors.GetDimension();
+    Header.NumRows = Vectors.Num();
+    Header.StrideInBytes = Vectors.GetStrideInBytes();
+    Header.DistanceMetric = Contents.DistanceMetric;
+    Header.StoragePrecision = Vectors.GetPrecision();
+    Header.VectorChecksum = Contents.VectorChecksum != 0 ? Contents.VectorChecksum : Vectors.ComputeChecksum();
+
+    // Written again with the section offsets once they are known
+    *Ar << Header;
+
+    FString DatabaseName = Contents.DatabaseName;
+    FString Description = Contents.Description;
+    FDateTime CreationDate = Contents.CreationDate;
+    FDateTime LastModifiedDate = Contents.LastModifiedDate;
+    *Ar << DatabaseName;
+    *Ar << Description;
+    *Ar << CreationDate;
+    *Ar << LastModifiedDate;
+    *Ar << const_cast<TArray<FString>&>(Contents.Categories);
+    *Ar << const_cast<TArray<int32>&>(Contents.RowCategories);
+
+    // Object values, struct types and names inside struct values are written as path strings
+    Header.PayloadsOffset = Ar->Tell();
+    FObjectAndNameAsStringProxyArchive PayloadAr(*Ar, false);
+    const_cast<FVectorPayloadStore&>(Contents.Payloads).Serialize(PayloadAr);
+
+    Header.NormsOffset = Ar->Tell();
+    TArrayView<const float> RowNorms = Vectors.GetRowNorms();
+    Ar->Serialize(const_cast<float*>(RowNorms.GetData()), RowNorms.Num() * sizeof(float));
+
+    Header.IndexOffset = Ar->Tell();
+    SerializeIndexSettings(*Ar, const_cast<FVectorIndexSettings&>(Contents.IndexSettings));
+    *Ar << const_cast<TArray<uint8>&>(Contents.IndexData);
+
+    Header.QuantizerOffset = Ar->Tell();
+    SerializeQuantizationSettings(*Ar, const_cast<FVectorQuantizationSettings&>(Contents.QuantizationSettings));
+    *Ar << const_cast<TArray<uint8>&>(Contents.QuantizerData);
+
+    // Start the vector block on a row boundary so it can be used in place
+    const int64 Padding = Align(Ar->Tell(), FVectorStorage::Alignment) - Ar->Tell();
+    uint8 Zeros[FVectorStorage::Alignment] = {};
+    Ar->Serialize(Zeros, Padding);
+
+    Header.VectorsOffset = Ar->Tell();
+    TArrayView64<const uint8> RawData = Vectors.GetRawData();
+    Ar->Serialize(const_cast<uint8*>(RawData.GetData()), RawData.Num());
+
+    Ar->Seek(0);
+    *Ar << Header;
+
+    const bool bSuccess = Ar->Close() && !PayloadAr.IsError();
+    if (!bSuccess)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Save: Failed to write %s"), *FilePath);
+    }
+    return bSuccess;
+}
+
+bool VectorDatabaseFile::Load(const FString& FilePath, FVectorDatabaseFileContents& OutContents)
+{
+    TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*FilePath));
+    if (!Ar)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Load: Failed to open %s"), *FilePath);
+        return false;
+    }
+
+    FVectorDatabaseFileHeader Header;
+    TArray<float> RowNorms;
+    if (!ReadSections(*Ar, FilePath, Header, OutContents, RowNorms))
+    {
+        return false;
+    }
+
+    // A corrupt header could otherwise size the vector buffer far past what the file holds before the read fails
+    const int64 VectorBytes = static_cast<int64>(Header.NumRows) * Header.StrideInBytes;
+    if (Header.VectorsOffset + VectorBytes > Ar->TotalSize())
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Load: %s is truncated or corrupt"), *FilePath);
+        return false;
+    }
+
+    Ar->Seek(Header.VectorsOffset);
+    if (!OutContents.Vectors.LoadRawData(*Ar, Header.Dimension, Header.NumRows, RowNorms) || !ValidateRowCategories(OutContents))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::Load: %s is truncated or corrupt"), *FilePath);
+        return false;
+    }
+
+    return true;
+}
+
+bool VectorDatabaseFile::LoadMapped(const FString& FilePath, FVectorDatabaseFileContents& OutContents)
+{
+    FVectorDatabaseFileHeader Header;
+    TArray<float> RowNorms;
+    {
+        TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*FilePath));
+        if (!Ar)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::LoadMapped: Failed to open %s"), *FilePath);
+            return false;
+        }
+
+        if (!ReadSections(*Ar, FilePath, Header, OutContents, RowNorms))
+        {
+            return false;
+        }
+    }
+
+    if (Header.NumRows == 0)
+    {
+        return ValidateRowCategories(OutContents);
+    }
+
+    TSharedRef<FMappedVectorRows> Mapping = MakeShared<FMappedVectorRows>();
+    Mapping->Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+    if (!Mapping->Handle)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::LoadMapped: Failed to map %s"), *FilePath);
+        return false;
+    }
+
+    const int64 VectorBytes = static_cast<int64>(Header.NumRows) * Header.StrideInBytes;
+    if (Header.VectorsOffset + VectorBytes > Mapping->Handle->GetFileSize())
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::LoadMapped: %s is truncated or corrupt"), *FilePath);
+        return false;
+    }
+
+    Mapping->Region.Reset(Mapping->Handle->MapRegion(Header.VectorsOffset, VectorBytes));
+    if (!Mapping->Region)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::LoadMapped: Failed to map the vectors of %s"), *FilePath);
+        return false;
+    }
+
+    // Regions start on a page boundary plus the offset within the page, so the block keeps its row alignment
+    OutContents.Vectors.AttachExternalRows(Mapping, Mapping->Region->GetMappedPtr(), Header.Dimension, Header.NumRows, RowNorms);
+    return ValidateRowCategories(OutContents);
+}
+
+bool VectorDatabaseFile::MoveRowsToFile(const FString& FilePath, FVectorStorage& Vectors)
+{
+    if (Vectors.Num() == 0)
+    {
+        return true;
+    }
+
+    TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*FilePath));
+    if (!Ar)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::MoveRowsToFile: Failed to open %s for writing"), *FilePath);
+        return false;
+    }
+
+    TArrayView64<const uint8> RawData = Vectors.GetRawData();
+    Ar->Serialize(const_cast<uint8*>(RawData.GetData()), RawData.Num());
+    if (!Ar->Close())
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::MoveRowsToFile: Failed to write %s"), *FilePath);
+        return false;
+    }
+
+    TSharedRef<FMappedVectorRows> Mapping = MakeShared<FMappedVectorRows>();
+    Mapping->Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+    if (Mapping->Handle)
+    {
+        Mapping->Region.Reset(Mapping->Handle->MapRegion(0, RawData.Num()));
+    }
+
+    if (!Mapping->Region)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseFile::MoveRowsToFile: Failed to map %s"), *FilePath);
+        return false;
+    }
+
+    // Attaching empties the storage first, so keep the norms it already computed
+    const TArray<float> RowNorms(Vectors.GetRowNorms());
+    Vectors.AttachExternalRows(Mapping, Mapping->Region->GetMappedPtr(), Vectors.GetDimension(), Vectors.Num(), RowNorms);
+    return true;
+}
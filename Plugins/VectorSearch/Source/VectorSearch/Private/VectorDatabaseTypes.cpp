@@ -1,530 +1,2083 @@
 #include "VectorDatabaseTypes.h"
+#include "VectorDatabaseFile.h"
+#include "VectorDistanceKernels.h"
+#include "VectorIndexHNSW.h"
+#include "VectorIndexIVF.h"
+#include "VectorQuantizerPQ.h"
+#include "VectorQuantizerSQ8.h"
+#include "VectorQuantizerBinary.h"
 #include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformMisc.h"
 #include "Misc/DefaultValueHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/** Row lists of the partitions a filtered query can match */
+struct FVectorPartitionSelection
+{
+    TArray<const TArray<int32>*, TInlineAllocator<8>> Partitions;
+
+    int32 NumRows = 0;
+};
+
+namespace
+{
+    constexpr int32 NumEntryTypes = static_cast<int32>(EEntryType::Struct) + 1;
+
+    /** Rows sampled to estimate how selective a query filter is */
+    constexpr int32 FilterSelectivitySamples = 256;
+
+    /** How many times faster a single-threaded sweep over quantizer codes is assumed to be than exact scoring of the same rows */
+    constexpr int32 QuantizedScanSpeedup = 8;
+
+    int32 GetPartitionIndex(int32 CategoryId, EEntryType EntryType)
+    {
+        return CategoryId * NumEntryTypes + static_cast<int32>(EntryType);
+    }
+
+    /** Pack the surviving elements of a per-row array to the front, following a compaction remap */
+    template <typename ElementType>
+    void CompactRowArray(TArray<ElementType>& Rows, TArrayView<const int32> RowRemap)
+    {
+        int32 NumKept = 0;
+        for (int32 Row = 0; Row < Rows.Num(); ++Row)
+        {
+            if (RowRemap[Row] != INDEX_NONE)
+            {
+                Rows[NumKept++] = MoveTemp(Rows[Row]);
+            }
+        }
+        Rows.SetNum(NumKept, false);
+    }
+
+    int32 CountEntriesOfType(const FVectorPayloadStore& Payloads, const TBitArray<>& RemovedRows, EEntryType EntryType)
+    {
+        int32 Count = 0;
+        for (int32 Row = 0; Row < Payloads.Num(); ++Row)
+        {
+            if (!RemovedRows[Row] && Payloads.GetType(Row) == EntryType)
+            {
+                Count++;
+            }
+        }
+        return Count;
+    }
+
+    TUniquePtr<IVectorIndex> MakeVectorIndex(const FVectorIndexSettings& Settings)
+    {
+        switch (Settings.IndexType)
+        {
+            case EVectorIndexType::HNSW:
+                return MakeUnique<FVectorIndexHNSW>(Settings.M, Settings.EfConstruction, Settings.EfSearch);
+
+            case EVectorIndexType::IVF:
+                return MakeUnique<FVectorIndexIVF>(Settings.NumLists, Settings.NumProbes);
+
+            default:
+                return nullptr;
+        }
+    }
+
+    /** Written ahead of a saved index or quantizer and checked before its structure is read */
+    struct FSavedStructureHeader
+    {
+        /** EVectorIndexVersion or EVectorQuantizerVersion of the structure */
+        int32 Version = 0;
+
+        /** EVectorIndexType or EVectorQuantizationType of the structure */
+        uint8 Type = 0;
+
+        EVectorDistanceMetric DistanceMetric = EVectorDistanceMetric::Euclidean;
+
+        int32 NumRows = 0;
+
+        /** FVectorStorage::ComputeChecksum of the vectors the structure was built over */
+        uint64 VectorChecksum = 0;
+
+        friend FArchive& operator<<(FArchive& Ar, FSavedStructureHeader& Header)
+        {
+            Ar << Header.Version;
+            Ar << Header.Type;
+            Ar << Header.DistanceMetric;
+            Ar << Header.NumRows;
+            Ar << Header.VectorChecksum;
+            return Ar;
+        }
+
+        bool Matches(const FSavedStructureHeader& Other) const
+        {
+            return Version == Other.Version && Type == Other.Type && DistanceMetric == Other.DistanceMetric
+                && NumRows == Other.NumRows && VectorChecksum == Other.VectorChecksum;
+        }
+    };
+
+    FSavedStructureHeader MakeIndexHeader(EVectorIndexType IndexType, EVectorDistanceMetric Metric, int32 NumRows, uint64 VectorChecksum)
+    {
+        FSavedStructureHeader Header;
+        Header.Version = static_cast<int32>(EVectorIndexVersion::Latest);
+        Header.Type = static_cast<uint8>(IndexType);
+        Header.DistanceMetric = Metric;
+        Header.NumRows = NumRows;
+        Header.VectorChecksum = VectorChecksum;
+        return Header;
+    }
+
+    FSavedStructureHeader MakeQuantizerHeader(EVectorQuantizationType QuantizationType, EVectorDistanceMetric Metric, int32 NumRows, uint64 VectorChecksum)
+    {
+        FSavedStructureHeader Header;
+        Header.Version = static_cast<int32>(EVectorQuantizerVersion::Latest);
+        Header.Type = static_cast<uint8>(QuantizationType);
+        Header.DistanceMetric = Metric;
+        Header.NumRows = NumRows;
+        Header.VectorChecksum = VectorChecksum;
+        return Header;
+    }
+
+    /** Write Header followed by an index or quantizer built over Vectors */
+    template <typename StructureType>
+    void SaveStructure(StructureType& Structure, FSavedStructureHeader Header, const FVectorStorage& Vectors, TArray<uint8>& OutData)
+    {
+        OutData.Reset();
+        FMemoryWriter Writer(OutData);
+        Writer << Header;
+        Structure.Serialize(Writer, Vectors);
+    }
+
+    /** Copy a structure through memory so it can be compacted without touching the original */
+    template <typename StructureType>
+    bool CopyStructure(StructureType& Structure, StructureType& OutCopy, const FVectorStorage& Vectors)
+    {
+        TArray64<uint8> Data;
+        FMemoryWriter64 Writer(Data);
+        Structure.Serialize(Writer, Vectors);
+
+        FMemoryReader64 Reader(Data);
+        OutCopy.Serialize(Reader, Vectors);
+        return !Reader.IsError();
+    }
+
+    /** Saved structures are held in int32-sized byte arrays; quantizers too large for one are trained again on load instead */
+    bool CanSaveQuantizer(const IVectorQuantizer& Quantizer)
+    {
+        return Quantizer.GetAllocatedSize() < static_cast<SIZE_T>(MAX_int32 - 1024);
+    }
+
+    TUniquePtr<IVectorQuantizer> MakeVectorQuantizer(const FVectorQuantizationSettings& Settings)
+    {
+        switch (Settings.QuantizationType)
+        {
+            case EVectorQuantizationType::Product:
+                return MakeUnique<FVectorQuantizerPQ>(Settings.NumSubQuantizers);
+
+            case EVectorQuantizationType::Scalar8:
+                return MakeUnique<FVectorQuantizerSQ8>();
+
+            case EVectorQuantizationType::Binary:
+                return MakeUnique<FVectorQuantizerBinary>();
+
+            default:
+                return nullptr;
+        }
+    }
+}
 
 UVectorDatabase::UVectorDatabase()
 {
-    Entries.Empty();
     Vectors.Empty();
     DistanceMetric = EVectorDistanceMetric::Euclidean;
+    MinRowsPerScanChunk = 16384;
+    bPartitioned = false;
+    NumRemovedRows = 0;
+    NextHandle = 0;
+    CompactionThreshold = 0.25f;
+    bAutoCompaction = true;
 }
 
 UVectorDatabase::~UVectorDatabase()
 {
-    for (UVectorEntryWrapper* Entry : Entries)
+    FTSTicker::GetCoreTicker().RemoveTicker(CompactionTickerHandle);
+    Payloads.Empty();
+    Vectors.Empty();
+}
+
+void UVectorDatabase::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+    CastChecked<UVectorDatabase>(InThis)->Payloads.AddReferencedObjects(Collector);
+
+    Super::AddReferencedObjects(InThis, Collector);
+}
+
+bool UVectorDatabase::CanAddVector(TArrayView<const float> Vector, const TCHAR* Caller) const
+{
+    if (Vector.Num() == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s: Empty vector"), Caller);
+        return false;
+    }
+
+    // Validate vector dimension consistency
+    if (Vectors.Num() > 0 && Vectors.GetDimension() != Vector.Num())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s: Vector dimension mismatch. Expected %d, got %d"), 
+               Caller, Vectors.GetDimension(), Vector.Num());
+        return false;
+    }
+
+    return true;
+}
+
+int64 UVectorDatabase::AddEntry(const TArray<float>& Vector, UVectorEntryWrapper* Entry, const FString& Category)
+{
+    if (!Entry || !IsValid(Entry))
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddEntry: Invalid Entry"));
+        return INDEX_NONE;
+    }
+
+    if (!CanAddVector(Vector, TEXT("AddEntry")))
+    {
+        return INDEX_NONE;
+    }
+
+    Payloads.AddFromWrapper(*Entry);
+    return InsertRow(Vector, Category);
+}
+
+int64 UVectorDatabase::AddStringEntry(const TArray<float>& Vector, const FString& Value, const FString& Category, const TMap<FString, FString>& Metadata)
+{
+    if (!CanAddVector(Vector, TEXT("AddStringEntry")))
+    {
+        return INDEX_NONE;
+    }
+
+    Payloads.AddString(Value, Metadata);
+    return InsertRow(Vector, Category);
+}
+
+int64 UVectorDatabase::AddObjectEntry(const TArray<float>& Vector, UObject* Value, const FString& Category, const TMap<FString, FString>& Metadata)
+{
+    if (!Value || !IsValid(Value))
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddObjectEntry: Invalid Object"));
+        return INDEX_NONE;
+    }
+
+    if (!CanAddVector(Vector, TEXT("AddObjectEntry")))
+    {
+        return INDEX_NONE;
+    }
+
+    Payloads.AddObject(Value, Metadata);
+    return InsertRow(Vector, Category);
+}
+
+int64 UVectorDatabase::InsertRow(TArrayView<const float> Vector, const FString& Category)
+{
+    const int64 Handle = AppendRow(Vector, Category);
+    const int32 NewRow = Vectors.Num() - 1;
+    if (Index)
+    {
+        Index->AddRow(Vectors, NewRow);
+    }
+    if (Quantizer)
+    {
+        Quantizer->AddRow(Vectors, NewRow);
+    }
+
+    return Handle;
+}
+
+int64 UVectorDatabase::AppendRow(TArrayView<const float> Vector, const FString& Category)
+{
+    const int32 NewRow = Vectors.Add(Vector);
+    check(NewRow == Payloads.Num() - 1);
+
+    const int64 Handle = NextHandle++;
+    RowHandles.Add(Handle);
+    HandleRows.Add(Handle, NewRow);
+    RemovedRows.Add(false);
+    RowCategories.Add(CategoryTable.Intern(Category));
+    MetadataIndex.AddRow(NewRow, Payloads.GetMetadata(NewRow));
+    if (bPartitioned)
+    {
+        const int32 Partition = GetPartitionIndex(RowCategories[NewRow], Payloads.GetType(NewRow));
+        if (Partition >= PartitionRows.Num())
+        {
+            PartitionRows.SetNum(Partition + 1);
+        }
+        PartitionRows[Partition].Add(NewRow);
+    }
+
+    return Handle;
+}
+
+TArray<int64> UVectorDatabase::AddEntriesBulk(const TArray<TArray<float>>& InVectors, const TArray<UVectorEntryWrapper*>& InEntries, const TArray<FString>& Categories)
+{
+    if (InVectors.Num() != InEntries.Num())
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddEntriesBulk: Got %d vectors for %d entries"), InVectors.Num(), InEntries.Num());
+        return TArray<int64>();
+    }
+
+    return AppendEntries(InEntries.Num(), Categories,
+        [&InEntries](int32 i) { return InEntries[i] && IsValid(InEntries[i]); },
+        [&InVectors](int32 i) { return TArrayView<const float>(InVectors[i]); },
+        [this, &InEntries](int32 i) { Payloads.AddFromWrapper(*InEntries[i]); });
+}
+
+TArray<int64> UVectorDatabase::AddEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<UVectorEntryWrapper*>& InEntries, const TArray<FString>& Categories)
+{
+    if (Dimension <= 0 || PackedVectors.Num() != InEntries.Num() * Dimension)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddEntriesBulk: Got %d packed values for %d entries of dimension %d"), PackedVectors.Num(), InEntries.Num(), Dimension);
+        return TArray<int64>();
+    }
+
+    return AppendEntries(InEntries.Num(), Categories,
+        [&InEntries](int32 i) { return InEntries[i] && IsValid(InEntries[i]); },
+        [PackedVectors, Dimension](int32 i) { return PackedVectors.Slice(i * Dimension, Dimension); },
+        [this, &InEntries](int32 i) { Payloads.AddFromWrapper(*InEntries[i]); });
+}
+
+TArray<int64> UVectorDatabase::AddStringEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<FString>& Values, const TArray<FString>& Categories)
+{
+    if (Dimension <= 0 || PackedVectors.Num() != Values.Num() * Dimension)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddStringEntriesBulk: Got %d packed values for %d entries of dimension %d"), PackedVectors.Num(), Values.Num(), Dimension);
+        return TArray<int64>();
+    }
+
+    static const TMap<FString, FString> NoMetadata;
+    return AppendEntries(Values.Num(), Categories,
+        [](int32 i) { return true; },
+        [PackedVectors, Dimension](int32 i) { return PackedVectors.Slice(i * Dimension, Dimension); },
+        [this, &Values](int32 i) { Payloads.AddString(Values[i], NoMetadata); });
+}
+
+TArray<int64> UVectorDatabase::AddObjectEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<UObject*>& Values, const TArray<FString>& Categories)
+{
+    if (Dimension <= 0 || PackedVectors.Num() != Values.Num() * Dimension)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddObjectEntriesBulk: Got %d packed values for %d entries of dimension %d"), PackedVectors.Num(), Values.Num(), Dimension);
+        return TArray<int64>();
+    }
+
+    static const TMap<FString, FString> NoMetadata;
+    return AppendEntries(Values.Num(), Categories,
+        [&Values](int32 i) { return Values[i] && IsValid(Values[i]); },
+        [PackedVectors, Dimension](int32 i) { return PackedVectors.Slice(i * Dimension, Dimension); },
+        [this, &Values](int32 i) { Payloads.AddObject(Values[i], NoMetadata); });
+}
+
+TArray<int64> UVectorDatabase::AppendEntries(int32 NumEntries, const TArray<FString>& Categories, TFunctionRef<bool(int32 Index)> IsValidEntry,
+                                             TFunctionRef<TArrayView<const float>(int32 Index)> GetVector, TFunctionRef<void(int32 Index)> AddPayload)
+{
+    TArray<int64> Handles;
+    Handles.Init(INDEX_NONE, NumEntries);
+
+    if (Categories.Num() > 1 && Categories.Num() != NumEntries)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddEntriesBulk: Got %d categories for %d entries"), Categories.Num(), NumEntries);
+        return Handles;
+    }
+
+    // An empty database takes its dimension from the first usable vector
+    int32 Dimension = Vectors.Num() > 0 ? Vectors.GetDimension() : 0;
+    for (int32 i = 0; i < NumEntries && Dimension == 0; ++i)
+    {
+        Dimension = GetVector(i).Num();
+    }
+
+    // Validate everything up front so storage can be sized exactly once
+    TArray<int32> Accepted;
+    Accepted.Reserve(NumEntries);
+    for (int32 i = 0; i < NumEntries; ++i)
+    {
+        if (IsValidEntry(i) && GetVector(i).Num() == Dimension && Dimension > 0)
+        {
+            Accepted.Add(i);
+        }
+    }
+
+    if (Accepted.Num() < NumEntries)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AddEntriesBulk: Skipped %d entries with an invalid payload or a vector dimension other than %d"),
+               NumEntries - Accepted.Num(), Dimension);
+    }
+
+    if (Accepted.Num() == 0)
+    {
+        return Handles;
+    }
+
+    const int32 FirstNewRow = Vectors.Num();
+    const int32 NumRowsAfter = FirstNewRow + Accepted.Num();
+
+    if (FirstNewRow == 0)
+    {
+        Vectors.SetDimension(Dimension);
+    }
+    Vectors.Reserve(NumRowsAfter);
+    Payloads.Reserve(NumRowsAfter);
+    RowHandles.Reserve(NumRowsAfter);
+    HandleRows.Reserve(NumRowsAfter);
+    RowCategories.Reserve(NumRowsAfter);
+
+    static const FString NoCategory;
+    for (const int32 i : Accepted)
+    {
+        const FString& Category = Categories.Num() == 0 ? NoCategory : Categories[Categories.Num() == 1 ? 0 : i];
+        AddPayload(i);
+        Handles[i] = AppendRow(GetVector(i), Category);
+    }
+
+    // Derived structures are extended once for the whole batch
+    if (Index)
+    {
+        if (Accepted.Num() >= FirstNewRow)
+        {
+            // At least doubling the database: a fresh build trains IVF centroids on the full data instead of the first rows
+            Index->Build(Vectors, DistanceMetric);
+        }
+        else
+        {
+            // An untrained IVF trains and assigns every stored row as soon as enough have arrived, ending the loop early
+            while (Index->Num() < NumRowsAfter)
+            {
+                Index->AddRow(Vectors, Index->Num());
+            }
+        }
+    }
+    if (Quantizer)
+    {
+        if (!Quantizer->IsTrained())
+        {
+            // Trains once if the batch brought enough rows, instead of retrying on every append
+            Quantizer->Train(Vectors, DistanceMetric);
+        }
+        else
+        {
+            while (Quantizer->Num() < NumRowsAfter)
+            {
+                Quantizer->AddRow(Vectors, Quantizer->Num());
+            }
+        }
+    }
+
+    return Handles;
+}
+
+int64 UVectorDatabase::AddStructEntry(const TArray<float>& Vector, UScriptStruct* StructType, const void* StructPtr, const FString& Category)
+{
+    if (!StructType || !StructPtr)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddStructEntry: Invalid StructType or StructPtr"));
+        return INDEX_NONE;
+    }
+
+    if (!CanAddVector(Vector, TEXT("AddStructEntry")))
+    {
+        return INDEX_NONE;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("AddStructEntry: StructType: %s, StructSize: %d"), *StructType->GetName(), StructType->GetStructureSize());
+
+    static const TMap<FString, FString> NoMetadata;
+    Payloads.AddStruct(StructType, StructPtr, NoMetadata);
+    return InsertRow(Vector, Category);
+}
+
+TArray<UVectorEntryWrapper*> UVectorDatabase::GetTopNMatches(const TArray<float>& QueryVector, int32 N, EEntryType EntryType, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    FVectorPartitionSelection Selection;
+    const bool bUsePartitions = SelectPartitions(CategoryFilter, EntryType, Selection);
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, EntryType, &CategoryFilter](int32 Row) {
+            return Payloads.GetType(Row) == EntryType && CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<UVectorEntryWrapper*> Result;
+    Result.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        Result.Add(Payloads.MakeWrapper(Hit.Row, CategoryTable.GetName(RowCategories[Hit.Row])));
+    }
+
+    return Result;
+}
+
+TArray<FString> UVectorDatabase::GetTopNStringMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    FVectorPartitionSelection Selection;
+    const bool bUsePartitions = SelectPartitions(CategoryFilter, EEntryType::String, Selection);
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, &CategoryFilter](int32 Row) {
+            return Payloads.GetType(Row) == EEntryType::String && CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<FString> Result;
+    Result.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        Result.Add(Payloads.GetString(Hit.Row));
+    }
+
+    return Result;
+}
+
+TArray<UObject*> UVectorDatabase::GetTopNObjectMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    FVectorPartitionSelection Selection;
+    const bool bUsePartitions = SelectPartitions(CategoryFilter, EEntryType::Object, Selection);
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, &CategoryFilter](int32 Row) {
+            return Payloads.GetType(Row) == EEntryType::Object && CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<UObject*> Result;
+    Result.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        // Objects destroyed since they were added are nulled by the garbage collector
+        if (UObject* Object = Payloads.GetObject(Hit.Row))
+        {
+            Result.Add(Object);
+        }
+    }
+
+    return Result;
+}
+
+TArray<FVectorDatabaseResult> UVectorDatabase::GetTopNStructMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    FVectorPartitionSelection Selection;
+    const bool bUsePartitions = SelectPartitions(CategoryFilter, EEntryType::Struct, Selection);
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, &CategoryFilter](int32 Row) {
+            return Payloads.GetType(Row) == EEntryType::Struct && CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<FVectorDatabaseResult> Results;
+    Results.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        FVectorDatabaseResult Result;
+        Result.Distance = Hit.Distance;
+        Result.StructType = Payloads.GetStructType(Hit.Row);
+        Result.StructData = Payloads.GetStructData(Hit.Row);
+        Result.Category = CategoryTable.GetName(RowCategories[Hit.Row]);
+        Result.Metadata = Payloads.GetMetadata(Hit.Row);
+        Result.Handle = RowHandles[Hit.Row];
+        Results.Add(Result);
+    }
+
+    return Results;
+}
+
+TArray<FVectorDatabaseEntry> UVectorDatabase::GetTopNEntriesWithDetails(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    FVectorPartitionSelection Selection;
+    const bool bUsePartitions = SelectPartitions(CategoryFilter, TOptional<EEntryType>(), Selection);
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, &CategoryFilter](int32 Row) {
+            return CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<FVectorDatabaseEntry> Results;
+    Results.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        Results.Add(MakeEntryResult(Hit.Row, Hit.Distance));
+    }
+
+    return Results;
+}
+
+TArray<FVectorDatabaseEntry> UVectorDatabase::GetTopNEntriesFiltered(const TArray<float>& QueryVector, int32 N, const FVectorSearchFilter& Filter) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Filter.Categories);
+
+    // Required key/value pairs are shorthand for Equals predicates
+    TArray<FVectorMetadataPredicate> Predicates = Filter.MetadataPredicates;
+    for (const TPair<FString, FString>& Required : Filter.RequiredMetadata)
+    {
+        FVectorMetadataPredicate& Predicate = Predicates.AddDefaulted_GetRef();
+        Predicate.Key = Required.Key;
+        Predicate.Type = EVectorMetadataPredicateType::Equals;
+        Predicate.Value = Required.Value;
+    }
+
+    // The metadata index turns the predicates into a candidate bitset before any vector is touched
+    TBitArray<> MetadataRows;
+    const bool bHasMetadataFilter = MetadataIndex.Evaluate(Predicates, MetadataRows);
+
+    FVectorPartitionSelection Selection;
+    TArray<int32> CandidateRows;
+    bool bUsePartitions;
+    if (bHasMetadataFilter)
+    {
+        // The exact candidate list is the tightest partition there is
+        for (TConstSetBitIterator<> It(MetadataRows); It; ++It)
+        {
+            if (CategoryFilter.Accepts(RowCategories[It.GetIndex()]))
+            {
+                CandidateRows.Add(It.GetIndex());
+            }
+        }
+        Selection.Partitions.Add(&CandidateRows);
+        Selection.NumRows = CandidateRows.Num();
+        bUsePartitions = true;
+    }
+    else
+    {
+        bUsePartitions = SelectPartitions(CategoryFilter, TOptional<EEntryType>(), Selection);
+    }
+
+    TArray<FVectorSearchHit> Hits;
+    FindTopRows(QueryVector, N,
+        [this, &CategoryFilter, &MetadataRows, bHasMetadataFilter](int32 Row) {
+            return CategoryFilter.Accepts(RowCategories[Row]) && (!bHasMetadataFilter || MetadataRows[Row]);
+        },
+        Hits, bUsePartitions ? &Selection : nullptr);
+
+    TArray<FVectorDatabaseEntry> Results;
+    Results.Reserve(Hits.Num());
+    for (const FVectorSearchHit& Hit : Hits)
+    {
+        Results.Add(MakeEntryResult(Hit.Row, Hit.Distance));
+    }
+
+    return Results;
+}
+
+TArray<FVectorSearchQueryResult> UVectorDatabase::GetTopNMatchesBatch(const TArray<TArray<float>>& QueryVectors, int32 N, const TArray<FString>& Categories) const
+{
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    TArray<TArray<FVectorSearchHit>> Hits;
+    FindTopRowsBatch(QueryVectors, N,
+        [this, &CategoryFilter](int32 Row) {
+            return CategoryFilter.Accepts(RowCategories[Row]);
+        },
+        Hits);
+
+    TArray<FVectorSearchQueryResult> Results;
+    Results.SetNum(Hits.Num());
+    for (int32 Query = 0; Query < Hits.Num(); ++Query)
+    {
+        TArray<FVectorDatabaseEntry>& Matches = Results[Query].Matches;
+        Matches.Reserve(Hits[Query].Num());
+        for (const FVectorSearchHit& Hit : Hits[Query])
+        {
+            Matches.Add(MakeEntryResult(Hit.Row, Hit.Distance));
+        }
+    }
+
+    return Results;
+}
+
+TArray<FVectorDatabaseEntry> UVectorDatabase::GetAllVectorEntries(const TArray<FString>& Categories) const
+{
+    TArray<FVectorDatabaseEntry> Results;
+    const FVectorCategoryFilter CategoryFilter = CategoryTable.CompileFilter(Categories);
+
+    int32 NumEntries = Payloads.Num();
+    for (int32 i = 0; i < NumEntries; ++i)
+    {
+        if (!RemovedRows[i] && CategoryFilter.Accepts(RowCategories[i]))
+        {
+            Results.Add(MakeEntryResult(i, 0.0f));
+        }
+    }
+
+    return Results;
+}
+
+FVectorDatabaseEntry UVectorDatabase::MakeEntryResult(int32 Row, float Distance) const
+{
+    FVectorDatabaseEntry Result;
+    Result.Distance = Distance;
+    Result.Handle = RowHandles[Row];
+    Result.Vector = Vectors.CopyRow(Row);
+    Result.Entry = Payloads.MakeWrapper(Row, CategoryTable.GetName(RowCategories[Row]));
+    return Result;
+}
+
+float UVectorDatabase::CalculateDistance(const float* Vec1, const float* Vec2, int32 Dimension) const
+{
+    // Cosine returns the cosine similarity (higher is better), matching the sort order used by the query functions
+    return VectorDistance::GetKernel(DistanceMetric).Single(Vec1, Vec2, Dimension);
+}
+
+void UVectorDatabase::ScanRows(const float* Query, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, TFunctionRef<void(int32 Row, float Distance)> Visitor) const
+{
+    const FVectorRowScorer Scorer(DistanceMetric);
+
+    int32 AcceptedRows[VectorDistance::BatchSize];
+    float Scores[VectorDistance::BatchSize];
+
+    for (int32 BlockStart = FirstRow; BlockStart < EndRow; BlockStart += VectorDistance::BatchSize)
+    {
+        const int32 BlockSize = FMath::Min(VectorDistance::BatchSize, EndRow - BlockStart);
+
+        int32 NumAccepted = 0;
+        for (int32 i = 0; i < BlockSize; ++i)
+        {
+            if (Filter(BlockStart + i))
+            {
+                AcceptedRows[NumAccepted++] = BlockStart + i;
+            }
+        }
+
+        if (NumAccepted == BlockSize)
+        {
+            // Whole block passes the filter: score it in one contiguous sweep
+            Scorer.ScoreRows(Vectors, Query, BlockStart, BlockSize, Scores);
+            for (int32 i = 0; i < BlockSize; ++i)
+            {
+                Visitor(BlockStart + i, Scores[i]);
+            }
+        }
+        else
+        {
+            for (int32 i = 0; i < NumAccepted; ++i)
+            {
+                const int32 Row = AcceptedRows[i];
+                Visitor(Row, Scorer.ScoreRow(Vectors, Query, Row));
+            }
+        }
+    }
+}
+
+void UVectorDatabase::ScanRowsBatch(TArrayView<const float* const> Queries, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, TArrayView<FVectorTopK> OutTopK) const
+{
+    const FVectorRowScorer Scorer(DistanceMetric);
+
+    // A tile is read from memory once and then stays in cache while every query is scored against it
+    const int32 TileRows = FMath::Clamp(VectorDistance::TileBytes / FMath::Max(Vectors.GetStrideInBytes(), 1), 1, VectorDistance::BatchSize);
+
+    int32 AcceptedRows[VectorDistance::BatchSize];
+    float Scores[VectorDistance::BatchSize];
+
+    for (int32 TileStart = FirstRow; TileStart < EndRow; TileStart += TileRows)
+    {
+        const int32 TileSize = FMath::Min(TileRows, EndRow - TileStart);
+
+        // The filter does not depend on the query, so it runs once per row for the whole batch
+        int32 NumAccepted = 0;
+        for (int32 i = 0; i < TileSize; ++i)
+        {
+            if (Filter(TileStart + i))
+            {
+                AcceptedRows[NumAccepted++] = TileStart + i;
+            }
+        }
+
+        if (NumAccepted == 0)
+        {
+            continue;
+        }
+
+        for (int32 Query = 0; Query < Queries.Num(); ++Query)
+        {
+            FVectorTopK& TopK = OutTopK[Query];
+
+            if (NumAccepted == TileSize)
+            {
+                Scorer.ScoreRows(Vectors, Queries[Query], TileStart, TileSize, Scores);
+                for (int32 i = 0; i < TileSize; ++i)
+                {
+                    TopK.Add(TileStart + i, Scores[i]);
+                }
+            }
+            else
+            {
+                for (int32 i = 0; i < NumAccepted; ++i)
+                {
+                    const int32 Row = AcceptedRows[i];
+                    TopK.Add(Row, Scorer.ScoreRow(Vectors, Queries[Query], Row));
+                }
+            }
+        }
+    }
+}
+
+void UVectorDatabase::FindTopRows(const TArray<float>& QueryVector, int32 N, TFunctionRef<bool(int32 Row)> QueryFilter, TArray<FVectorSearchHit>& OutHits, const FVectorPartitionSelection* Partitions) const
+{
+    OutHits.Reset();
+
+    // No query can return more than the live rows, and N sizes every collector below
+    N = FMath::Min(N, Vectors.Num() - NumRemovedRows);
+    if (N <= 0 || QueryVector.Num() != Vectors.GetDimension())
+    {
+        return;
+    }
+
+    // Removed rows keep their place until the next compaction. They are rejected before the query's own
+    // filter runs, because their entries are already gone.
+    auto Filter = [this, &QueryFilter](int32 Row) {
+        return !RemovedRows[Row] && QueryFilter(Row);
+    };
+
+    if (Partitions && Partitions->NumRows == 0)
+    {
+        // No partition holds a matching row
+        return;
+    }
+
+    // The matching partitions are scored exactly on one thread, gathering their rows, while the full pass is spread across
+    // worker threads and, with a quantizer, sweeps the much smaller codes. Both are exact enough that only their cost decides.
+    const bool bQuantized = Quantizer && Quantizer->IsTrained() && Quantizer->Num() == Vectors.Num();
+    bool bScanPartitions = false;
+    if (Partitions)
+    {
+        int32 RowsPerChunk;
+        const int64 FullPassSpeedup = (bQuantized ? QuantizedScanSpeedup : 1) * GetNumScanChunks(RowsPerChunk);
+        bScanPartitions = static_cast<int64>(Partitions->NumRows) * 2 * FullPassSpeedup <= Vectors.Num();
+    }
+
+    bool bUseIndex = Index && Vectors.Num() >= IndexSettings.MinEntriesForIndex && Index->Num() == Vectors.Num();
+    if (bUseIndex && bScanPartitions && Partitions->NumRows < IndexSettings.MinEntriesForIndex)
+    {
+        bUseIndex = false;
+    }
+    if (bUseIndex && EstimateFilterSelectivity(Filter) < IndexSettings.ExactScanSelectivity)
+    {
+        // A walk through the graph or lists would visit mostly rejected rows; scanning the few matches exactly is cheaper and loses nothing
+        bUseIndex = false;
+    }
+
+    if (bUseIndex)
+    {
+        Index->Search(Vectors, QueryVector.GetData(), N, Filter, OutHits);
+        return;
+    }
+
+    // Exact scoring below works on the prepared query: for Cosine it is normalized once here instead of per row
+    const FVectorRowScorer Scorer(DistanceMetric);
+    TArray<float> QueryScratch;
+    const float* Query = Scorer.PrepareQuery(QueryVector.GetData(), QueryVector.Num(), QueryScratch);
+
+    if (bScanPartitions)
+    {
+        ScanPartitionRows(Query, N, *Partitions, Filter, OutHits);
+        return;
+    }
+
+    if (bQuantized)
+    {
+        const bool bRescore = QuantizationSettings.bRescore || Quantizer->RequiresRescore();
+        if (!bRescore)
+        {
+            ScanQuantizedRows(QueryVector.GetData(), N, Filter, OutHits);
+            return;
+        }
+
+        // Shortlist on the compressed codes, then rank the survivors by their exact distance
+        // Sized in 64 bits and clamped to the rows, so a large N or multiplier cannot overflow into a bogus shortlist
+        const int64 NumCandidates = FMath::Min<int64>(static_cast<int64>(N) * FMath::Max(QuantizationSettings.RescoreMultiplier, 1), Vectors.Num());
+        TArray<FVectorSearchHit> Candidates;
+        ScanQuantizedRows(QueryVector.GetData(), static_cast<int32>(NumCandidates), Filter, Candidates);
+
+        FVectorTopK TopK(N, VectorDistance::IsSimilarityMetric(DistanceMetric));
+        for (const FVectorSearchHit& Candidate : Candidates)
+        {
+            TopK.Add(Candidate.Row, Scorer.ScoreRow(Vectors, Query, Candidate.Row));
+        }
+
+        TopK.GetSortedHits(OutHits);
+        return;
+    }
+
+    ScanTopRows(Query, N, Filter, OutHits);
+}
+
+void UVectorDatabase::ScanTopRows(const float* Query, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const
+{
+    // Similarity metrics rank higher values first, distance metrics lower values first
+    const bool bHigherIsBetter = VectorDistance::IsSimilarityMetric(DistanceMetric);
+    const int32 NumRows = Vectors.Num();
+
+    int32 RowsPerChunk;
+    const int32 NumChunks = GetNumScanChunks(RowsPerChunk);
+
+    if (NumChunks == 1)
+    {
+        FVectorTopK TopK(N, bHigherIsBetter);
+        ScanRows(Query, 0, NumRows, Filter, [&TopK](int32 Row, float Distance) {
+            TopK.Add(Row, Distance);
+        });
+
+        TopK.GetSortedHits(OutHits);
+        return;
+    }
+
+    // Each chunk fills its own collector, so workers never contend; the K-sized results are merged afterwards
+    TArray<FVectorTopK> ChunkTopK;
+    ChunkTopK.SetNum(NumChunks);
+
+    ParallelFor(NumChunks, [this, Query, N, bHigherIsBetter, RowsPerChunk, NumRows, &Filter, &ChunkTopK](int32 Chunk)
+    {
+        FVectorTopK& TopK = ChunkTopK[Chunk];
+        TopK.Reset(N, bHigherIsBetter);
+
+        const int32 FirstRow = Chunk * RowsPerChunk;
+        ScanRows(Query, FirstRow, FMath::Min(FirstRow + RowsPerChunk, NumRows), Filter, [&TopK](int32 Row, float Distance) {
+            TopK.Add(Row, Distance);
+        });
+    });
+
+    FVectorTopK TopK(N, bHigherIsBetter);
+    for (const FVectorTopK& Partial : ChunkTopK)
+    {
+        TopK.Merge(Partial);
+    }
+
+    TopK.GetSortedHits(OutHits);
+}
+
+void UVectorDatabase::ScanQuantizedRows(const float* Query, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const
+{
+    // The query tables are built once and shared by every chunk
+    const TUniquePtr<FVectorQuantizerQuery> PreparedQuery = Quantizer->PrepareQuery(Query);
+    const bool bHigherIsBetter = PreparedQuery->bHigherIsBetter;
+    const int32 NumRows = Quantizer->Num();
+
+    int32 RowsPerChunk;
+    const int32 NumChunks = GetNumScanChunks(RowsPerChunk);
+
+    if (NumChunks == 1)
+    {
+        FVectorTopK TopK(N, bHigherIsBetter);
+        Quantizer->ScanRows(*PreparedQuery, 0, NumRows, Filter, TopK);
+
+        TopK.GetSortedHits(OutHits);
+        return;
+    }
+
+    // Same split as ScanTopRows: a collector per chunk, merged once every worker is done
+    TArray<FVectorTopK> ChunkTopK;
+    ChunkTopK.SetNum(NumChunks);
+
+    ParallelFor(NumChunks, [this, &PreparedQuery, N, bHigherIsBetter, RowsPerChunk, NumRows, &Filter, &ChunkTopK](int32 Chunk)
+    {
+        FVectorTopK& TopK = ChunkTopK[Chunk];
+        TopK.Reset(N, bHigherIsBetter);
+
+        const int32 FirstRow = Chunk * RowsPerChunk;
+        Quantizer->ScanRows(*PreparedQuery, FirstRow, FMath::Min(FirstRow + RowsPerChunk, NumRows), Filter, TopK);
+    });
+
+    FVectorTopK TopK(N, bHigherIsBetter);
+    for (const FVectorTopK& Partial : ChunkTopK)
+    {
+        TopK.Merge(Partial);
+    }
+
+    TopK.GetSortedHits(OutHits);
+}
+
+void UVectorDatabase::ScanPartitionRows(const float* Query, int32 N, const FVectorPartitionSelection& Partitions, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const
+{
+    const FVectorRowScorer Scorer(DistanceMetric);
+    FVectorTopK TopK(N, VectorDistance::IsSimilarityMetric(DistanceMetric));
+
+    float Scores[VectorDistance::BatchSize];
+
+    for (const TArray<int32>* Rows : Partitions.Partitions)
+    {
+        int32 i = 0;
+        while (i < Rows->Num())
+        {
+            // Rows added back to back sit next to each other in storage; score such runs in one contiguous sweep
+            const int32 FirstRow = (*Rows)[i];
+            int32 RunLength = 1;
+            while (i + RunLength < Rows->Num() && RunLength < VectorDistance::BatchSize && (*Rows)[i + RunLength] == FirstRow + RunLength)
+            {
+                ++RunLength;
+            }
+
+            if (RunLength > 1)
+            {
+                Scorer.ScoreRows(Vectors, Query, FirstRow, RunLength, Scores);
+                for (int32 j = 0; j < RunLength; ++j)
+                {
+                    if (Filter(FirstRow + j))
+                    {
+                        TopK.Add(FirstRow + j, Scores[j]);
+                    }
+                }
+            }
+            else if (Filter(FirstRow))
+            {
+                TopK.Add(FirstRow, Scorer.ScoreRow(Vectors, Query, FirstRow));
+            }
+
+            i += RunLength;
+        }
+    }
+
+    TopK.GetSortedHits(OutHits);
+}
+
+bool UVectorDatabase::SelectPartitions(const FVectorCategoryFilter& CategoryFilter, TOptional<EEntryType> EntryType, FVectorPartitionSelection& OutSelection) const
+{
+    // Without any restriction every partition would be selected and the plain scan is just as good
+    if (!bPartitioned || (CategoryFilter.AcceptsAll() && !EntryType.IsSet()))
+    {
+        return false;
+    }
+
+    for (int32 Partition = 0; Partition < PartitionRows.Num(); ++Partition)
+    {
+        const int32 CategoryId = Partition / NumEntryTypes;
+        const EEntryType PartitionType = static_cast<EEntryType>(Partition % NumEntryTypes);
+
+        if (PartitionRows[Partition].Num() > 0
+            && CategoryFilter.Accepts(CategoryId)
+            && (!EntryType.IsSet() || EntryType.GetValue() == PartitionType))
+        {
+            OutSelection.Partitions.Add(&PartitionRows[Partition]);
+            OutSelection.NumRows += PartitionRows[Partition].Num();
+        }
+    }
+
+    return true;
+}
+
+void UVectorDatabase::RebuildPartitions()
+{
+    PartitionRows.Reset();
+
+    if (!bPartitioned)
+    {
+        return;
+    }
+
+    PartitionRows.SetNum(CategoryTable.Num() * NumEntryTypes);
+    for (int32 Row = 0; Row < Payloads.Num(); ++Row)
+    {
+        if (!RemovedRows[Row])
+        {
+            PartitionRows[GetPartitionIndex(RowCategories[Row], Payloads.GetType(Row))].Add(Row);
+        }
+    }
+}
+
+void UVectorDatabase::SetPartitioned(bool bInPartitioned)
+{
+    if (bPartitioned == bInPartitioned)
+    {
+        return;
+    }
+
+    bPartitioned = bInPartitioned;
+    RebuildPartitions();
+}
+
+bool UVectorDatabase::IsPartitioned() const
+{
+    return bPartitioned;
+}
+
+int32 UVectorDatabase::GetNumScanChunks(int32& OutRowsPerChunk) const
+{
+    const int32 NumRows = Vectors.Num();
+
+    int32 NumChunks = 1;
+    if (MinRowsPerScanChunk > 0)
+    {
+        NumChunks = FMath::Clamp(NumRows / MinRowsPerScanChunk, 1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+    }
+
+    if (NumChunks == 1)
+    {
+        OutRowsPerChunk = NumRows;
+        return 1;
+    }
+
+    // Chunk boundaries fall on kernel batch boundaries so every chunk keeps full contiguous sweeps
+    OutRowsPerChunk = Align(FMath::DivideAndRoundUp(NumRows, NumChunks), VectorDistance::BatchSize);
+    return FMath::DivideAndRoundUp(NumRows, OutRowsPerChunk);
+}
+
+void UVectorDatabase::FindTopRowsBatch(const TArray<TArray<float>>& QueryVectors, int32 N, TFunctionRef<bool(int32 Row)> QueryFilter, TArray<TArray<FVectorSearchHit>>& OutHits) const
+{
+    OutHits.Reset();
+    OutHits.SetNum(QueryVectors.Num());
+
+    N = FMath::Min(N, Vectors.Num() - NumRemovedRows);
+    if (N <= 0)
+    {
+        return;
+    }
+
+    // Queries of the wrong dimension get an empty result, like FindTopRows
+    TArray<int32> QueryIndices;
+    for (int32 Query = 0; Query < QueryVectors.Num(); ++Query)
+    {
+        if (QueryVectors[Query].Num() == Vectors.GetDimension())
+        {
+            QueryIndices.Add(Query);
+        }
+    }
+
+    if (QueryIndices.Num() == 0)
+    {
+        return;
+    }
+
+    const bool bUseIndex = Index && Vectors.Num() >= IndexSettings.MinEntriesForIndex && Index->Num() == Vectors.Num();
+    const bool bUseQuantizer = Quantizer && Quantizer->IsTrained() && Quantizer->Num() == Vectors.Num();
+    if (bUseIndex || bUseQuantizer)
+    {
+        // Graph walks and code scans are driven by one query at a time, so run the queries side by side instead
+        ParallelFor(QueryIndices.Num(), [this, N, &QueryFilter, &QueryVectors, &QueryIndices, &OutHits](int32 i)
+        {
+            FindTopRows(QueryVectors[QueryIndices[i]], N, QueryFilter, OutHits[QueryIndices[i]]);
+        });
+        return;
+    }
+
+    auto Filter = [this, &QueryFilter](int32 Row) {
+        return !RemovedRows[Row] && QueryFilter(Row);
+    };
+
+    // Every query is prepared once, so each tile only costs a dot product per query and row for Cosine
+    const FVectorRowScorer Scorer(DistanceMetric);
+    TArray<TArray<float>> QueryScratch;
+    QueryScratch.SetNum(QueryIndices.Num());
+    TArray<const float*> Queries;
+    Queries.Reserve(QueryIndices.Num());
+    for (int32 i = 0; i < QueryIndices.Num(); ++i)
+    {
+        Queries.Add(Scorer.PrepareQuery(QueryVectors[QueryIndices[i]].GetData(), Vectors.GetDimension(), QueryScratch[i]));
+    }
+
+    const bool bHigherIsBetter = VectorDistance::IsSimilarityMetric(DistanceMetric);
+    const int32 NumQueries = Queries.Num();
+    const int32 NumRows = Vectors.Num();
+
+    int32 RowsPerChunk;
+    const int32 NumChunks = GetNumScanChunks(RowsPerChunk);
+
+    // One collector per (chunk, query) pair; chunks own disjoint slices so workers never contend
+    TArray<FVectorTopK> ChunkTopK;
+    ChunkTopK.SetNum(NumChunks * NumQueries);
+    for (FVectorTopK& TopK : ChunkTopK)
+    {
+        TopK.Reset(N, bHigherIsBetter);
+    }
+
+    ParallelFor(NumChunks, [this, NumQueries, RowsPerChunk, NumRows, &Filter, &Queries, &ChunkTopK](int32 Chunk)
+    {
+        const int32 FirstRow = Chunk * RowsPerChunk;
+        ScanRowsBatch(Queries, FirstRow, FMath::Min(FirstRow + RowsPerChunk, NumRows), Filter,
+            TArrayView<FVectorTopK>(ChunkTopK.GetData() + Chunk * NumQueries, NumQueries));
+    });
+
+    for (int32 Query = 0; Query < NumQueries; ++Query)
+    {
+        FVectorTopK TopK(N, bHigherIsBetter);
+        for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+        {
+            TopK.Merge(ChunkTopK[Chunk * NumQueries + Query]);
+        }
+
+        TopK.GetSortedHits(OutHits[QueryIndices[Query]]);
+    }
+}
+
+void UVectorDatabase::SetMinRowsPerScanChunk(int32 InMinRows)
+{
+    MinRowsPerScanChunk = FMath::Max(InMinRows, 0);
+}
+
+int32 UVectorDatabase::GetMinRowsPerScanChunk() const
+{
+    return MinRowsPerScanChunk;
+}
+
+void UVectorDatabase::RebuildMetadataIndex()
+{
+    MetadataIndex.Empty();
+    for (int32 Row = 0; Row < Payloads.Num(); ++Row)
+    {
+        // Removed rows have released their metadata, so they keep their slot but match nothing
+        MetadataIndex.AddRow(Row, Payloads.GetMetadata(Row));
+    }
+}
+
+float UVectorDatabase::EstimateFilterSelectivity(TFunctionRef<bool(int32 Row)> Filter) const
+{
+    const int32 NumRows = Vectors.Num();
+    const int32 NumSamples = FMath::Min(NumRows, FilterSelectivitySamples);
+    if (NumSamples == 0)
+    {
+        return 1.0f;
+    }
+
+    // Evenly spaced rather than random rows, so repeated queries always take the same path
+    int32 NumAccepted = 0;
+    for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+    {
+        if (Filter(static_cast<int32>(static_cast<int64>(Sample) * NumRows / NumSamples)))
+        {
+            NumAccepted++;
+        }
+    }
+
+    return static_cast<float>(NumAccepted) / NumSamples;
+}
+
+TArray<int32> UVectorDatabase::CountRowsPerCategory() const
+{
+    TArray<int32> Counts;
+    Counts.SetNumZeroed(CategoryTable.Num());
+    for (int32 Row = 0; Row < RowCategories.Num(); ++Row)
+    {
+        if (!RemovedRows[Row])
+        {
+            Counts[RowCategories[Row]]++;
+        }
+    }
+    return Counts;
+}
+
+int32 UVectorDatabase::GetNumberOfEntries() const
+{
+    return Payloads.Num() - NumRemovedRows;
+}
+
+int32 UVectorDatabase::GetNumberOfStringEntries() const
+{
+    return CountEntriesOfType(Payloads, RemovedRows, EEntryType::String);
+}
+
+int32 UVectorDatabase::GetNumberOfObjectEntries() const
+{
+    return CountEntriesOfType(Payloads, RemovedRows, EEntryType::Object);
+}
+
+int32 UVectorDatabase::GetNumberOfStructEntries() const
+{
+    return CountEntriesOfType(Payloads, RemovedRows, EEntryType::Struct);
+}
+
+bool UVectorDatabase::RemoveEntry(const TArray<float>& Vector, bool bRemoveAllOccurrences, float RemovalRange)
+{
+    bool bEntryRemoved = false;
+
+    // Validate the input vector
+    if (Vector.Num() == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("RemoveEntry called with an empty vector."));
+        return false;
+    }
+
+    //clamp removalrange to above 0
+    if(RemovalRange < 0.0f){
+        RemovalRange = 0.0f;
+    }
+
+    if (Vector.Num() != Vectors.GetDimension())
+    {
+        return false;
+    }
+
+    const FVectorRowScorer Scorer(DistanceMetric);
+    TArray<float> QueryScratch;
+    const float* Query = Scorer.PrepareQuery(Vector.GetData(), Vector.Num(), QueryScratch);
+
+    // Reverse order so that a single removal still takes the most recent match
+    for (int32 i = Vectors.Num() - 1; i >= 0; --i)
+    {
+        if (RemovedRows[i])
+        {
+            continue;
+        }
+
+        // Check if the current vector should be removed based on the distance or exact match
+        bool bWithinRange = false;
+        if (RemovalRange > 0.0f)
+        {
+            float Distance = Scorer.ScoreRow(Vectors, Query, i);
+            if (DistanceMetric == EVectorDistanceMetric::Cosine)
+            {
+                // Compare ranges against cosine distance rather than similarity
+                Distance = 1.0f - Distance;
+            }
+            bWithinRange = Distance <= RemovalRange;
+        }
+
+        if (bWithinRange || Vectors.RowEquals(i, Vector))
+        {
+            RemoveRow(i);
+            bEntryRemoved = true;
+
+            // If we're not removing all occurrences, break after the first match
+            if (!bRemoveAllOccurrences)
+            {
+                break;
+            }
+        }
+    }
+
+    return bEntryRemoved;
+}
+
+bool UVectorDatabase::RemoveEntryByHandle(int64 Handle)
+{
+    const int32* Row = HandleRows.Find(Handle);
+    if (!Row)
+    {
+        return false;
+    }
+
+    RemoveRow(*Row);
+    return true;
+}
+
+bool UVectorDatabase::UpdateEntryVector(int64 Handle, const TArray<float>& NewVector)
+{
+    const int32* Row = HandleRows.Find(Handle);
+    if (!Row)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("UpdateEntryVector: Unknown handle %lld"), Handle);
+        return false;
+    }
+
+    if (NewVector.Num() != Vectors.GetDimension())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("UpdateEntryVector: Vector dimension mismatch. Expected %d, got %d"),
+               Vectors.GetDimension(), NewVector.Num());
+        return false;
+    }
+
+    Vectors.SetRow(*Row, NewVector);
+    if (Index)
+    {
+        Index->UpdateRow(Vectors, *Row);
+    }
+    if (Quantizer)
+    {
+        Quantizer->UpdateRow(Vectors, *Row);
+    }
+
+    return true;
+}
+
+int32 UVectorDatabase::UpdateEntryVectors(const TArray<FVectorEntryUpdate>& Updates)
+{
+    // Every row is written before any index work, so relinking sees where all the moved entries ended up
+    TArray<int32> UpdatedRows;
+    UpdatedRows.Reserve(Updates.Num());
+    TBitArray<> IsUpdated(false, Vectors.Num());
+    for (const FVectorEntryUpdate& Update : Updates)
+    {
+        const int32* Row = HandleRows.Find(Update.Handle);
+        if (!Row || Update.Vector.Num() != Vectors.GetDimension())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("UpdateEntryVectors: Skipping handle %lld (unknown handle or dimension mismatch)"), Update.Handle);
+            continue;
+        }
+
+        Vectors.SetRow(*Row, Update.Vector);
+        if (!IsUpdated[*Row])
+        {
+            IsUpdated[*Row] = true;
+            UpdatedRows.Add(*Row);
+        }
+    }
+
+    if (UpdatedRows.Num() == 0)
+    {
+        return 0;
+    }
+
+    if (Quantizer)
+    {
+        // Every row owns its code, so re-encoding is spread across worker threads
+        ParallelFor(UpdatedRows.Num(), [this, &UpdatedRows](int32 i)
+        {
+            Quantizer->UpdateRow(Vectors, UpdatedRows[i]);
+        });
+    }
+
+    if (Index)
+    {
+        if (UpdatedRows.Num() * 2 > Vectors.Num())
+        {
+            // Relinking most of the rows one at a time costs more than building the index again
+            Index->Build(Vectors, DistanceMetric);
+        }
+        else
+        {
+            for (const int32 Row : UpdatedRows)
+            {
+                Index->UpdateRow(Vectors, Row);
+            }
+        }
+    }
+
+    return UpdatedRows.Num();
+}
+
+bool UVectorDatabase::ContainsHandle(int64 Handle) const
+{
+    return HandleRows.Contains(Handle);
+}
+
+bool UVectorDatabase::SetEntryMetadata(int64 Handle, const TMap<FString, FString>& Metadata)
+{
+    const int32* Row = HandleRows.Find(Handle);
+    if (!Row)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetEntryMetadata: Unknown handle %lld"), Handle);
+        return false;
+    }
+
+    // Only this row's postings change, so the rest of the index is left alone
+    const TMap<FString, FString> OldMetadata = Payloads.GetMetadata(*Row);
+    Payloads.SetMetadata(*Row, Metadata);
+    MetadataIndex.UpdateRow(*Row, OldMetadata, Payloads.GetMetadata(*Row));
+    return true;
+}
+
+void UVectorDatabase::RemoveRow(int32 Row)
+{
+    check(!RemovedRows[Row]);
+
+    Payloads.Release(Row);
+
+    HandleRows.Remove(RowHandles[Row]);
+    RemovedRows[Row] = true;
+    NumRemovedRows++;
+
+    // The row stays in the partition lists and the metadata index until compaction; queries reject it anyway
+    ScheduleCompaction();
+}
+
+void UVectorDatabase::ScheduleCompaction()
+{
+    if (!bAutoCompaction || CompactionTickerHandle.IsValid() || !NeedsCompaction())
+    {
+        return;
+    }
+
+    // Deferred rather than run here, so the rest of a removal burst lands before the pass and the caller never stalls mid-loop
+    CompactionTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float DeltaTime)
+    {
+        CompactionTickerHandle.Reset();
+        if (bAutoCompaction)
+        {
+            CompactIfNeeded();
+        }
+        return false;
+    }));
+}
+
+bool UVectorDatabase::NeedsCompaction() const
+{
+    // Waiting for a fraction of the rows keeps the cost of each compaction pass spread over many removals
+    return CompactionThreshold > 0.0f && NumRemovedRows > 0 && NumRemovedRows >= Vectors.Num() * CompactionThreshold;
+}
+
+bool UVectorDatabase::CompactIfNeeded()
+{
+    if (!NeedsCompaction())
+    {
+        return false;
+    }
+
+    Compact();
+    return true;
+}
+
+void UVectorDatabase::Compact()
+{
+    if (NumRemovedRows == 0)
+    {
+        return;
+    }
+
+    const int32 NumRows = Vectors.Num();
+
+    TArray<int32> RowRemap;
+    RowRemap.SetNumUninitialized(NumRows);
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        RowRemap[Row] = RemovedRows[Row] ? INDEX_NONE : NumKept++;
+    }
+
+    // The index repairs its links using the old rows, so it goes before the storage
+    if (Index)
+    {
+        Index->Compact(Vectors, RowRemap);
+    }
+    if (Quantizer)
+    {
+        Quantizer->Compact(RowRemap);
+    }
+    Vectors.Compact(RowRemap);
+
+    Payloads.Compact(RowRemap);
+    CompactRowArray(RowCategories, RowRemap);
+    CompactRowArray(RowHandles, RowRemap);
+
+    for (int32 Row = 0; Row < NumKept; ++Row)
+    {
+        HandleRows.FindChecked(RowHandles[Row]) = Row;
+    }
+
+    RemovedRows.Init(false, NumKept);
+    NumRemovedRows = 0;
+
+    RebuildPartitions();
+    RebuildMetadataIndex();
+}
+
+void UVectorDatabase::SetCompactionThreshold(float InThreshold)
+{
+    CompactionThreshold = FMath::Clamp(InThreshold, 0.0f, 1.0f);
+    ScheduleCompaction();
+}
+
+float UVectorDatabase::GetCompactionThreshold() const
+{
+    return CompactionThreshold;
+}
+
+void UVectorDatabase::SetAutoCompaction(bool bInAutoCompaction)
+{
+    bAutoCompaction = bInAutoCompaction;
+    ScheduleCompaction();
+}
+
+bool UVectorDatabase::IsAutoCompactionEnabled() const
+{
+    return bAutoCompaction;
+}
+
+FVectorDatabaseStats UVectorDatabase::GetDatabaseStats() const
+{
+    FVectorDatabaseStats Stats;
+    Stats.TotalEntries = GetNumberOfEntries();
+    Stats.StringEntries = GetNumberOfStringEntries();
+    Stats.ObjectEntries = GetNumberOfObjectEntries();
+    Stats.StructEntries = GetNumberOfStructEntries();
+    Stats.VectorDimension = GetVectorDimension();
+    
+    // Collect categories and counts
+    const TArray<int32> Counts = CountRowsPerCategory();
+    for (int32 CategoryId = 0; CategoryId < Counts.Num(); ++CategoryId)
+    {
+        const FString& Category = CategoryTable.GetName(CategoryId);
+        if (Counts[CategoryId] > 0 && !Category.IsEmpty())
+        {
+            Stats.Categories.Add(Category);
+            Stats.CategoryCounts.Add(Category, Counts[CategoryId]);
+        }
+    }
+    
+    return Stats;
+}
+
+TArray<FString> UVectorDatabase::GetUniqueCategories() const
+{
+    const TArray<int32> Counts = CountRowsPerCategory();
+
+    TArray<FString> Result;
+    for (int32 CategoryId = 0; CategoryId < Counts.Num(); ++CategoryId)
+    {
+        const FString& Category = CategoryTable.GetName(CategoryId);
+        if (Counts[CategoryId] > 0 && !Category.IsEmpty())
+        {
+            Result.Add(Category);
+        }
+    }
+    
+    return Result;
+}
+
+int32 UVectorDatabase::GetEntryCountForCategory(const FString& Category) const
+{
+    const int32 CategoryId = CategoryTable.Find(Category);
+    if (CategoryId == INDEX_NONE)
+    {
+        return 0;
+    }
+
+    int32 Count = 0;
+    for (int32 Row = 0; Row < RowCategories.Num(); ++Row)
+    {
+        if (!RemovedRows[Row] && RowCategories[Row] == CategoryId)
+        {
+            Count++;
+        }
+    }
+    return Count;
+}
+
+TArray<FVectorDatabaseEntry> UVectorDatabase::GetEntriesForCategory(const FString& Category) const
+{
+    TArray<FVectorDatabaseEntry> Result;
+
+    const int32 CategoryId = CategoryTable.Find(Category);
+    if (CategoryId == INDEX_NONE)
+    {
+        return Result;
+    }
+    
+    for (int32 i = 0; i < Payloads.Num(); ++i)
     {
-        if (Entry && Entry->IsValidLowLevel())
+        if (!RemovedRows[i] && RowCategories[i] == CategoryId)
         {
-            Entry->ConditionalBeginDestroy();
+            Result.Add(MakeEntryResult(i, 0.0f));
         }
     }
-    Entries.Empty();
-    Vectors.Empty();
+    
+    return Result;
 }
 
-void UVectorDatabase::AddEntry(const TArray<float>& Vector, UVectorEntryWrapper* Entry, const FString& Category)
+void UVectorDatabase::SetDistanceMetric(EVectorDistanceMetric InMetric)
 {
-    if (!Entry || !IsValid(Entry))
-    {
-        UE_LOG(LogTemp, Error, TEXT("AddEntry: Invalid Entry"));
-        return;
-    }
-
-    // Validate vector dimension consistency
-    if (Vectors.Num() > 0 && Vectors[0].Num() != Vector.Num())
+    if (DistanceMetric == InMetric)
     {
-        UE_LOG(LogTemp, Warning, TEXT("AddEntry: Vector dimension mismatch. Expected %d, got %d"), 
-               Vectors[0].Num(), Vector.Num());
         return;
     }
 
-    Entry->Category = Category;
+    DistanceMetric = InMetric;
 
-    int32 NewIndex = Entries.Add(Entry);
-    if (NewIndex != INDEX_NONE)
+    // Graph neighbourhoods and codebooks depend on the metric
+    if (Index)
     {
-        Vectors.Add(Vector);
-        
-        Entry->Rename(nullptr, this);
+        RebuildIndex();
     }
-    else
+    if (Quantizer)
     {
-        UE_LOG(LogTemp, Error, TEXT("AddEntry: Failed to add Entry to Entries array"));
+        RetrainQuantizer();
     }
 }
 
-void UVectorDatabase::AddStructEntry(const TArray<float>& Vector, UScriptStruct* StructType, const void* StructPtr, const FString& Category)
+EVectorDistanceMetric UVectorDatabase::GetDistanceMetric() const
 {
-    if (!StructType || !StructPtr)
+    return DistanceMetric;
+}
+
+void UVectorDatabase::ClearDatabase()
+{
+    Payloads.Empty();
+    Vectors.Empty();
+    RowHandles.Empty();
+    HandleRows.Empty();
+    RemovedRows.Empty();
+    NumRemovedRows = 0;
+    RowCategories.Empty();
+    CategoryTable.Empty();
+    PartitionRows.Empty();
+    MetadataIndex.Empty();
+
+    if (Index)
     {
-        UE_LOG(LogTemp, Error, TEXT("AddStructEntry: Invalid StructType or StructPtr"));
-        return;
+        Index->Build(Vectors, DistanceMetric);
     }
-
-    UVectorEntryWrapper* Wrapper = NewObject<UVectorEntryWrapper>(this);
-    if (!Wrapper)
+    if (Quantizer)
     {
-        UE_LOG(LogTemp, Error, TEXT("AddStructEntry: Failed to create UVectorEntryWrapper"));
-        return;
+        Quantizer->Train(Vectors, DistanceMetric);
     }
-
-    Wrapper->SetStructData(StructType, StructPtr);
-    Wrapper->EntryType = EEntryType::Struct;
-    Wrapper->Category = Category;
-    
-    UE_LOG(LogTemp, Log, TEXT("AddStructEntry: StructType: %s, StructSize: %d"), *StructType->GetName(), StructType->GetStructureSize());
-    UE_LOG(LogTemp, Log, TEXT("AddStructEntry: Wrapper->StructData.Num(): %d"), Wrapper->StructData.Num());
-
-    AddEntry(Vector, Wrapper, Category);
 }
 
-TArray<UVectorEntryWrapper*> UVectorDatabase::GetTopNMatches(const TArray<float>& QueryVector, int32 N, EEntryType EntryType, const TArray<FString>& Categories) const
+void UVectorDatabase::ResetFromFileContents(FVectorDatabaseFileContents& Contents)
 {
-    TArray<TPair<float, UVectorEntryWrapper*>> DistanceEntryPairs;
-    
-    for (int32 i = 0; i < Vectors.Num(); ++i)
+    check(Contents.Payloads.Num() == Contents.Vectors.Num() && Contents.RowCategories.Num() == Contents.Vectors.Num());
+
+    Payloads = MoveTemp(Contents.Payloads);
+    Vectors = MoveTemp(Contents.Vectors);
+    Contents.Vectors.Empty();
+    DistanceMetric = Contents.DistanceMetric;
+
+    const int32 NumRows = Vectors.Num();
+
+    CategoryTable.Empty();
+    TArray<int32> CategoryIds;
+    CategoryIds.Reserve(Contents.Categories.Num());
+    for (const FString& Category : Contents.Categories)
     {
-        if (Entries[i]->EntryType == EntryType && QueryVector.Num() == Vectors[i].Num() && ShouldIncludeEntry(Entries[i], Categories))
-        {
-            float Distance = CalculateDistance(QueryVector, Vectors[i]);
-            DistanceEntryPairs.Add(TPair<float, UVectorEntryWrapper*>(Distance, Entries[i]));
-        }
+        CategoryIds.Add(CategoryTable.Intern(Category));
     }
 
-    // Sort based on distance metric
-    if (DistanceMetric == EVectorDistanceMetric::Cosine || DistanceMetric == EVectorDistanceMetric::DotProduct)
+    static const FString NoCategory;
+    RowCategories.SetNumUninitialized(NumRows);
+    for (int32 Row = 0; Row < NumRows; ++Row)
     {
-        // For similarity metrics, higher values are better
-        DistanceEntryPairs.Sort([](const TPair<float, UVectorEntryWrapper*>& A, const TPair<float, UVectorEntryWrapper*>& B) {
-            return A.Key > B.Key;
-        });
+        const int32 CategoryIndex = Contents.RowCategories[Row];
+        RowCategories[Row] = CategoryIndex != INDEX_NONE ? CategoryIds[CategoryIndex] : CategoryTable.Intern(NoCategory);
     }
-    else
+
+    // Handles are never reused, so the new rows continue from the last handle given out
+    RowHandles.SetNumUninitialized(NumRows);
+    HandleRows.Empty(NumRows);
+    for (int32 Row = 0; Row < NumRows; ++Row)
     {
-        // For distance metrics, lower values are better
-        DistanceEntryPairs.Sort([](const TPair<float, UVectorEntryWrapper*>& A, const TPair<float, UVectorEntryWrapper*>& B) {
-            return A.Key < B.Key;
-        });
+        RowHandles[Row] = NextHandle++;
+        HandleRows.Add(RowHandles[Row], Row);
     }
 
-    TArray<UVectorEntryWrapper*> Result;
-    for (int32 i = 0; i < FMath::Min(N, DistanceEntryPairs.Num()); ++i)
+    RemovedRows.Init(false, NumRows);
+    NumRemovedRows = 0;
+
+    // Saved structures are matched against the checksum saved with the rows, so mapped rows are not all read at open.
+    // Sources written before it was saved have to hash the rows, which is still far cheaper than building again.
+    const bool bHasSavedStructures = Contents.IndexData.Num() > 0 || Contents.QuantizerData.Num() > 0;
+    const uint64 VectorChecksum = Contents.VectorChecksum != 0 || !bHasSavedStructures ? Contents.VectorChecksum : Vectors.ComputeChecksum();
+
+    IndexSettings = Contents.IndexSettings;
+    if (!RestoreIndex(Contents.IndexData, VectorChecksum))
     {
-        Result.Add(DistanceEntryPairs[i].Value);
+        RebuildIndex();
     }
 
-    return Result;
+    QuantizationSettings = Contents.QuantizationSettings;
+    if (!RestoreQuantizer(Contents.QuantizerData, VectorChecksum))
+    {
+        RetrainQuantizer();
+    }
+
+    Contents.Categories.Empty();
+    Contents.RowCategories.Empty();
+    Contents.IndexData.Empty();
+    Contents.QuantizerData.Empty();
+
+    RebuildMetadataIndex();
+    RebuildPartitions();
 }
 
-TArray<FVectorDatabaseResult> UVectorDatabase::GetTopNStructMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+bool UVectorDatabase::RestoreIndex(const TArray<uint8>& IndexData, uint64 VectorChecksum)
 {
-    TArray<TPair<float, UVectorEntryWrapper*>> DistanceEntryPairs;
-    
-    for (int32 i = 0; i < Vectors.Num(); ++i)
-    {
-        if (Entries[i]->EntryType == EEntryType::Struct && QueryVector.Num() == Vectors[i].Num() && ShouldIncludeEntry(Entries[i], Categories))
-        {
-            float Distance = CalculateDistance(QueryVector, Vectors[i]);
-            DistanceEntryPairs.Add(TPair<float, UVectorEntryWrapper*>(Distance, Entries[i]));
-        }
-    }
+    Index.Reset();
 
-    // Sort based on distance metric
-    if (DistanceMetric == EVectorDistanceMetric::Cosine || DistanceMetric == EVectorDistanceMetric::DotProduct)
+    if (IndexSettings.IndexType == EVectorIndexType::None || IndexData.Num() == 0)
     {
-        // For similarity metrics, higher values are better
-        DistanceEntryPairs.Sort([](const TPair<float, UVectorEntryWrapper*>& A, const TPair<float, UVectorEntryWrapper*>& B) {
-            return A.Key > B.Key;
-        });
+        return false;
     }
-    else
+
+    FMemoryReader Reader(IndexData);
+    FSavedStructureHeader Header;
+    Reader << Header;
+
+    if (Reader.IsError() || !Header.Matches(MakeIndexHeader(IndexSettings.IndexType, DistanceMetric, Vectors.Num(), VectorChecksum)))
     {
-        // For distance metrics, lower values are better
-        DistanceEntryPairs.Sort([](const TPair<float, UVectorEntryWrapper*>& A, const TPair<float, UVectorEntryWrapper*>& B) {
-            return A.Key < B.Key;
-        });
+        UE_LOG(LogTemp, Log, TEXT("RestoreIndex: The saved index was built over other vectors or settings, rebuilding it"));
+        return false;
     }
 
-    TArray<FVectorDatabaseResult> Results;
-    for (int32 i = 0; i < FMath::Min(N, DistanceEntryPairs.Num()); ++i)
+    TUniquePtr<IVectorIndex> SavedIndex = MakeVectorIndex(IndexSettings);
+    SavedIndex->Serialize(Reader, Vectors);
+    if (Reader.IsError())
     {
-        FVectorDatabaseResult Result;
-        Result.Distance = DistanceEntryPairs[i].Key;
-        Result.StructType = DistanceEntryPairs[i].Value->StructType;
-        Result.StructData = DistanceEntryPairs[i].Value->StructData;
-        Result.Category = DistanceEntryPairs[i].Value->Category;
-        Result.Metadata = DistanceEntryPairs[i].Value->Metadata;
-        Results.Add(Result);
+        UE_LOG(LogTemp, Log, TEXT("RestoreIndex: The saved index does not match the index settings, rebuilding it"));
+        return false;
     }
 
-    return Results;
+    Index = MoveTemp(SavedIndex);
+    return true;
 }
 
-TArray<FVectorDatabaseEntry> UVectorDatabase::GetTopNEntriesWithDetails(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const
+bool UVectorDatabase::RestoreQuantizer(const TArray<uint8>& QuantizerData, uint64 VectorChecksum)
 {
-    TArray<TPair<float, int32>> DistanceIndexPairs;
-    
-    for (int32 i = 0; i < Vectors.Num(); ++i)
-    {
-        if (QueryVector.Num() == Vectors[i].Num() && ShouldIncludeEntry(Entries[i], Categories))
-        {
-            float Distance = CalculateDistance(QueryVector, Vectors[i]);
-            DistanceIndexPairs.Add(TPair<float, int32>(Distance, i));
-        }
-    }
+    Quantizer.Reset();
 
-    // Sort based on distance metric
-    if (DistanceMetric == EVectorDistanceMetric::Cosine || DistanceMetric == EVectorDistanceMetric::DotProduct)
+    if (QuantizationSettings.QuantizationType == EVectorQuantizationType::None || QuantizerData.Num() == 0)
     {
-        // For similarity metrics, higher values are better
-        DistanceIndexPairs.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) {
-            return A.Key > B.Key;
-        });
+        return false;
     }
-    else
+
+    FMemoryReader Reader(QuantizerData);
+    FSavedStructureHeader Header;
+    Reader << Header;
+
+    if (Reader.IsError() || !Header.Matches(MakeQuantizerHeader(QuantizationSettings.QuantizationType, DistanceMetric, Vectors.Num(), VectorChecksum)))
     {
-        // For distance metrics, lower values are better
-        DistanceIndexPairs.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) {
-            return A.Key < B.Key;
-        });
+        UE_LOG(LogTemp, Log, TEXT("RestoreQuantizer: The saved quantizer was trained over other vectors or settings, retraining it"));
+        return false;
     }
 
-    TArray<FVectorDatabaseEntry> Results;
-    for (int32 i = 0; i < FMath::Min(N, DistanceIndexPairs.Num()); ++i)
+    TUniquePtr<IVectorQuantizer> SavedQuantizer = MakeVectorQuantizer(QuantizationSettings);
+    SavedQuantizer->Serialize(Reader, Vectors);
+    if (Reader.IsError())
     {
-        FVectorDatabaseEntry Result;
-        Result.Distance = DistanceIndexPairs[i].Key;
-        Result.Vector = Vectors[DistanceIndexPairs[i].Value];
-        Result.Entry = Entries[DistanceIndexPairs[i].Value];
-        Results.Add(Result);
+        UE_LOG(LogTemp, Log, TEXT("RestoreQuantizer: The saved quantizer does not match the quantization settings, retraining it"));
+        return false;
     }
 
-    return Results;
+    Quantizer = MoveTemp(SavedQuantizer);
+    return true;
 }
 
-TArray<FVectorDatabaseEntry> UVectorDatabase::GetAllVectorEntries(const TArray<FString>& Categories) const
+void UVectorDatabase::ExportFileContents(FVectorDatabaseFileContents& OutContents) const
 {
-    TArray<FVectorDatabaseEntry> Results;
+    OutContents.DistanceMetric = DistanceMetric;
+    OutContents.IndexSettings = IndexSettings;
+    OutContents.IndexData.Reset();
+    OutContents.QuantizationSettings = QuantizationSettings;
+    OutContents.QuantizerData.Reset();
+    OutContents.Vectors = Vectors;
+    OutContents.Payloads = Payloads;
 
-    int32 NumEntries = Entries.Num();
-    for (int32 i = 0; i < NumEntries; ++i)
+    // Only categories that still name a row are written, so the file does not keep names of deleted entries
+    TArray<int32> CategoryIndices;
+    CategoryIndices.Init(INDEX_NONE, CategoryTable.Num());
+    OutContents.Categories.Reset();
+    OutContents.RowCategories.SetNumUninitialized(RowCategories.Num());
+    for (int32 Row = 0; Row < RowCategories.Num(); ++Row)
     {
-        if(Categories.Num() == 0 || Categories.Contains(Entries[i]->Category))
+        const int32 CategoryId = RowCategories[Row];
+        int32& CategoryIndex = CategoryIndices[CategoryId];
+        if (CategoryIndex == INDEX_NONE && !RemovedRows[Row] && !CategoryTable.GetName(CategoryId).IsEmpty())
         {
-            FVectorDatabaseEntry Result;
-            Result.Distance = 0.0f;
-            Result.Vector = Vectors[i];
-            Result.Entry = Entries[i];
-            Results.Add(Result);
+            CategoryIndex = OutContents.Categories.Add(CategoryTable.GetName(CategoryId));
         }
+        OutContents.RowCategories[Row] = CategoryIndex;
     }
 
-    return Results;
-}
-
-float UVectorDatabase::CalculateDistance(const TArray<float>& Vec1, const TArray<float>& Vec2) const
-{
-    if (Vec1.Num() != Vec2.Num())
-    {
-        return MAX_FLT;
-    }
-
-    switch (DistanceMetric)
+    if (NumRemovedRows > 0)
     {
-        case EVectorDistanceMetric::Euclidean:
-        {
-            float SumSquaredDiff = 0.0f;
-            for (int32 i = 0; i < Vec1.Num(); ++i)
-            {
-                float Diff = Vec1[i] - Vec2[i];
-                SumSquaredDiff += (Diff * Diff);
-            }
-            return FMath::Sqrt(SumSquaredDiff);
-        }
-        
-        case EVectorDistanceMetric::Manhattan:
+        TArray<int32> RowRemap;
+        RowRemap.SetNumUninitialized(Vectors.Num());
+        int32 NumKept = 0;
+        for (int32 Row = 0; Row < Vectors.Num(); ++Row)
         {
-            float SumAbsDiff = 0.0f;
-            for (int32 i = 0; i < Vec1.Num(); ++i)
-            {
-                SumAbsDiff += FMath::Abs(Vec1[i] - Vec2[i]);
-            }
-            return SumAbsDiff;
+            RowRemap[Row] = RemovedRows[Row] ? INDEX_NONE : NumKept++;
         }
-        
-        case EVectorDistanceMetric::Cosine:
+
+        OutContents.Vectors.Compact(RowRemap);
+        OutContents.Payloads.Compact(RowRemap);
+        CompactRowArray(OutContents.RowCategories, RowRemap);
+        OutContents.VectorChecksum = OutContents.Vectors.ComputeChecksum();
+
+        // Compact copies of the index and quantizer the way Compact would, so the saved structures cover exactly the saved rows
+        const bool bSaveIndex = Index && Index->Num() == Vectors.Num();
+        const bool bSaveQuantizer = Quantizer && Quantizer->IsTrained() && Quantizer->Num() == Vectors.Num() && CanSaveQuantizer(*Quantizer);
+        const uint64 VectorChecksum = OutContents.VectorChecksum;
+
+        TUniquePtr<IVectorIndex> CompactedIndex = bSaveIndex ? MakeVectorIndex(IndexSettings) : nullptr;
+        if (CompactedIndex && CopyStructure(*Index, *CompactedIndex, Vectors))
         {
-            float DotProduct = 0.0f;
-            float Norm1 = 0.0f;
-            float Norm2 = 0.0f;
-            
-            for (int32 i = 0; i < Vec1.Num(); ++i)
-            {
-                DotProduct += Vec1[i] * Vec2[i];
-                Norm1 += Vec1[i] * Vec1[i];
-                Norm2 += Vec2[i] * Vec2[i];
-            }
-            
-            Norm1 = FMath::Sqrt(Norm1);
-            Norm2 = FMath::Sqrt(Norm2);
-            
-            if (Norm1 == 0.0f || Norm2 == 0.0f)
-            {
-                return 0.0f;
-            }
-            
-            // Return 1 - cosine similarity to convert to a distance (0 means identical)
-            return 1.0f - (DotProduct / (Norm1 * Norm2));
+            CompactedIndex->Compact(Vectors, RowRemap);
+            const FSavedStructureHeader Header = MakeIndexHeader(IndexSettings.IndexType, DistanceMetric, OutContents.Vectors.Num(), VectorChecksum);
+            SaveStructure(*CompactedIndex, Header, OutContents.Vectors, OutContents.IndexData);
         }
-        
-        case EVectorDistanceMetric::DotProduct:
+
+        TUniquePtr<IVectorQuantizer> CompactedQuantizer = bSaveQuantizer ? MakeVectorQuantizer(QuantizationSettings) : nullptr;
+        if (CompactedQuantizer && CopyStructure(*Quantizer, *CompactedQuantizer, Vectors))
         {
-            float DotProduct = 0.0f;
-            for (int32 i = 0; i < Vec1.Num(); ++i)
-            {
-                DotProduct += Vec1[i] * Vec2[i];
-            }
-            return DotProduct;
+            CompactedQuantizer->Compact(RowRemap);
+            const FSavedStructureHeader Header = MakeQuantizerHeader(QuantizationSettings.QuantizationType, DistanceMetric, OutContents.Vectors.Num(), VectorChecksum);
+            SaveStructure(*CompactedQuantizer, Header, OutContents.Vectors, OutContents.QuantizerData);
         }
-        
-        default:
-            return MAX_FLT;
+    }
+    else
+    {
+        OutContents.VectorChecksum = OutContents.Vectors.ComputeChecksum();
+        SaveSearchStructures(OutContents.VectorChecksum, OutContents.IndexData, OutContents.QuantizerData);
     }
 }
 
-bool UVectorDatabase::ShouldIncludeEntry(const UVectorEntryWrapper* Entry, const TArray<FString>& Categories) const
+bool UVectorDatabase::SaveSearchStructures(uint64 VectorChecksum, TArray<uint8>& OutIndexData, TArray<uint8>& OutQuantizerData) const
 {
-    return Categories.Num() == 0 || Categories.Contains(Entry->Category);
-}
+    OutIndexData.Reset();
+    OutQuantizerData.Reset();
 
-int32 UVectorDatabase::GetNumberOfEntries() const
-{
-    return Entries.Num();
+    if (NumRemovedRows > 0)
+    {
+        return false;
+    }
+
+    // Structures still catching up with the rows, such as a quantizer waiting for enough rows to train, are built again on load
+    const bool bSaveIndex = Index && Index->Num() == Vectors.Num();
+    const bool bSaveQuantizer = Quantizer && Quantizer->IsTrained() && Quantizer->Num() == Vectors.Num() && CanSaveQuantizer(*Quantizer);
+
+    if (bSaveIndex)
+    {
+        SaveStructure(*Index, MakeIndexHeader(IndexSettings.IndexType, DistanceMetric, Vectors.Num(), VectorChecksum), Vectors, OutIndexData);
+    }
+    if (bSaveQuantizer)
+    {
+        SaveStructure(*Quantizer, MakeQuantizerHeader(QuantizationSettings.QuantizationType, DistanceMetric, Vectors.Num(), VectorChecksum), Vectors, OutQuantizerData);
+    }
+    return true;
 }
 
-int32 UVectorDatabase::GetNumberOfStringEntries() const
+bool UVectorDatabase::IsEmpty() const
 {
-    return Entries.FilterByPredicate([](const UVectorEntryWrapper* Entry) {
-        return Entry->EntryType == EEntryType::String;
-    }).Num();
+    return GetNumberOfEntries() == 0;
 }
 
-int32 UVectorDatabase::GetNumberOfObjectEntries() const
+int32 UVectorDatabase::GetVectorDimension() const
 {
-    return Entries.FilterByPredicate([](const UVectorEntryWrapper* Entry) {
-        return Entry->EntryType == EEntryType::Object;
-    }).Num();
+    return Vectors.GetDimension();
 }
 
-int32 UVectorDatabase::GetNumberOfStructEntries() const
+bool UVectorDatabase::HasConsistentVectorDimension() const
 {
-    return Entries.FilterByPredicate([](const UVectorEntryWrapper* Entry) {
-        return Entry->EntryType == EEntryType::Struct;
-    }).Num();
+    // The flat storage enforces a single dimension for every row
+    return true;
 }
 
-bool UVectorDatabase::RemoveEntry(const TArray<float>& Vector, bool bRemoveAllOccurrences, float RemovalRange)
+void UVectorDatabase::NormalizeVectors()
 {
-    bool bEntryRemoved = false;
-
-    // Validate the input vector
-    if (Vector.Num() == 0)
+    if (Vectors.AreRowsNormalized())
     {
-        UE_LOG(LogTemp, Warning, TEXT("RemoveEntry called with an empty vector."));
-        return false;
-    }
-
-    //clamp removalrange to above 0
-    if(RemovalRange < 0.0f){
-        RemovalRange = 0.0f;
+        // Nothing would change, so the index and quantizer stay as they are
+        return;
     }
 
-    // Loop through the Vectors array in reverse to avoid index shifting issues
-    for (int32 i = Vectors.Num() - 1; i >= 0; --i)
+    const int32 Dimension = Vectors.GetDimension();
+    TArray<float> Row;
+    Row.SetNumUninitialized(Dimension);
+    for (int32 i = 0; i < Vectors.Num(); ++i)
     {
-        // Check if the current vector should be removed based on the distance or exact match
-        if ((RemovalRange > 0.0f && CalculateDistance(Vectors[i], Vector) <= RemovalRange) || Vectors[i] == Vector)
+        const float Norm = Vectors.GetRowNorm(i);
+        if (Norm > 0.0f)
         {
-            // Remove the entry and vector
-            if (Entries[i] && Entries[i]->IsValidLowLevel())
-            {
-                Entries[i]->ConditionalBeginDestroy();
-            }
-            Entries.RemoveAt(i);
-            Vectors.RemoveAt(i);
-            bEntryRemoved = true;
-
-            // If we're not removing all occurrences, break after the first match
-            if (!bRemoveAllOccurrences)
+            Vectors.DecodeRow(i, Row.GetData());
+            for (int32 j = 0; j < Dimension; ++j)
             {
-                break;
+                Row[j] /= Norm;
             }
+            Vectors.SetRow(i, Row);
         }
     }
 
-    return bEntryRemoved;
+    if (Index)
+    {
+        RebuildIndex();
+    }
+    if (Quantizer)
+    {
+        RetrainQuantizer();
+    }
 }
 
-FVectorDatabaseStats UVectorDatabase::GetDatabaseStats() const
+bool UVectorDatabase::AreVectorsNormalized() const
 {
-    FVectorDatabaseStats Stats;
-    Stats.TotalEntries = Entries.Num();
-    Stats.StringEntries = GetNumberOfStringEntries();
-    Stats.ObjectEntries = GetNumberOfObjectEntries();
-    Stats.StructEntries = GetNumberOfStructEntries();
-    Stats.VectorDimension = GetVectorDimension();
-    
-    // Collect categories and counts
-    TMap<FString, int32> CategoryCountMap;
-    for (const UVectorEntryWrapper* Entry : Entries)
-    {
-        if (!Entry->Category.IsEmpty())
-        {
-            if (!CategoryCountMap.Contains(Entry->Category))
-            {
-                CategoryCountMap.Add(Entry->Category, 0);
-                Stats.Categories.Add(Entry->Category);
-            }
-            CategoryCountMap[Entry->Category]++;
-        }
-    }
-    
-    Stats.CategoryCounts = CategoryCountMap;
-    
-    return Stats;
+    // The storage tracks row norms as rows are written, so this never goes stale
+    return Vectors.AreRowsNormalized();
 }
 
-TArray<FString> UVectorDatabase::GetUniqueCategories() const
+void UVectorDatabase::SetStoragePrecision(EVectorStoragePrecision InPrecision)
 {
-    TSet<FString> UniqueCategories;
-    for (const UVectorEntryWrapper* Entry : Entries)
+    if (Vectors.GetPrecision() == InPrecision)
     {
-        if (!Entry->Category.IsEmpty())
-        {
-            UniqueCategories.Add(Entry->Category);
-        }
+        return;
     }
-    
-    TArray<FString> Result;
-    for (const FString& Category : UniqueCategories)
+
+    Vectors.SetPrecision(InPrecision);
+
+    // Converted values differ slightly, so derived structures are rebuilt from them
+    if (Index)
     {
-        Result.Add(Category);
+        RebuildIndex();
     }
-    
-    return Result;
-}
-
-int32 UVectorDatabase::GetEntryCountForCategory(const FString& Category) const
-{
-    int32 Count = 0;
-    for (const UVectorEntryWrapper* Entry : Entries)
+    if (Quantizer)
     {
-        if (Entry->Category == Category)
-        {
-            Count++;
-        }
+        RetrainQuantizer();
     }
-    return Count;
 }
 
-TArray<FVectorDatabaseEntry> UVectorDatabase::GetEntriesForCategory(const FString& Category) const
+EVectorStoragePrecision UVectorDatabase::GetStoragePrecision() const
 {
-    TArray<FVectorDatabaseEntry> Result;
-    
-    for (int32 i = 0; i < Entries.Num(); ++i)
-    {
-        if (Entries[i]->Category == Category)
-        {
-            FVectorDatabaseEntry Entry;
-            Entry.Distance = 0.0f;
-            Entry.Vector = Vectors[i];
-            Entry.Entry = Entries[i];
-            Result.Add(Entry);
-        }
-    }
-    
-    return Result;
+    return Vectors.GetPrecision();
 }
 
-void UVectorDatabase::SetDistanceMetric(EVectorDistanceMetric InMetric)
+void UVectorDatabase::SetIndexSettings(const FVectorIndexSettings& InSettings)
 {
-    DistanceMetric = InMetric;
+    IndexSettings = InSettings;
+    RebuildIndex();
 }
 
-EVectorDistanceMetric UVectorDatabase::GetDistanceMetric() const
+const FVectorIndexSettings& UVectorDatabase::GetIndexSettings() const
 {
-    return DistanceMetric;
+    return IndexSettings;
 }
 
-void UVectorDatabase::ClearDatabase()
+void UVectorDatabase::RebuildIndex()
 {
-    for (UVectorEntryWrapper* Entry : Entries)
+    Index = MakeVectorIndex(IndexSettings);
+    if (Index)
     {
-        if (Entry && Entry->IsValidLowLevel())
-        {
-            Entry->ConditionalBeginDestroy();
-        }
+        Index->Build(Vectors, DistanceMetric);
     }
-    Entries.Empty();
-    Vectors.Empty();
 }
 
-bool UVectorDatabase::IsEmpty() const
+bool UVectorDatabase::HasIndex() const
 {
-    return Entries.Num() == 0;
+    return Index.IsValid();
 }
 
-int32 UVectorDatabase::GetVectorDimension() const
+void UVectorDatabase::SetQuantizationSettings(const FVectorQuantizationSettings& InSettings)
 {
-    if (Vectors.Num() == 0)
-    {
-        return 0;
-    }
-    
-    return Vectors[0].Num();
+    QuantizationSettings = InSettings;
+    RetrainQuantizer();
 }
 
-bool UVectorDatabase::HasConsistentVectorDimension() const
+const FVectorQuantizationSettings& UVectorDatabase::GetQuantizationSettings() const
 {
-    if (Vectors.Num() <= 1)
-    {
-        return true;
-    }
-    
-    int32 Dimension = Vectors[0].Num();
-    for (int32 i = 1; i < Vectors.Num(); ++i)
-    {
-        if (Vectors[i].Num() != Dimension)
-        {
-            return false;
-        }
-    }
-    
-    return true;
+    return QuantizationSettings;
 }
 
-void UVectorDatabase::NormalizeVectors()
+void UVectorDatabase::RetrainQuantizer()
 {
-    for (int32 i = 0; i < Vectors.Num(); ++i)
+    Quantizer = MakeVectorQuantizer(QuantizationSettings);
+    if (Quantizer)
     {
-        float Norm = 0.0f;
-        for (int32 j = 0; j < Vectors[i].Num(); ++j)
-        {
-            Norm += Vectors[i][j] * Vectors[i][j];
-        }
-        
-        Norm = FMath::Sqrt(Norm);
-        
-        if (Norm > 0.0f)
-        {
-            for (int32 j = 0; j < Vectors[i].Num(); ++j)
-            {
-                Vectors[i][j] /= Norm;
-            }
-        }
+        Quantizer->Train(Vectors, DistanceMetric);
     }
 }
 
+bool UVectorDatabase::HasQuantizer() const
+{
+    return Quantizer.IsValid() && Quantizer->IsTrained();
+}
+
+bool UVectorDatabase::MoveVectorsToFile(const FString& FilePath)
+{
+    return VectorDatabaseFile::MoveRowsToFile(FilePath, Vectors);
+}
+
+bool UVectorDatabase::AreVectorsInFile() const
+{
+    return Vectors.HasExternalRows();
+}
+
 void UVectorDatabase::UpdateVectorDimension()
 {
     // This function can be used to validate and update vector dimensions
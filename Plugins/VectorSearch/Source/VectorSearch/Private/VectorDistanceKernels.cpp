@@ -0,0 +1,695 @@
+#include "VectorDistanceKernels.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define VECTORSEARCH_AVX2_TARGET
+    #else
+        #include <cpuid.h>
+        #define VECTORSEARCH_AVX2_TARGET __attribute__((target("avx2,fma,f16c")))
+    #endif
+    #define VECTORSEARCH_X86_KERNELS 1
+#else
+    #define VECTORSEARCH_X86_KERNELS 0
+#endif
+
+namespace
+{
+    // ---------------------------------------------------------------------
+    // Element conversion and shared helpers
+    // ---------------------------------------------------------------------
+
+    FORCEINLINE float ToFloat(float Value)
+    {
+        return Value;
+    }
+
+    FORCEINLINE float ToFloat(const FFloat16& Value)
+    {
+        return Value.GetFloat();
+    }
+
+    FORCEINLINE float ToFloat(const FVectorBFloat16& Value)
+    {
+        const uint32 Bits = static_cast<uint32>(Value.Encoded) << 16;
+        float Result;
+        FMemory::Memcpy(&Result, &Bits, sizeof(Result));
+        return Result;
+    }
+
+    FORCEINLINE float CosineFromParts(float Dot, float NormA, float NormB)
+    {
+        if (NormA == 0.0f || NormB == 0.0f)
+        {
+            return 0.0f;
+        }
+        return Dot / FMath::Sqrt(NormA * NormB);
+    }
+
+    // ---------------------------------------------------------------------
+    // Scalar kernels
+    // ---------------------------------------------------------------------
+
+    struct FScalarOps
+    {
+        template<typename RowType>
+        static FORCEINLINE float SquaredL2(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                const float Diff = A[i] - ToFloat(B[i]);
+                Sum += Diff * Diff;
+            }
+            return Sum;
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float L1(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Sum += FMath::Abs(A[i] - ToFloat(B[i]));
+            }
+            return Sum;
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float Dot(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Sum += A[i] * ToFloat(B[i]);
+            }
+            return Sum;
+        }
+
+        template<typename RowType>
+        static FORCEINLINE void DotAndNorms(const float* A, const RowType* B, int32 Dimension, float& OutDot, float& OutNormA, float& OutNormB)
+        {
+            float Dot = 0.0f;
+            float NormA = 0.0f;
+            float NormB = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                const float ValueB = ToFloat(B[i]);
+                Dot += A[i] * ValueB;
+                NormA += A[i] * A[i];
+                NormB += ValueB * ValueB;
+            }
+            OutDot = Dot;
+            OutNormA = NormA;
+            OutNormB = NormB;
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float Cosine(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Dot, NormA, NormB;
+            DotAndNorms(A, B, Dimension, Dot, NormA, NormB);
+            return CosineFromParts(Dot, NormA, NormB);
+        }
+
+        static FORCEINLINE float CodeDot(const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Sum += Weights[i] * Codes[i];
+            }
+            return Sum;
+        }
+
+        static FORCEINLINE float CodeSquaredL2(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                const float Diff = Offsets[i] - Codes[i];
+                Sum += Weights[i] * Diff * Diff;
+            }
+            return Sum;
+        }
+
+        static FORCEINLINE float CodeL1(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Sum += Weights[i] * FMath::Abs(Offsets[i] - Codes[i]);
+            }
+            return Sum;
+        }
+    };
+
+#if VECTORSEARCH_X86_KERNELS
+
+    // ---------------------------------------------------------------------
+    // SSE2 kernels (baseline on every x86-64 target)
+    // ---------------------------------------------------------------------
+
+    FORCEINLINE float HorizontalSum(__m128 V)
+    {
+        __m128 Shuffled = _mm_shuffle_ps(V, V, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 Sums = _mm_add_ps(V, Shuffled);
+        Shuffled = _mm_movehl_ps(Shuffled, Sums);
+        Sums = _mm_add_ss(Sums, Shuffled);
+        return _mm_cvtss_f32(Sums);
+    }
+
+    struct FSSE2Ops
+    {
+        static FORCEINLINE __m128 LoadRow(const float* B)
+        {
+            return _mm_loadu_ps(B);
+        }
+
+        static FORCEINLINE __m128 LoadRow(const FFloat16* B)
+        {
+            // SSE2 has no half conversion instruction
+            return _mm_setr_ps(B[0].GetFloat(), B[1].GetFloat(), B[2].GetFloat(), B[3].GetFloat());
+        }
+
+        static FORCEINLINE __m128 LoadRow(const FVectorBFloat16* B)
+        {
+            // bfloat16 is the upper half of a float: interleave zeros below each element
+            const __m128i Packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(B));
+            return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), Packed));
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float SquaredL2(const float* A, const RowType* B, int32 Dimension)
+        {
+            __m128 Acc0 = _mm_setzero_ps();
+            __m128 Acc1 = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 8 <= Dimension; i += 8)
+            {
+                const __m128 D0 = _mm_sub_ps(_mm_loadu_ps(A + i), LoadRow(B + i));
+                const __m128 D1 = _mm_sub_ps(_mm_loadu_ps(A + i + 4), LoadRow(B + i + 4));
+                Acc0 = _mm_add_ps(Acc0, _mm_mul_ps(D0, D0));
+                Acc1 = _mm_add_ps(Acc1, _mm_mul_ps(D1, D1));
+            }
+            float Sum = HorizontalSum(_mm_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::SquaredL2(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float L1(const float* A, const RowType* B, int32 Dimension)
+        {
+            const __m128 SignMask = _mm_set1_ps(-0.0f);
+            __m128 Acc0 = _mm_setzero_ps();
+            __m128 Acc1 = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 8 <= Dimension; i += 8)
+            {
+                const __m128 D0 = _mm_sub_ps(_mm_loadu_ps(A + i), LoadRow(B + i));
+                const __m128 D1 = _mm_sub_ps(_mm_loadu_ps(A + i + 4), LoadRow(B + i + 4));
+                Acc0 = _mm_add_ps(Acc0, _mm_andnot_ps(SignMask, D0));
+                Acc1 = _mm_add_ps(Acc1, _mm_andnot_ps(SignMask, D1));
+            }
+            float Sum = HorizontalSum(_mm_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::L1(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float Dot(const float* A, const RowType* B, int32 Dimension)
+        {
+            __m128 Acc0 = _mm_setzero_ps();
+            __m128 Acc1 = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 8 <= Dimension; i += 8)
+            {
+                Acc0 = _mm_add_ps(Acc0, _mm_mul_ps(_mm_loadu_ps(A + i), LoadRow(B + i)));
+                Acc1 = _mm_add_ps(Acc1, _mm_mul_ps(_mm_loadu_ps(A + i + 4), LoadRow(B + i + 4)));
+            }
+            float Sum = HorizontalSum(_mm_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::Dot(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static FORCEINLINE void DotAndNorms(const float* A, const RowType* B, int32 Dimension, float& OutDot, float& OutNormA, float& OutNormB)
+        {
+            __m128 DotAcc = _mm_setzero_ps();
+            __m128 NormAAcc = _mm_setzero_ps();
+            __m128 NormBAcc = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 4 <= Dimension; i += 4)
+            {
+                const __m128 VA = _mm_loadu_ps(A + i);
+                const __m128 VB = LoadRow(B + i);
+                DotAcc = _mm_add_ps(DotAcc, _mm_mul_ps(VA, VB));
+                NormAAcc = _mm_add_ps(NormAAcc, _mm_mul_ps(VA, VA));
+                NormBAcc = _mm_add_ps(NormBAcc, _mm_mul_ps(VB, VB));
+            }
+            float TailDot, TailNormA, TailNormB;
+            FScalarOps::DotAndNorms(A + i, B + i, Dimension - i, TailDot, TailNormA, TailNormB);
+            OutDot = HorizontalSum(DotAcc) + TailDot;
+            OutNormA = HorizontalSum(NormAAcc) + TailNormA;
+            OutNormB = HorizontalSum(NormBAcc) + TailNormB;
+        }
+
+        template<typename RowType>
+        static FORCEINLINE float Cosine(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Dot, NormA, NormB;
+            DotAndNorms(A, B, Dimension, Dot, NormA, NormB);
+            return CosineFromParts(Dot, NormA, NormB);
+        }
+
+        /** Widen 4 unsigned bytes to floats */
+        static FORCEINLINE __m128 LoadCodes(const uint8* Codes)
+        {
+            int32 Packed;
+            FMemory::Memcpy(&Packed, Codes, sizeof(Packed));
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i Words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(Packed), Zero);
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(Words, Zero));
+        }
+
+        static FORCEINLINE float CodeDot(const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            __m128 Acc = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 4 <= Dimension; i += 4)
+            {
+                Acc = _mm_add_ps(Acc, _mm_mul_ps(_mm_loadu_ps(Weights + i), LoadCodes(Codes + i)));
+            }
+            return HorizontalSum(Acc) + FScalarOps::CodeDot(Weights + i, Codes + i, Dimension - i);
+        }
+
+        static FORCEINLINE float CodeSquaredL2(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            __m128 Acc = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 4 <= Dimension; i += 4)
+            {
+                const __m128 Diff = _mm_sub_ps(_mm_loadu_ps(Offsets + i), LoadCodes(Codes + i));
+                Acc = _mm_add_ps(Acc, _mm_mul_ps(_mm_loadu_ps(Weights + i), _mm_mul_ps(Diff, Diff)));
+            }
+            return HorizontalSum(Acc) + FScalarOps::CodeSquaredL2(Offsets + i, Weights + i, Codes + i, Dimension - i);
+        }
+
+        static FORCEINLINE float CodeL1(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            const __m128 SignMask = _mm_set1_ps(-0.0f);
+            __m128 Acc = _mm_setzero_ps();
+            int32 i = 0;
+            for (; i + 4 <= Dimension; i += 4)
+            {
+                const __m128 Diff = _mm_sub_ps(_mm_loadu_ps(Offsets + i), LoadCodes(Codes + i));
+                Acc = _mm_add_ps(Acc, _mm_mul_ps(_mm_loadu_ps(Weights + i), _mm_andnot_ps(SignMask, Diff)));
+            }
+            return HorizontalSum(Acc) + FScalarOps::CodeL1(Offsets + i, Weights + i, Codes + i, Dimension - i);
+        }
+    };
+
+    // ---------------------------------------------------------------------
+    // AVX2 + FMA kernels, selected at runtime
+    // ---------------------------------------------------------------------
+
+    VECTORSEARCH_AVX2_TARGET FORCEINLINE float HorizontalSum256(__m256 V)
+    {
+        const __m128 Low = _mm256_castps256_ps128(V);
+        const __m128 High = _mm256_extractf128_ps(V, 1);
+        return HorizontalSum(_mm_add_ps(Low, High));
+    }
+
+    struct FAVX2Ops
+    {
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE __m256 LoadRow(const float* B)
+        {
+            return _mm256_loadu_ps(B);
+        }
+
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE __m256 LoadRow(const FFloat16* B)
+        {
+            return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(B)));
+        }
+
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE __m256 LoadRow(const FVectorBFloat16* B)
+        {
+            const __m256i Widened = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(B)));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(Widened, 16));
+        }
+
+        template<typename RowType>
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float SquaredL2(const float* A, const RowType* B, int32 Dimension)
+        {
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                const __m256 D0 = _mm256_sub_ps(_mm256_loadu_ps(A + i), LoadRow(B + i));
+                const __m256 D1 = _mm256_sub_ps(_mm256_loadu_ps(A + i + 8), LoadRow(B + i + 8));
+                Acc0 = _mm256_fmadd_ps(D0, D0, Acc0);
+                Acc1 = _mm256_fmadd_ps(D1, D1, Acc1);
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::SquaredL2(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float L1(const float* A, const RowType* B, int32 Dimension)
+        {
+            const __m256 SignMask = _mm256_set1_ps(-0.0f);
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                const __m256 D0 = _mm256_sub_ps(_mm256_loadu_ps(A + i), LoadRow(B + i));
+                const __m256 D1 = _mm256_sub_ps(_mm256_loadu_ps(A + i + 8), LoadRow(B + i + 8));
+                Acc0 = _mm256_add_ps(Acc0, _mm256_andnot_ps(SignMask, D0));
+                Acc1 = _mm256_add_ps(Acc1, _mm256_andnot_ps(SignMask, D1));
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::L1(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float Dot(const float* A, const RowType* B, int32 Dimension)
+        {
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                Acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(A + i), LoadRow(B + i), Acc0);
+                Acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(A + i + 8), LoadRow(B + i + 8), Acc1);
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::Dot(A + i, B + i, Dimension - i);
+        }
+
+        template<typename RowType>
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE void DotAndNorms(const float* A, const RowType* B, int32 Dimension, float& OutDot, float& OutNormA, float& OutNormB)
+        {
+            __m256 DotAcc = _mm256_setzero_ps();
+            __m256 NormAAcc = _mm256_setzero_ps();
+            __m256 NormBAcc = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 8 <= Dimension; i += 8)
+            {
+                const __m256 VA = _mm256_loadu_ps(A + i);
+                const __m256 VB = LoadRow(B + i);
+                DotAcc = _mm256_fmadd_ps(VA, VB, DotAcc);
+                NormAAcc = _mm256_fmadd_ps(VA, VA, NormAAcc);
+                NormBAcc = _mm256_fmadd_ps(VB, VB, NormBAcc);
+            }
+            float TailDot, TailNormA, TailNormB;
+            FScalarOps::DotAndNorms(A + i, B + i, Dimension - i, TailDot, TailNormA, TailNormB);
+            OutDot = HorizontalSum256(DotAcc) + TailDot;
+            OutNormA = HorizontalSum256(NormAAcc) + TailNormA;
+            OutNormB = HorizontalSum256(NormBAcc) + TailNormB;
+        }
+
+        template<typename RowType>
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float Cosine(const float* A, const RowType* B, int32 Dimension)
+        {
+            float Dot, NormA, NormB;
+            DotAndNorms(A, B, Dimension, Dot, NormA, NormB);
+            return CosineFromParts(Dot, NormA, NormB);
+        }
+
+        /** Widen 8 unsigned bytes to floats */
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE __m256 LoadCodes(const uint8* Codes)
+        {
+            return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Codes))));
+        }
+
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float CodeDot(const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                Acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(Weights + i), LoadCodes(Codes + i), Acc0);
+                Acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(Weights + i + 8), LoadCodes(Codes + i + 8), Acc1);
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::CodeDot(Weights + i, Codes + i, Dimension - i);
+        }
+
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float CodeSquaredL2(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                const __m256 D0 = _mm256_sub_ps(_mm256_loadu_ps(Offsets + i), LoadCodes(Codes + i));
+                const __m256 D1 = _mm256_sub_ps(_mm256_loadu_ps(Offsets + i + 8), LoadCodes(Codes + i + 8));
+                Acc0 = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_loadu_ps(Weights + i), D0), D0, Acc0);
+                Acc1 = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_loadu_ps(Weights + i + 8), D1), D1, Acc1);
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::CodeSquaredL2(Offsets + i, Weights + i, Codes + i, Dimension - i);
+        }
+
+        static VECTORSEARCH_AVX2_TARGET FORCEINLINE float CodeL1(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension)
+        {
+            const __m256 SignMask = _mm256_set1_ps(-0.0f);
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            int32 i = 0;
+            for (; i + 16 <= Dimension; i += 16)
+            {
+                const __m256 D0 = _mm256_sub_ps(_mm256_loadu_ps(Offsets + i), LoadCodes(Codes + i));
+                const __m256 D1 = _mm256_sub_ps(_mm256_loadu_ps(Offsets + i + 8), LoadCodes(Codes + i + 8));
+                Acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(Weights + i), _mm256_andnot_ps(SignMask, D0), Acc0);
+                Acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(Weights + i + 8), _mm256_andnot_ps(SignMask, D1), Acc1);
+            }
+            float Sum = HorizontalSum256(_mm256_add_ps(Acc0, Acc1));
+            return Sum + FScalarOps::CodeL1(Offsets + i, Weights + i, Codes + i, Dimension - i);
+        }
+    };
+
+    bool CpuSupportsAVX2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int32 Info[4];
+        __cpuid(Info, 0);
+        if (Info[0] < 7)
+        {
+            return false;
+        }
+
+        __cpuid(Info, 1);
+        const bool bOSXSave = (Info[2] & (1 << 27)) != 0;
+        const bool bAVX = (Info[2] & (1 << 28)) != 0;
+        const bool bFMA = (Info[2] & (1 << 12)) != 0;
+        const bool bF16C = (Info[2] & (1 << 29)) != 0;
+        if (!bOSXSave || !bAVX || !bFMA || !bF16C)
+        {
+            return false;
+        }
+
+        // The OS must save the YMM registers on context switches
+        if ((_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+
+        __cpuidex(Info, 7, 0);
+        return (Info[1] & (1 << 5)) != 0;
+#else
+        // F16C widens half-precision rows; every AVX2 CPU has it but it is reported separately
+        uint32 Eax, Ebx, Ecx, Edx;
+        if (!__get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) || (Ecx & bit_F16C) == 0)
+        {
+            return false;
+        }
+
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+#endif // VECTORSEARCH_X86_KERNELS
+
+    // ---------------------------------------------------------------------
+    // Metric wrappers, instantiated once per instruction set
+    // ---------------------------------------------------------------------
+
+    #define VECTORSEARCH_DEFINE_BATCH(Name, RowType, Target, ScoreExpr) \
+        Target void Name(const float* Query, const RowType* Rows, int32 NumRows, int32 Stride, int32 Dimension, float* OutScores) \
+        { \
+            const float* A = Query; \
+            for (int32 Row = 0; Row < NumRows; ++Row) \
+            { \
+                const RowType* B = Rows + static_cast<SIZE_T>(Row) * Stride; \
+                OutScores[Row] = ScoreExpr; \
+            } \
+        }
+
+    #define VECTORSEARCH_DEFINE_METRIC(Isa, Ops, Metric, Target, ScoreExpr) \
+        Target float Isa##Metric##Single(const float* A, const float* B, int32 Dimension) \
+        { \
+            return ScoreExpr; \
+        } \
+        VECTORSEARCH_DEFINE_BATCH(Isa##Metric##Batch, float, Target, ScoreExpr) \
+        VECTORSEARCH_DEFINE_BATCH(Isa##Metric##BatchHalf, FFloat16, Target, ScoreExpr) \
+        VECTORSEARCH_DEFINE_BATCH(Isa##Metric##BatchBFloat16, FVectorBFloat16, Target, ScoreExpr)
+
+    #define VECTORSEARCH_DEFINE_KERNELS(Isa, Ops, Target) \
+        VECTORSEARCH_DEFINE_METRIC(Isa, Ops, Euclidean, Target, FMath::Sqrt(Ops::SquaredL2(A, B, Dimension))) \
+        VECTORSEARCH_DEFINE_METRIC(Isa, Ops, Cosine, Target, Ops::Cosine(A, B, Dimension)) \
+        VECTORSEARCH_DEFINE_METRIC(Isa, Ops, Manhattan, Target, Ops::L1(A, B, Dimension)) \
+        VECTORSEARCH_DEFINE_METRIC(Isa, Ops, DotProduct, Target, Ops::Dot(A, B, Dimension)) \
+        Target float Isa##CodeDot(const float* Weights, const uint8* Codes, int32 Dimension) \
+        { \
+            return Ops::CodeDot(Weights, Codes, Dimension); \
+        } \
+        Target float Isa##CodeSquaredL2(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension) \
+        { \
+            return Ops::CodeSquaredL2(Offsets, Weights, Codes, Dimension); \
+        } \
+        Target float Isa##CodeL1(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension) \
+        { \
+            return Ops::CodeL1(Offsets, Weights, Codes, Dimension); \
+        }
+
+#if VECTORSEARCH_X86_KERNELS
+    VECTORSEARCH_DEFINE_KERNELS(SSE2, FSSE2Ops, )
+    VECTORSEARCH_DEFINE_KERNELS(AVX2, FAVX2Ops, VECTORSEARCH_AVX2_TARGET)
+#else
+    VECTORSEARCH_DEFINE_KERNELS(Scalar, FScalarOps, )
+#endif
+
+    #undef VECTORSEARCH_DEFINE_KERNELS
+    #undef VECTORSEARCH_DEFINE_METRIC
+    #undef VECTORSEARCH_DEFINE_BATCH
+
+    /** Kernel table indexed by EVectorDistanceMetric */
+    struct FKernelTable
+    {
+        FVectorDistanceKernel Kernels[4];
+        FVectorCodeKernel CodeKernel;
+        const TCHAR* InstructionSetName;
+    };
+
+    #define VECTORSEARCH_KERNEL_TABLE(Isa) \
+        { \
+            { \
+                { &Isa##EuclideanSingle, &Isa##EuclideanBatch, &Isa##EuclideanBatchHalf, &Isa##EuclideanBatchBFloat16 }, \
+                { &Isa##CosineSingle, &Isa##CosineBatch, &Isa##CosineBatchHalf, &Isa##CosineBatchBFloat16 }, \
+                { &Isa##ManhattanSingle, &Isa##ManhattanBatch, &Isa##ManhattanBatchHalf, &Isa##ManhattanBatchBFloat16 }, \
+                { &Isa##DotProductSingle, &Isa##DotProductBatch, &Isa##DotProductBatchHalf, &Isa##DotProductBatchBFloat16 } \
+            }, \
+            { &Isa##CodeDot, &Isa##CodeSquaredL2, &Isa##CodeL1 }, \
+            TEXT(#Isa) \
+        }
+
+    const FKernelTable& ResolveKernelTable()
+    {
+#if VECTORSEARCH_X86_KERNELS
+        static const FKernelTable SSE2Table = VECTORSEARCH_KERNEL_TABLE(SSE2);
+        static const FKernelTable AVX2Table = VECTORSEARCH_KERNEL_TABLE(AVX2);
+
+        static const FKernelTable& Resolved = CpuSupportsAVX2() ? AVX2Table : SSE2Table;
+        return Resolved;
+#else
+        static const FKernelTable ScalarTable = VECTORSEARCH_KERNEL_TABLE(Scalar);
+        return ScalarTable;
+#endif
+    }
+
+    #undef VECTORSEARCH_KERNEL_TABLE
+}
+
+namespace VectorDistance
+{
+    const FVectorDistanceKernel& GetKernel(EVectorDistanceMetric Metric)
+    {
+        static_assert(static_cast<int32>(EVectorDistanceMetric::Euclidean) == 0
+            && static_cast<int32>(EVectorDistanceMetric::Cosine) == 1
+            && static_cast<int32>(EVectorDistanceMetric::Manhattan) == 2
+            && static_cast<int32>(EVectorDistanceMetric::DotProduct) == 3,
+            "Kernel table order must match EVectorDistanceMetric");
+
+        const int32 Index = FMath::Clamp(static_cast<int32>(Metric), 0, 3);
+        return ResolveKernelTable().Kernels[Index];
+    }
+
+    const FVectorCodeKernel& GetCodeKernel()
+    {
+        return ResolveKernelTable().CodeKernel;
+    }
+
+    const TCHAR* GetActiveInstructionSetName()
+    {
+        return ResolveKernelTable().InstructionSetName;
+    }
+}
+
+FVectorRowScorer::FVectorRowScorer(EVectorDistanceMetric Metric)
+    : Kernel(&VectorDistance::GetKernel(Metric == EVectorDistanceMetric::Cosine ? EVectorDistanceMetric::DotProduct : Metric)),
+      bCosine(Metric == EVectorDistanceMetric::Cosine)
+{
+}
+
+const float* FVectorRowScorer::PrepareQuery(const float* Query, int32 Dimension, TArray<float>& Scratch) const
+{
+    if (!bCosine)
+    {
+        return Query;
+    }
+
+    float SquaredNorm = 0.0f;
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        SquaredNorm += Query[d] * Query[d];
+    }
+
+    // A zero query scores 0 against every row, as the cosine kernel does
+    const float InvNorm = SquaredNorm > 0.0f ? 1.0f / FMath::Sqrt(SquaredNorm) : 0.0f;
+
+    Scratch.SetNumUninitialized(Dimension, false);
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        Scratch[d] = Query[d] * InvNorm;
+    }
+    return Scratch.GetData();
+}
+
+const float* FVectorRowScorer::PrepareRowQuery(const FVectorStorage& Storage, int32 Row, TArray<float>& Scratch) const
+{
+    if (!bCosine)
+    {
+        return Storage.GetRowAsFloat(Row, Scratch);
+    }
+
+    // The cached norm saves summing the row again
+    const int32 Dimension = Storage.GetDimension();
+    const float Norm = Storage.GetRowNorm(Row);
+    const float InvNorm = Norm > 0.0f ? 1.0f / Norm : 0.0f;
+
+    Scratch.SetNumUninitialized(Dimension, false);
+    Storage.DecodeRow(Row, Scratch.GetData());
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        Scratch[d] *= InvNorm;
+    }
+    return Scratch.GetData();
+}
+
+void FVectorRowScorer::ScoreRows(const FVectorStorage& Storage, const float* PreparedQuery, int32 FirstRow, int32 NumRows, float* OutScores) const
+{
+    VectorDistance::ScoreRows(*Kernel, PreparedQuery, Storage, FirstRow, NumRows, OutScores);
+    if (!bCosine || Storage.AreRowsNormalized())
+    {
+        return;
+    }
+
+    for (int32 i = 0; i < NumRows; ++i)
+    {
+        const float Norm = Storage.GetRowNorm(FirstRow + i);
+        OutScores[i] = Norm > 0.0f ? OutScores[i] / Norm : 0.0f;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorDatabaseTypes.h"
+
+/**
+ * Distance kernels for one metric, specialised for the instruction set of the running CPU.
+ * Resolve the kernel once per query and call it for every row instead of switching on the metric per candidate.
+ */
+struct FVectorDistanceKernel
+{
+    /** Score a single pair of vectors */
+    float (*Single)(const float* A, const float* B, int32 Dimension);
+
+    /** Score a query against NumRows rows that start Stride floats apart */
+    void (*Batch)(const float* Query, const float* Rows, int32 NumRows, int32 Stride, int32 Dimension, float* OutScores);
+
+    /** Score a query against NumRows fp16 rows that start Stride elements apart, accumulating in float */
+    void (*BatchHalf)(const float* Query, const FFloat16* Rows, int32 NumRows, int32 Stride, int32 Dimension, float* OutScores);
+
+    /** Score a query against NumRows bf16 rows that start Stride elements apart, accumulating in float */
+    void (*BatchBFloat16)(const float* Query, const FVectorBFloat16* Rows, int32 NumRows, int32 Stride, int32 Dimension, float* OutScores);
+};
+
+/**
+ * Kernels scoring a float query against rows of 8-bit codes, for quantizers that decode each code
+ * as an affine function of its byte. The caller folds the per-dimension decode into Offsets and Weights.
+ */
+struct FVectorCodeKernel
+{
+    /** Sum of Weights[i] * Codes[i] */
+    float (*Dot)(const float* Weights, const uint8* Codes, int32 Dimension);
+
+    /** Sum of Weights[i] * (Offsets[i] - Codes[i])^2 */
+    float (*SquaredL2)(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension);
+
+    /** Sum of Weights[i] * |Offsets[i] - Codes[i]| */
+    float (*L1)(const float* Offsets, const float* Weights, const uint8* Codes, int32 Dimension);
+};
+
+namespace VectorDistance
+{
+    /** Number of rows scored per Batch call by the scan loops */
+    constexpr int32 BatchSize = 256;
+
+    /** Bytes of stored rows a multi-query scan scores against every query before moving on; small enough to stay in L2 */
+    constexpr int32 TileBytes = 64 * 1024;
+
+    /** Get the fastest available kernel for a metric (AVX2, SSE2 or scalar) */
+    const FVectorDistanceKernel& GetKernel(EVectorDistanceMetric Metric);
+
+    /** Get the fastest available 8-bit code kernel */
+    const FVectorCodeKernel& GetCodeKernel();
+
+    /** Whether higher scores are better for a metric (Cosine, DotProduct) or lower ones are (Euclidean, Manhattan) */
+    inline bool IsSimilarityMetric(EVectorDistanceMetric Metric)
+    {
+        return Metric == EVectorDistanceMetric::Cosine || Metric == EVectorDistanceMetric::DotProduct;
+    }
+
+    /** Get the name of the instruction set the kernels were resolved to */
+    const TCHAR* GetActiveInstructionSetName();
+
+    /** Score a query against NumRows consecutive rows of a storage, whatever its precision */
+    inline void ScoreRows(const FVectorDistanceKernel& Kernel, const float* Query, const FVectorStorage& Storage, int32 FirstRow, int32 NumRows, float* OutScores)
+    {
+        const uint8* Rows = Storage.GetRawRowData(FirstRow);
+        switch (Storage.GetPrecision())
+        {
+            case EVectorStoragePrecision::Float16:
+                Kernel.BatchHalf(Query, reinterpret_cast<const FFloat16*>(Rows), NumRows, Storage.GetStride(), Storage.GetDimension(), OutScores);
+                break;
+
+            case EVectorStoragePrecision::BFloat16:
+                Kernel.BatchBFloat16(Query, reinterpret_cast<const FVectorBFloat16*>(Rows), NumRows, Storage.GetStride(), Storage.GetDimension(), OutScores);
+                break;
+
+            default:
+                Kernel.Batch(Query, reinterpret_cast<const float*>(Rows), NumRows, Storage.GetStride(), Storage.GetDimension(), OutScores);
+                break;
+        }
+    }
+
+    /** Score a query against one row of a storage, whatever its precision */
+    inline float ScoreRow(const FVectorDistanceKernel& Kernel, const float* Query, const FVectorStorage& Storage, int32 Row)
+    {
+        if (Storage.GetPrecision() == EVectorStoragePrecision::Float32)
+        {
+            return Kernel.Single(Query, Storage.GetRowData(Row), Storage.GetDimension());
+        }
+
+        float Score;
+        ScoreRows(Kernel, Query, Storage, Row, 1, &Score);
+        return Score;
+    }
+}
+
+/**
+ * Scores rows of a storage against a query for one metric. Cosine never recomputes norms per row: the query is
+ * scaled to unit length once by PrepareQuery, each row is scored with a dot product and divided by the norm the
+ * storage cached for it, and even that division is skipped while every stored row is unit length.
+ */
+class FVectorRowScorer
+{
+public:
+    explicit FVectorRowScorer(EVectorDistanceMetric Metric);
+
+    /** Get the query to score with: Query itself, or for Cosine a unit-length copy written to Scratch */
+    const float* PrepareQuery(const float* Query, int32 Dimension, TArray<float>& Scratch) const;
+
+    /** Get a stored row prepared as a query */
+    const float* PrepareRowQuery(const FVectorStorage& Storage, int32 Row, TArray<float>& Scratch) const;
+
+    /** Score a prepared query against one row */
+    float ScoreRow(const FVectorStorage& Storage, const float* PreparedQuery, int32 Row) const
+    {
+        const float Score = VectorDistance::ScoreRow(*Kernel, PreparedQuery, Storage, Row);
+        if (!bCosine || Storage.AreRowsNormalized())
+        {
+            return Score;
+        }
+
+        const float Norm = Storage.GetRowNorm(Row);
+        return Norm > 0.0f ? Score / Norm : 0.0f;
+    }
+
+    /** Score a prepared query against NumRows consecutive rows */
+    void ScoreRows(const FVectorStorage& Storage, const float* PreparedQuery, int32 FirstRow, int32 NumRows, float* OutScores) const;
+
+private:
+    /** The metric's kernel, or the dot product kernel for Cosine */
+    const FVectorDistanceKernel* Kernel;
+
+    bool bCosine;
+};
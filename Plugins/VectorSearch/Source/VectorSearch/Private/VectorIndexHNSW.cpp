@@ -0,0 +1,775 @@
+#include "VectorIndexHNSW.h"
+
+namespace
+{
+    /** Heap predicate keeping the smallest key on top */
+    struct FNearestFirst
+    {
+        bool operator()(const FVectorSearchHit& A, const FVectorSearchHit& B) const
+        {
+            return A.Distance < B.Distance;
+        }
+    };
+
+    /** Heap predicate keeping the largest key on top */
+    struct FFurthestFirst
+    {
+        bool operator()(const FVectorSearchHit& A, const FVectorSearchHit& B) const
+        {
+            return A.Distance > B.Distance;
+        }
+    };
+
+    /**
+     * Visited marks for one graph walk at a time, kept per thread and reused across walks and indexes.
+     * A node counts as visited when its stamp equals the current generation, so starting a walk costs
+     * nothing per node; the stamps are only cleared when the generation wraps around.
+     */
+    class FVisitedNodes
+    {
+    public:
+        /** Start a new walk over a graph of NumNodes nodes, all unvisited */
+        void Begin(int32 NumNodes)
+        {
+            if (Stamps.Num() < NumNodes)
+            {
+                Stamps.SetNumZeroed(NumNodes);
+            }
+
+            if (++Generation == 0)
+            {
+                FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint16));
+                Generation = 1;
+            }
+        }
+
+        /** Mark a node as visited. Returns false if it already was during this walk. */
+        bool Visit(int32 Node)
+        {
+            if (Stamps[Node] == Generation)
+            {
+                return false;
+            }
+            Stamps[Node] = Generation;
+            return true;
+        }
+
+        static FVisitedNodes& Get()
+        {
+            // Searches run on many threads at once, so each keeps its own marks
+            static thread_local FVisitedNodes Visited;
+            return Visited;
+        }
+
+    private:
+        TArray<uint16> Stamps;
+
+        uint16 Generation = 0;
+    };
+}
+
+FVectorIndexHNSW::FVectorIndexHNSW(int32 InM, int32 InEfConstruction, int32 InEfSearch)
+    : M(FMath::Max(InM, 2)),
+      MaxM0(FMath::Max(InM, 2) * 2),
+      EfConstruction(FMath::Max(InEfConstruction, 1)),
+      EfSearch(FMath::Max(InEfSearch, 1)),
+      LevelMultiplier(1.0f / FMath::Loge(static_cast<float>(FMath::Max(InM, 2)))),
+      Metric(EVectorDistanceMetric::Euclidean),
+      Scorer(EVectorDistanceMetric::Euclidean),
+      bHigherIsBetter(false),
+      EntryPoint(INDEX_NONE),
+      MaxLevel(0),
+      LevelRandom(LevelSeed)
+{
+}
+
+void FVectorIndexHNSW::Reset(EVectorDistanceMetric InMetric)
+{
+    Metric = InMetric;
+    Scorer = FVectorRowScorer(InMetric);
+    bHigherIsBetter = VectorDistance::IsSimilarityMetric(InMetric);
+    EntryPoint = INDEX_NONE;
+    MaxLevel = 0;
+    Levels.Reset();
+    BaseLinks.Reset();
+    UpperLinks.Reset();
+    LevelRandom.Initialize(LevelSeed);
+}
+
+void FVectorIndexHNSW::Build(const FVectorStorage& Storage, EVectorDistanceMetric InMetric)
+{
+    Reset(InMetric);
+
+    Levels.Reserve(Storage.Num());
+    BaseLinks.Reserve(Storage.Num() * (MaxM0 + 1));
+    UpperLinks.Reserve(Storage.Num());
+
+    for (int32 Row = 0; Row < Storage.Num(); ++Row)
+    {
+        AddRow(Storage, Row);
+    }
+}
+
+int32* FVectorIndexHNSW::GetLinks(int32 Node, int32 Layer)
+{
+    if (Layer == 0)
+    {
+        return BaseLinks.GetData() + static_cast<SIZE_T>(Node) * (MaxM0 + 1);
+    }
+    return UpperLinks[Node].GetData() + (Layer - 1) * (M + 1);
+}
+
+const int32* FVectorIndexHNSW::GetLinks(int32 Node, int32 Layer) const
+{
+    return const_cast<FVectorIndexHNSW*>(this)->GetLinks(Node, Layer);
+}
+
+void FVectorIndexHNSW::SetLinks(int32 Node, int32 Layer, const TArray<FVectorSearchHit>& Neighbours)
+{
+    int32* Links = GetLinks(Node, Layer);
+    const int32 Count = FMath::Min(Neighbours.Num(), GetMaxLinks(Layer));
+    Links[0] = Count;
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Links[1 + i] = Neighbours[i].Row;
+    }
+}
+
+int32 FVectorIndexHNSW::RandomLevel()
+{
+    // Avoid log(0) by drawing from (0, 1]
+    const float Uniform = 1.0f - LevelRandom.GetFraction();
+    const int32 Level = FMath::FloorToInt(-FMath::Loge(Uniform) * LevelMultiplier);
+    return FMath::Clamp(Level, 0, MaxLayers - 1);
+}
+
+void FVectorIndexHNSW::AddRow(const FVectorStorage& Storage, int32 Row)
+{
+    check(Row == Levels.Num());
+
+    const int32 Level = RandomLevel();
+    Levels.Add(static_cast<uint8>(Level));
+
+    const int32 BaseOffset = BaseLinks.AddZeroed(MaxM0 + 1);
+    check(BaseOffset == Row * (MaxM0 + 1));
+
+    TArray<int32>& NodeUpperLinks = UpperLinks.AddDefaulted_GetRef();
+    NodeUpperLinks.SetNumZeroed(Level * (M + 1));
+
+    if (EntryPoint == INDEX_NONE)
+    {
+        EntryPoint = Row;
+        MaxLevel = Level;
+        return;
+    }
+
+    TArray<float> QueryScratch;
+    const float* Query = Scorer.PrepareRowQuery(Storage, Row, QueryScratch);
+
+    // Descend through the layers above the new node's level
+    int32 Nearest = EntryPoint;
+    for (int32 Layer = MaxLevel; Layer > Level; --Layer)
+    {
+        Nearest = GreedyClosest(Storage, Query, Nearest, Layer);
+    }
+
+    TArray<FVectorSearchHit> EntryPoints;
+    EntryPoints.Add(FVectorSearchHit(Nearest, Key(Storage, Query, Nearest)));
+
+    TArray<FVectorSearchHit> Candidates;
+    TArray<FVectorSearchHit> Selected;
+    for (int32 Layer = FMath::Min(Level, MaxLevel); Layer >= 0; --Layer)
+    {
+        SearchLayer(Storage, Query, EntryPoints, EfConstruction, Layer, Candidates);
+        SelectNeighbours(Storage, Candidates, GetMaxLinks(Layer), Selected);
+        SetLinks(Row, Layer, Selected);
+
+        for (const FVectorSearchHit& Neighbour : Selected)
+        {
+            AddBackLink(Storage, Neighbour.Row, Row, Layer);
+        }
+
+        EntryPoints = Candidates;
+    }
+
+    if (Level > MaxLevel)
+    {
+        EntryPoint = Row;
+        MaxLevel = Level;
+    }
+}
+
+void FVectorIndexHNSW::UpdateRow(const FVectorStorage& Storage, int32 Row)
+{
+    check(Row >= 0 && Row < Levels.Num());
+
+    if (Levels.Num() == 1)
+    {
+        return;
+    }
+
+    TArray<float> QueryScratch;
+    const float* Query = Scorer.PrepareRowQuery(Storage, Row, QueryScratch);
+    const int32 Level = Levels[Row];
+
+    // Find the new neighbourhood the way an insert does, keeping the node's level so the layers above stay intact
+    int32 Nearest = EntryPoint;
+    for (int32 Layer = MaxLevel; Layer > Level; --Layer)
+    {
+        Nearest = GreedyClosest(Storage, Query, Nearest, Layer);
+    }
+
+    TArray<FVectorSearchHit> EntryPoints;
+    EntryPoints.Add(FVectorSearchHit(Nearest, Key(Storage, Query, Nearest)));
+
+    TArray<FVectorSearchHit> Candidates;
+    TArray<FVectorSearchHit> Selected;
+    TArray<int32> FormerNeighbours;
+    for (int32 Layer = Level; Layer >= 0; --Layer)
+    {
+        SearchLayer(Storage, Query, EntryPoints, EfConstruction, Layer, Candidates);
+        EntryPoints = Candidates;
+
+        // The walk can reach the node itself through its old links
+        Candidates.RemoveAll([Row](const FVectorSearchHit& Hit) { return Hit.Row == Row; });
+
+        SelectNeighbours(Storage, Candidates, GetMaxLinks(Layer), Selected);
+
+        const int32* OldLinks = GetLinks(Row, Layer);
+        FormerNeighbours.Reset();
+        FormerNeighbours.Append(OldLinks + 1, OldLinks[0]);
+        SetLinks(Row, Layer, Selected);
+
+        // Former neighbours the node no longer links to would keep a link into its old neighbourhood; they drop it
+        // and, as Compact does for dropped nodes, pick replacements among the node's other former neighbours
+        for (const int32 Former : FormerNeighbours)
+        {
+            if (!Selected.ContainsByPredicate([Former](const FVectorSearchHit& Hit) { return Hit.Row == Former; }))
+            {
+                RemoveLink(Storage, Former, Row, Layer, FormerNeighbours);
+            }
+        }
+
+        for (const FVectorSearchHit& Neighbour : Selected)
+        {
+            const int32* NeighbourLinks = GetLinks(Neighbour.Row, Layer);
+            bool bAlreadyLinked = false;
+            for (int32 i = 0; i < NeighbourLinks[0] && !bAlreadyLinked; ++i)
+            {
+                bAlreadyLinked = NeighbourLinks[1 + i] == Row;
+            }
+
+            if (!bAlreadyLinked)
+            {
+                AddBackLink(Storage, Neighbour.Row, Row, Layer);
+            }
+        }
+    }
+}
+
+void FVectorIndexHNSW::AddBackLink(const FVectorStorage& Storage, int32 Node, int32 NewNeighbour, int32 Layer)
+{
+    int32* Links = GetLinks(Node, Layer);
+    const int32 MaxLinks = GetMaxLinks(Layer);
+
+    if (Links[0] < MaxLinks)
+    {
+        Links[1 + Links[0]] = NewNeighbour;
+        Links[0]++;
+        return;
+    }
+
+    // Full: re-select among the existing links plus the new one
+    TArray<float> NodeScratch;
+    const float* NodeVector = Scorer.PrepareRowQuery(Storage, Node, NodeScratch);
+
+    TArray<FVectorSearchHit> Candidates;
+    Candidates.Reserve(MaxLinks + 1);
+    for (int32 i = 0; i < Links[0]; ++i)
+    {
+        Candidates.Add(FVectorSearchHit(Links[1 + i], Key(Storage, NodeVector, Links[1 + i])));
+    }
+    Candidates.Add(FVectorSearchHit(NewNeighbour, Key(Storage, NodeVector, NewNeighbour)));
+    Candidates.Sort(FNearestFirst());
+
+    TArray<FVectorSearchHit> Selected;
+    SelectNeighbours(Storage, Candidates, MaxLinks, Selected);
+    SetLinks(Node, Layer, Selected);
+}
+
+void FVectorIndexHNSW::RemoveLink(const FVectorStorage& Storage, int32 Node, int32 OldNeighbour, int32 Layer, TArrayView<const int32> Replacements)
+{
+    const int32* Links = GetLinks(Node, Layer);
+
+    bool bLinked = false;
+    for (int32 i = 0; i < Links[0] && !bLinked; ++i)
+    {
+        bLinked = Links[1 + i] == OldNeighbour;
+    }
+
+    if (!bLinked)
+    {
+        return;
+    }
+
+    TArray<float> NodeScratch;
+    const float* NodeVector = Scorer.PrepareRowQuery(Storage, Node, NodeScratch);
+
+    TArray<FVectorSearchHit> Candidates;
+    Candidates.Reserve(Links[0] + Replacements.Num());
+    auto AddCandidate = [&](int32 Candidate)
+    {
+        if (Candidate != Node && Candidate != OldNeighbour
+            && !Candidates.ContainsByPredicate([Candidate](const FVectorSearchHit& Hit) { return Hit.Row == Candidate; }))
+        {
+            Candidates.Add(FVectorSearchHit(Candidate, Key(Storage, NodeVector, Candidate)));
+        }
+    };
+
+    for (int32 i = 0; i < Links[0]; ++i)
+    {
+        AddCandidate(Links[1 + i]);
+    }
+    for (const int32 Replacement : Replacements)
+    {
+        AddCandidate(Replacement);
+    }
+
+    Candidates.Sort(FNearestFirst());
+    TArray<FVectorSearchHit> Selected;
+    SelectNeighbours(Storage, Candidates, GetMaxLinks(Layer), Selected);
+    SetLinks(Node, Layer, Selected);
+}
+
+int32 FVectorIndexHNSW::GreedyClosest(const FVectorStorage& Storage, const float* Query, int32 EntryNode, int32 Layer) const
+{
+    int32 Current = EntryNode;
+    float CurrentKey = Key(Storage, Query, Current);
+
+    bool bImproved = true;
+    while (bImproved)
+    {
+        bImproved = false;
+
+        const int32* Links = GetLinks(Current, Layer);
+        for (int32 i = 0; i < Links[0]; ++i)
+        {
+            const int32 Neighbour = Links[1 + i];
+            const float NeighbourKey = Key(Storage, Query, Neighbour);
+            if (NeighbourKey < CurrentKey)
+            {
+                Current = Neighbour;
+                CurrentKey = NeighbourKey;
+                bImproved = true;
+            }
+        }
+    }
+
+    return Current;
+}
+
+void FVectorIndexHNSW::SearchLayer(const FVectorStorage& Storage, const float* Query, const TArray<FVectorSearchHit>& EntryPoints, int32 Ef, int32 Layer, TArray<FVectorSearchHit>& OutNearest) const
+{
+    FVisitedNodes& Visited = FVisitedNodes::Get();
+    Visited.Begin(Levels.Num());
+
+    TArray<FVectorSearchHit> Candidates;
+    TArray<FVectorSearchHit> Nearest;
+    Candidates.Reserve(Ef * 2);
+    Nearest.Reserve(Ef + 1);
+
+    for (const FVectorSearchHit& Entry : EntryPoints)
+    {
+        if (Visited.Visit(Entry.Row))
+        {
+            Candidates.HeapPush(Entry, FNearestFirst());
+            Nearest.HeapPush(Entry, FFurthestFirst());
+            if (Nearest.Num() > Ef)
+            {
+                Nearest.HeapPopDiscard(FFurthestFirst(), false);
+            }
+        }
+    }
+
+    while (Candidates.Num() > 0)
+    {
+        FVectorSearchHit Closest;
+        Candidates.HeapPop(Closest, FNearestFirst(), false);
+
+        if (Nearest.Num() >= Ef && Closest.Distance > Nearest.HeapTop().Distance)
+        {
+            break;
+        }
+
+        const int32* Links = GetLinks(Closest.Row, Layer);
+        for (int32 i = 0; i < Links[0]; ++i)
+        {
+            const int32 Neighbour = Links[1 + i];
+            if (!Visited.Visit(Neighbour))
+            {
+                continue;
+            }
+
+            const float NeighbourKey = Key(Storage, Query, Neighbour);
+            if (Nearest.Num() < Ef || NeighbourKey < Nearest.HeapTop().Distance)
+            {
+                Candidates.HeapPush(FVectorSearchHit(Neighbour, NeighbourKey), FNearestFirst());
+                Nearest.HeapPush(FVectorSearchHit(Neighbour, NeighbourKey), FFurthestFirst());
+                if (Nearest.Num() > Ef)
+                {
+                    Nearest.HeapPopDiscard(FFurthestFirst(), false);
+                }
+            }
+        }
+    }
+
+    OutNearest = MoveTemp(Nearest);
+    OutNearest.Sort(FNearestFirst());
+}
+
+void FVectorIndexHNSW::SearchBaseLayerFiltered(const FVectorStorage& Storage, const float* Query, const FVectorSearchHit& EntryPoint, int32 Ef, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutNearest) const
+{
+    FVisitedNodes& Visited = FVisitedNodes::Get();
+    Visited.Begin(Levels.Num());
+
+    TArray<FVectorSearchHit> Candidates;
+    TArray<FVectorSearchHit> Nearest;
+    Candidates.Reserve(Ef * 2);
+    Nearest.Reserve(Ef + 1);
+
+    Visited.Visit(EntryPoint.Row);
+    Candidates.HeapPush(EntryPoint, FNearestFirst());
+    if (Filter(EntryPoint.Row))
+    {
+        Nearest.HeapPush(EntryPoint, FFurthestFirst());
+    }
+
+    // Rejected nodes still expand the frontier, so the walk can cross regions where nothing matches.
+    // The beam only closes once Ef accepted nodes are held and every candidate left is further than all of them.
+    while (Candidates.Num() > 0)
+    {
+        FVectorSearchHit Closest;
+        Candidates.HeapPop(Closest, FNearestFirst(), false);
+
+        if (Nearest.Num() >= Ef && Closest.Distance > Nearest.HeapTop().Distance)
+        {
+            break;
+        }
+
+        const int32* Links = GetLinks(Closest.Row, 0);
+        for (int32 i = 0; i < Links[0]; ++i)
+        {
+            const int32 Neighbour = Links[1 + i];
+            if (!Visited.Visit(Neighbour))
+            {
+                continue;
+            }
+
+            const float NeighbourKey = Key(Storage, Query, Neighbour);
+            if (Nearest.Num() < Ef || NeighbourKey < Nearest.HeapTop().Distance)
+            {
+                Candidates.HeapPush(FVectorSearchHit(Neighbour, NeighbourKey), FNearestFirst());
+
+                if (Filter(Neighbour))
+                {
+                    Nearest.HeapPush(FVectorSearchHit(Neighbour, NeighbourKey), FFurthestFirst());
+                    if (Nearest.Num() > Ef)
+                    {
+                        Nearest.HeapPopDiscard(FFurthestFirst(), false);
+                    }
+                }
+            }
+        }
+    }
+
+    OutNearest = MoveTemp(Nearest);
+    OutNearest.Sort(FNearestFirst());
+}
+
+void FVectorIndexHNSW::SelectNeighbours(const FVectorStorage& Storage, const TArray<FVectorSearchHit>& Candidates, int32 MaxLinks, TArray<FVectorSearchHit>& OutSelected) const
+{
+    OutSelected.Reset();
+
+    if (Candidates.Num() <= MaxLinks)
+    {
+        OutSelected = Candidates;
+        return;
+    }
+
+    // Keep a candidate only if it is closer to the base node than to every neighbour already kept,
+    // which spreads links across directions instead of clustering them
+    TArray<float> CandidateScratch;
+    for (const FVectorSearchHit& Candidate : Candidates)
+    {
+        if (OutSelected.Num() >= MaxLinks)
+        {
+            break;
+        }
+
+        const float* CandidateVector = Scorer.PrepareRowQuery(Storage, Candidate.Row, CandidateScratch);
+
+        bool bKeep = true;
+        for (const FVectorSearchHit& Kept : OutSelected)
+        {
+            if (Key(Storage, CandidateVector, Kept.Row) < Candidate.Distance)
+            {
+                bKeep = false;
+                break;
+            }
+        }
+
+        if (bKeep)
+        {
+            OutSelected.Add(Candidate);
+        }
+    }
+}
+
+void FVectorIndexHNSW::Compact(const FVectorStorage& Storage, TArrayView<const int32> RowRemap)
+{
+    check(RowRemap.Num() == Levels.Num());
+
+    // Repair every surviving neighbourhood that loses a link. The dropped nodes' own links are the natural
+    // replacements, so the graph stays connected across the gap they leave behind.
+    TArray<FVectorSearchHit> Candidates;
+    TArray<FVectorSearchHit> Selected;
+    TArray<float> NodeScratch;
+    for (int32 Node = 0; Node < Levels.Num(); ++Node)
+    {
+        if (RowRemap[Node] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        for (int32 Layer = 0; Layer <= Levels[Node]; ++Layer)
+        {
+            const int32* Links = GetLinks(Node, Layer);
+
+            bool bLostLink = false;
+            for (int32 i = 0; i < Links[0] && !bLostLink; ++i)
+            {
+                bLostLink = RowRemap[Links[1 + i]] == INDEX_NONE;
+            }
+
+            if (!bLostLink)
+            {
+                continue;
+            }
+
+            const float* NodeVector = Scorer.PrepareRowQuery(Storage, Node, NodeScratch);
+
+            auto AddCandidate = [&](int32 Candidate)
+            {
+                if (Candidate != Node && RowRemap[Candidate] != INDEX_NONE
+                    && !Candidates.ContainsByPredicate([Candidate](const FVectorSearchHit& Hit) { return Hit.Row == Candidate; }))
+                {
+                    Candidates.Add(FVectorSearchHit(Candidate, Key(Storage, NodeVector, Candidate)));
+                }
+            };
+
+            Candidates.Reset();
+            for (int32 i = 0; i < Links[0]; ++i)
+            {
+                const int32 Neighbour = Links[1 + i];
+                if (RowRemap[Neighbour] != INDEX_NONE)
+                {
+                    AddCandidate(Neighbour);
+                    continue;
+                }
+
+                // Dropped nodes are never repaired themselves, so their links are still the original ones
+                const int32* DroppedLinks = GetLinks(Neighbour, Layer);
+                for (int32 j = 0; j < DroppedLinks[0]; ++j)
+                {
+                    AddCandidate(DroppedLinks[1 + j]);
+                }
+            }
+
+            Candidates.Sort(FNearestFirst());
+            SelectNeighbours(Storage, Candidates, GetMaxLinks(Layer), Selected);
+            SetLinks(Node, Layer, Selected);
+        }
+    }
+
+    // Pack the surviving nodes to the front and renumber their links
+    const int32 BaseStride = MaxM0 + 1;
+    int32 NumKept = 0;
+    for (int32 Node = 0; Node < Levels.Num(); ++Node)
+    {
+        if (RowRemap[Node] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        check(RowRemap[Node] == NumKept);
+        if (NumKept != Node)
+        {
+            Levels[NumKept] = Levels[Node];
+            FMemory::Memmove(BaseLinks.GetData() + static_cast<SIZE_T>(NumKept) * BaseStride, BaseLinks.GetData() + static_cast<SIZE_T>(Node) * BaseStride, BaseStride * sizeof(int32));
+            UpperLinks[NumKept] = MoveTemp(UpperLinks[Node]);
+        }
+
+        for (int32 Layer = 0; Layer <= Levels[NumKept]; ++Layer)
+        {
+            int32* Links = GetLinks(NumKept, Layer);
+            for (int32 i = 0; i < Links[0]; ++i)
+            {
+                Links[1 + i] = RowRemap[Links[1 + i]];
+            }
+        }
+
+        NumKept++;
+    }
+
+    const int32 OldEntryPoint = EntryPoint;
+
+    Levels.SetNum(NumKept, false);
+    BaseLinks.SetNum(NumKept * BaseStride, false);
+    UpperLinks.SetNum(NumKept, false);
+
+    if (OldEntryPoint != INDEX_NONE && RowRemap[OldEntryPoint] != INDEX_NONE)
+    {
+        EntryPoint = RowRemap[OldEntryPoint];
+        return;
+    }
+
+    // The entry point was dropped: the highest surviving node takes over
+    EntryPoint = INDEX_NONE;
+    MaxLevel = 0;
+    for (int32 Node = 0; Node < Levels.Num(); ++Node)
+    {
+        if (EntryPoint == INDEX_NONE || Levels[Node] > MaxLevel)
+        {
+            EntryPoint = Node;
+            MaxLevel = Levels[Node];
+        }
+    }
+}
+
+void FVectorIndexHNSW::Search(const FVectorStorage& Storage, const float* RawQuery, int32 K, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const
+{
+    OutHits.Reset();
+
+    if (EntryPoint == INDEX_NONE || K <= 0)
+    {
+        return;
+    }
+
+    TArray<float> QueryScratch;
+    const float* Query = Scorer.PrepareQuery(RawQuery, Storage.GetDimension(), QueryScratch);
+
+    int32 Nearest = EntryPoint;
+    for (int32 Layer = MaxLevel; Layer > 0; --Layer)
+    {
+        Nearest = GreedyClosest(Storage, Query, Nearest, Layer);
+    }
+
+    // Filtering during the walk rather than afterwards keeps recall when few nodes near the query match
+    TArray<FVectorSearchHit> Candidates;
+    SearchBaseLayerFiltered(Storage, Query, FVectorSearchHit(Nearest, Key(Storage, Query, Nearest)), FMath::Max(EfSearch, K), Filter, Candidates);
+
+    const int32 NumHits = FMath::Min(Candidates.Num(), K);
+    OutHits.Reserve(NumHits);
+    for (int32 i = 0; i < NumHits; ++i)
+    {
+        // Convert the ranking key back to the metric value reported to callers
+        OutHits.Add(FVectorSearchHit(Candidates[i].Row, bHigherIsBetter ? -Candidates[i].Distance : Candidates[i].Distance));
+    }
+}
+
+void FVectorIndexHNSW::Serialize(FArchive& Ar, const FVectorStorage& Storage)
+{
+    // EfSearch only affects queries, so it is taken from the settings rather than the saved graph
+    int32 SavedM = M;
+    int32 SavedEfConstruction = EfConstruction;
+    EVectorDistanceMetric SavedMetric = Metric;
+    Ar << SavedM;
+    Ar << SavedEfConstruction;
+    Ar << SavedMetric;
+
+    if (Ar.IsLoading())
+    {
+        Reset(SavedMetric);
+        if (SavedM != M || SavedEfConstruction != EfConstruction)
+        {
+            Ar.SetError();
+            return;
+        }
+    }
+
+    int32 RandomSeed = LevelRandom.GetCurrentSeed();
+    Ar << EntryPoint;
+    Ar << MaxLevel;
+    Ar << RandomSeed;
+    Levels.BulkSerialize(Ar);
+    BaseLinks.BulkSerialize(Ar);
+    Ar << UpperLinks;
+
+    if (Ar.IsLoading())
+    {
+        // Nodes added after loading draw the levels they would have drawn had the graph never been saved
+        LevelRandom.Initialize(RandomSeed);
+
+        if (Ar.IsError() || !HasValidStructure(Storage.Num()))
+        {
+            Ar.SetError();
+            Reset(Metric);
+        }
+    }
+}
+
+bool FVectorIndexHNSW::HasValidStructure(int32 NumRows) const
+{
+    if (Levels.Num() != NumRows || UpperLinks.Num() != NumRows || BaseLinks.Num() != NumRows * (MaxM0 + 1))
+    {
+        return false;
+    }
+
+    if (NumRows == 0)
+    {
+        return EntryPoint == INDEX_NONE;
+    }
+
+    if (EntryPoint < 0 || EntryPoint >= NumRows || Levels[EntryPoint] != MaxLevel)
+    {
+        return false;
+    }
+
+    for (int32 Node = 0; Node < NumRows; ++Node)
+    {
+        const int32 Level = Levels[Node];
+        if (Level >= MaxLayers || UpperLinks[Node].Num() != Level * (M + 1))
+        {
+            return false;
+        }
+
+        for (int32 Layer = 0; Layer <= Level; ++Layer)
+        {
+            const int32* Links = GetLinks(Node, Layer);
+            if (Links[0] < 0 || Links[0] > GetMaxLinks(Layer))
+            {
+                return false;
+            }
+
+            for (int32 i = 1; i <= Links[0]; ++i)
+            {
+                if (Links[i] < 0 || Links[i] >= NumRows)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+SIZE_T FVectorIndexHNSW::GetAllocatedSize() const
+{
+    SIZE_T Size = Levels.GetAllocatedSize() + BaseLinks.GetAllocatedSize() + UpperLinks.GetAllocatedSize();
+    for (const TArray<int32>& Links : UpperLinks)
+    {
+        Size += Links.GetAllocatedSize();
+    }
+    return Size;
+}
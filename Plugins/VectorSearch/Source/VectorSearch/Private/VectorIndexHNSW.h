@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorIndex.h"
+#include "VectorDatabaseTypes.h"
+#include "VectorDistanceKernels.h"
+
+/**
+ * Hierarchical Navigable Small World graph index (Malkov & Yashunin).
+ * Node ids are database rows. Every metric is searched on a "lower is better" key:
+ * the distance for Euclidean/Manhattan, the negated similarity for Cosine/DotProduct.
+ */
+class FVectorIndexHNSW : public IVectorIndex
+{
+public:
+    FVectorIndexHNSW(int32 InM, int32 InEfConstruction, int32 InEfSearch);
+
+    //~ Begin IVectorIndex Interface
+    virtual void Build(const FVectorStorage& Storage, EVectorDistanceMetric InMetric) override;
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void Compact(const FVectorStorage& Storage, TArrayView<const int32> RowRemap) override;
+    virtual void Search(const FVectorStorage& Storage, const float* Query, int32 K, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const override;
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) override;
+    virtual int32 Num() const override { return Levels.Num(); }
+    virtual SIZE_T GetAllocatedSize() const override;
+    //~ End IVectorIndex Interface
+
+private:
+    /** Hard cap on the number of layers */
+    static constexpr int32 MaxLayers = 16;
+
+    /** Seed for level generation so identical inserts build identical graphs */
+    static constexpr int32 LevelSeed = 0x484E5357;
+
+    /** Get the maximum number of links a node keeps on a layer */
+    int32 GetMaxLinks(int32 Layer) const { return Layer == 0 ? MaxM0 : M; }
+
+    /** Get the link list of a node on a layer; element 0 is the link count */
+    int32* GetLinks(int32 Node, int32 Layer);
+    const int32* GetLinks(int32 Node, int32 Layer) const;
+
+    /** Overwrite the link list of a node on a layer */
+    void SetLinks(int32 Node, int32 Layer, const TArray<FVectorSearchHit>& Neighbours);
+
+    /** Compute the ranking key between a query prepared by Scorer and a node */
+    float Key(const FVectorStorage& Storage, const float* Query, int32 Node) const
+    {
+        const float Score = Scorer.ScoreRow(Storage, Query, Node);
+        return bHigherIsBetter ? -Score : Score;
+    }
+
+    /** Draw a random level for a new node */
+    int32 RandomLevel();
+
+    /** Greedy descent from EntryNode on a layer, returning the closest node found */
+    int32 GreedyClosest(const FVectorStorage& Storage, const float* Query, int32 EntryNode, int32 Layer) const;
+
+    /** Beam search on a layer. Returns up to Ef nodes sorted by ascending key. */
+    void SearchLayer(const FVectorStorage& Storage, const float* Query, const TArray<FVectorSearchHit>& EntryPoints, int32 Ef, int32 Layer, TArray<FVectorSearchHit>& OutNearest) const;
+
+    /**
+     * Beam search on layer 0 that walks through every node but only keeps nodes accepted by Filter.
+     * Returns up to Ef accepted nodes sorted by ascending key.
+     */
+    void SearchBaseLayerFiltered(const FVectorStorage& Storage, const float* Query, const FVectorSearchHit& EntryPoint, int32 Ef, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutNearest) const;
+
+    /** Pick at most MaxLinks diverse neighbours from Candidates sorted by ascending key */
+    void SelectNeighbours(const FVectorStorage& Storage, const TArray<FVectorSearchHit>& Candidates, int32 MaxLinks, TArray<FVectorSearchHit>& OutSelected) const;
+
+    /** Add a back link from Node to NewNeighbour, pruning Node's links if it overflows */
+    void AddBackLink(const FVectorStorage& Storage, int32 Node, int32 NewNeighbour, int32 Layer);
+
+    /** Drop Node's link to OldNeighbour, if any, and re-select Node's links among the rest and Replacements */
+    void RemoveLink(const FVectorStorage& Storage, int32 Node, int32 OldNeighbour, int32 Layer, TArrayView<const int32> Replacements);
+
+    /** Reset the graph and bind it to a metric */
+    void Reset(EVectorDistanceMetric InMetric);
+
+    /** Check that the graph covers NumRows nodes and every link points at one of them */
+    bool HasValidStructure(int32 NumRows) const;
+
+    int32 M;
+
+    int32 MaxM0;
+
+    int32 EfConstruction;
+
+    int32 EfSearch;
+
+    float LevelMultiplier;
+
+    EVectorDistanceMetric Metric;
+
+    FVectorRowScorer Scorer;
+
+    bool bHigherIsBetter;
+
+    int32 EntryPoint;
+
+    int32 MaxLevel;
+
+    /** Top layer of every node */
+    TArray<uint8> Levels;
+
+    /** Layer 0 links, (MaxM0 + 1) ints per node */
+    TArray<int32> BaseLinks;
+
+    /** Links for layers 1..Level of every node, (M + 1) ints per layer */
+    TArray<TArray<int32>> UpperLinks;
+
+    FRandomStream LevelRandom;
+};
@@ -0,0 +1,425 @@
+#include "VectorIndexIVF.h"
+#include "Algo/BinarySearch.h"
+
+FVectorIndexIVF::FVectorIndexIVF(int32 InNumLists, int32 InNumProbes)
+    : NumLists(FMath::Max(InNumLists, 1)),
+      NumProbes(FMath::Clamp(InNumProbes, 1, FMath::Max(InNumLists, 1))),
+      Metric(EVectorDistanceMetric::Euclidean),
+      CentroidKernel(&VectorDistance::GetKernel(EVectorDistanceMetric::Euclidean)),
+      Scorer(EVectorDistanceMetric::Euclidean),
+      bHigherIsBetter(false)
+{
+}
+
+void FVectorIndexIVF::SetMetric(EVectorDistanceMetric InMetric)
+{
+    Metric = InMetric;
+    CentroidKernel = &VectorDistance::GetKernel(InMetric == EVectorDistanceMetric::Cosine ? EVectorDistanceMetric::DotProduct : InMetric);
+    Scorer = FVectorRowScorer(InMetric);
+    bHigherIsBetter = VectorDistance::IsSimilarityMetric(InMetric);
+}
+
+void FVectorIndexIVF::Clear()
+{
+    Centroids.Empty();
+    Lists.Reset();
+    UnassignedRows.Reset();
+    RowToList.Reset();
+}
+
+void FVectorIndexIVF::Build(const FVectorStorage& Storage, EVectorDistanceMetric InMetric)
+{
+    SetMetric(InMetric);
+    Clear();
+    RowToList.Reserve(Storage.Num());
+
+    // Too few rows to train meaningful centroids: every query scans them all until the database grows
+    if (Storage.Num() < NumLists * MinTrainingRowsPerList)
+    {
+        for (int32 Row = 0; Row < Storage.Num(); ++Row)
+        {
+            UnassignedRows.Add(Row);
+            RowToList.Add(UnassignedList);
+        }
+        return;
+    }
+
+    TrainCentroids(Storage);
+
+    Lists.SetNum(NumLists);
+    TArray<float> Scratch;
+    for (int32 Row = 0; Row < Storage.Num(); ++Row)
+    {
+        const int32 List = FindNearestList(Storage.GetRowAsFloat(Row, Scratch));
+        Lists[List].Add(Row);
+        RowToList.Add(List);
+    }
+}
+
+void FVectorIndexIVF::TrainCentroids(const FVectorStorage& Storage)
+{
+    const int32 Dimension = Storage.GetDimension();
+    const int32 NumRows = Storage.Num();
+    const int32 NumSamples = FMath::Min(NumRows, NumLists * MaxTrainingRowsPerList);
+
+    // Partial Fisher-Yates shuffle: the first NumSamples entries become a uniform random sample
+    FRandomStream Random(TrainingSeed);
+    TArray<int32> Samples;
+    Samples.SetNumUninitialized(NumRows);
+    for (int32 i = 0; i < NumRows; ++i)
+    {
+        Samples[i] = i;
+    }
+    for (int32 i = 0; i < NumSamples; ++i)
+    {
+        Samples.Swap(i, Random.RandRange(i, NumRows - 1));
+    }
+    Samples.SetNum(NumSamples, false);
+
+    // Seed the centroids with distinct sample rows
+    TArray<float> Scratch;
+    Centroids.SetDimension(Dimension);
+    Centroids.Reserve(NumLists);
+    for (int32 List = 0; List < NumLists; ++List)
+    {
+        Centroids.Add(TArrayView<const float>(Storage.GetRowAsFloat(Samples[List], Scratch), Dimension));
+        NormalizeCentroid(Centroids.GetRowData(List));
+    }
+
+    TArray<double> Sums;
+    TArray<int32> Counts;
+    for (int32 Iteration = 0; Iteration < TrainingIterations; ++Iteration)
+    {
+        Sums.SetNumZeroed(NumLists * Dimension);
+        Counts.SetNumZeroed(NumLists);
+
+        for (int32 Sample : Samples)
+        {
+            const float* Vector = Storage.GetRowAsFloat(Sample, Scratch);
+            const int32 List = FindNearestList(Vector);
+
+            double* Sum = Sums.GetData() + static_cast<SIZE_T>(List) * Dimension;
+            for (int32 d = 0; d < Dimension; ++d)
+            {
+                Sum[d] += Vector[d];
+            }
+            Counts[List]++;
+        }
+
+        for (int32 List = 0; List < NumLists; ++List)
+        {
+            float* Centroid = Centroids.GetRowData(List);
+
+            if (Counts[List] == 0)
+            {
+                // Reseed empty lists from a random sample so every list stays useful
+                const float* Reseed = Storage.GetRowAsFloat(Samples[Random.RandHelper(NumSamples)], Scratch);
+                FMemory::Memcpy(Centroid, Reseed, Dimension * sizeof(float));
+            }
+            else
+            {
+                const double* Sum = Sums.GetData() + static_cast<SIZE_T>(List) * Dimension;
+                const double InvCount = 1.0 / Counts[List];
+                for (int32 d = 0; d < Dimension; ++d)
+                {
+                    Centroid[d] = static_cast<float>(Sum[d] * InvCount);
+                }
+            }
+
+            NormalizeCentroid(Centroid);
+        }
+    }
+}
+
+void FVectorIndexIVF::NormalizeCentroid(float* Centroid) const
+{
+    if (Metric != EVectorDistanceMetric::Cosine)
+    {
+        return;
+    }
+
+    const int32 Dimension = Centroids.GetDimension();
+
+    float Norm = 0.0f;
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        Norm += Centroid[d] * Centroid[d];
+    }
+
+    Norm = FMath::Sqrt(Norm);
+    if (Norm > 0.0f)
+    {
+        for (int32 d = 0; d < Dimension; ++d)
+        {
+            Centroid[d] /= Norm;
+        }
+    }
+}
+
+int32 FVectorIndexIVF::FindNearestList(const float* Vector) const
+{
+    const int32 Dimension = Centroids.GetDimension();
+
+    int32 BestList = 0;
+    float BestScore = CentroidKernel->Single(Vector, Centroids.GetRowData(0), Dimension);
+    for (int32 List = 1; List < Centroids.Num(); ++List)
+    {
+        const float Score = CentroidKernel->Single(Vector, Centroids.GetRowData(List), Dimension);
+        if (bHigherIsBetter ? Score > BestScore : Score < BestScore)
+        {
+            BestScore = Score;
+            BestList = List;
+        }
+    }
+
+    return BestList;
+}
+
+void FVectorIndexIVF::AddRow(const FVectorStorage& Storage, int32 Row)
+{
+    check(Row == RowToList.Num());
+
+    if (!IsTrained())
+    {
+        if (Storage.Num() >= NumLists * MinTrainingRowsPerList)
+        {
+            // Enough data has arrived to train the coarse quantizer
+            Build(Storage, Metric);
+            return;
+        }
+
+        UnassignedRows.Add(Row);
+        RowToList.Add(UnassignedList);
+        return;
+    }
+
+    TArray<float> Scratch;
+    const int32 List = FindNearestList(Storage.GetRowAsFloat(Row, Scratch));
+    Lists[List].Add(Row);
+    RowToList.Add(List);
+}
+
+void FVectorIndexIVF::UpdateRow(const FVectorStorage& Storage, int32 Row)
+{
+    check(Row >= 0 && Row < RowToList.Num());
+
+    // Rows added before training are scanned by every query wherever they move
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    TArray<float> Scratch;
+    const int32 NewList = FindNearestList(Storage.GetRowAsFloat(Row, Scratch));
+    const int32 OldList = RowToList[Row];
+    if (NewList == OldList)
+    {
+        return;
+    }
+
+    // Both lists stay in ascending row order
+    TArray<int32>& OldRows = Lists[OldList];
+    OldRows.RemoveAt(Algo::LowerBound(OldRows, Row), 1, false);
+
+    TArray<int32>& NewRows = Lists[NewList];
+    NewRows.Insert(Row, Algo::LowerBound(NewRows, Row));
+
+    RowToList[Row] = NewList;
+}
+
+void FVectorIndexIVF::Compact(const FVectorStorage& Storage, TArrayView<const int32> RowRemap)
+{
+    check(RowRemap.Num() == RowToList.Num());
+
+    // Lists stay in ascending row order because surviving rows keep their order
+    auto RemapRows = [RowRemap](TArray<int32>& Rows)
+    {
+        int32 NumKept = 0;
+        for (const int32 Row : Rows)
+        {
+            if (RowRemap[Row] != INDEX_NONE)
+            {
+                Rows[NumKept++] = RowRemap[Row];
+            }
+        }
+        Rows.SetNum(NumKept, false);
+    };
+
+    for (TArray<int32>& ListRows : Lists)
+    {
+        RemapRows(ListRows);
+    }
+    RemapRows(UnassignedRows);
+
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < RowToList.Num(); ++Row)
+    {
+        if (RowRemap[Row] != INDEX_NONE)
+        {
+            RowToList[NumKept++] = RowToList[Row];
+        }
+    }
+    RowToList.SetNum(NumKept, false);
+}
+
+void FVectorIndexIVF::Search(const FVectorStorage& Storage, const float* Query, int32 K, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const
+{
+    OutHits.Reset();
+
+    if (K <= 0)
+    {
+        return;
+    }
+
+    const int32 Dimension = Storage.GetDimension();
+    FVectorTopK TopK(K, bHigherIsBetter);
+
+    TArray<float> QueryScratch;
+    const float* PreparedQuery = Scorer.PrepareQuery(Query, Dimension, QueryScratch);
+
+    int32 NumAccepted = 0;
+    auto ScanList = [&](const TArray<int32>& Rows)
+    {
+        for (int32 Row : Rows)
+        {
+            if (Filter(Row))
+            {
+                TopK.Add(Row, Scorer.ScoreRow(Storage, PreparedQuery, Row));
+                NumAccepted++;
+            }
+        }
+    };
+
+    if (IsTrained())
+    {
+        // Rank the centroids nearest first
+        TArray<float> CentroidScores;
+        CentroidScores.SetNumUninitialized(Centroids.Num());
+        CentroidKernel->Batch(Query, Centroids.GetData(), Centroids.Num(), Centroids.GetStride(), Dimension, CentroidScores.GetData());
+
+        FVectorTopK Probes(Centroids.Num(), bHigherIsBetter);
+        for (int32 List = 0; List < Centroids.Num(); ++List)
+        {
+            Probes.Add(List, CentroidScores[List]);
+        }
+
+        TArray<FVectorSearchHit> ProbedLists;
+        Probes.GetSortedHits(ProbedLists);
+
+        // An unfiltered query scores every row of the NumProbes nearest lists. A filtered one keeps probing further
+        // lists until it has scored as many accepted rows, so selective filters keep the same recall.
+        int32 CandidateBudget = 0;
+        for (int32 Probe = 0; Probe < FMath::Min(NumProbes, ProbedLists.Num()); ++Probe)
+        {
+            CandidateBudget += Lists[ProbedLists[Probe].Row].Num();
+        }
+
+        for (int32 Probe = 0; Probe < ProbedLists.Num(); ++Probe)
+        {
+            if (Probe >= NumProbes && NumAccepted >= CandidateBudget && TopK.IsFull())
+            {
+                break;
+            }
+            ScanList(Lists[ProbedLists[Probe].Row]);
+        }
+    }
+
+    ScanList(UnassignedRows);
+
+    TopK.GetSortedHits(OutHits);
+}
+
+SIZE_T FVectorIndexIVF::GetAllocatedSize() const
+{
+    SIZE_T Size = Centroids.GetAllocatedSize() + Lists.GetAllocatedSize() + UnassignedRows.GetAllocatedSize() + RowToList.GetAllocatedSize();
+    for (const TArray<int32>& Members : Lists)
+    {
+        Size += Members.GetAllocatedSize();
+    }
+    return Size;
+}
+
+void FVectorIndexIVF::Serialize(FArchive& Ar, const FVectorStorage& Storage)
+{
+    // NumProbes only affects queries, so it is taken from the settings rather than the saved lists
+    int32 SavedNumLists = NumLists;
+    EVectorDistanceMetric SavedMetric = Metric;
+    Ar << SavedNumLists;
+    Ar << SavedMetric;
+
+    if (Ar.IsLoading())
+    {
+        SetMetric(SavedMetric);
+        Clear();
+        if (SavedNumLists != NumLists)
+        {
+            Ar.SetError();
+            return;
+        }
+    }
+
+    int32 NumCentroids = Centroids.Num();
+    int32 CentroidDimension = Centroids.GetDimension();
+    Ar << NumCentroids;
+    Ar << CentroidDimension;
+
+    if (Ar.IsLoading())
+    {
+        // Centroids are trained from the stored rows, so they share their dimension
+        if (Ar.IsError() || (NumCentroids != 0 && (NumCentroids != NumLists || CentroidDimension != Storage.GetDimension())))
+        {
+            Ar.SetError();
+            return;
+        }
+        Centroids.LoadRawData(Ar, CentroidDimension, NumCentroids);
+    }
+    else
+    {
+        TArrayView64<const uint8> RawData = Centroids.GetRawData();
+        Ar.Serialize(const_cast<uint8*>(RawData.GetData()), RawData.Num());
+    }
+
+    Ar << Lists;
+    UnassignedRows.BulkSerialize(Ar);
+    RowToList.BulkSerialize(Ar);
+
+    if (Ar.IsLoading() && (Ar.IsError() || !HasValidStructure(Storage.Num())))
+    {
+        Ar.SetError();
+        Clear();
+    }
+}
+
+bool FVectorIndexIVF::HasValidStructure(int32 NumRows) const
+{
+    if (RowToList.Num() != NumRows || Lists.Num() != (IsTrained() ? NumLists : 0))
+    {
+        return false;
+    }
+
+    int32 NumListed = 0;
+    auto AreListedRowsValid = [this, &NumListed](const TArray<int32>& Rows, int32 List)
+    {
+        for (int32 i = 0; i < Rows.Num(); ++i)
+        {
+            const int32 Row = Rows[i];
+            if (!RowToList.IsValidIndex(Row) || RowToList[Row] != List || (i > 0 && Rows[i - 1] >= Row))
+            {
+                return false;
+            }
+        }
+        NumListed += Rows.Num();
+        return true;
+    };
+
+    for (int32 List = 0; List < Lists.Num(); ++List)
+    {
+        if (!AreListedRowsValid(Lists[List], List))
+        {
+            return false;
+        }
+    }
+
+    // Every row is in exactly one list, since each is listed in order under the list RowToList names
+    return AreListedRowsValid(UnassignedRows, UnassignedList) && NumListed == NumRows;
+}
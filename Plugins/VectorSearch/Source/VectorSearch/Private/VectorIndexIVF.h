@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorIndex.h"
+#include "VectorDatabaseTypes.h"
+#include "VectorDistanceKernels.h"
+
+/**
+ * Inverted file index with a k-means coarse quantizer (IVF-Flat).
+ * Every row is assigned to the inverted list of its best centroid; queries rank the centroids
+ * and only scan the rows of the NumProbes best lists. Vectors stay in the database storage.
+ */
+class FVectorIndexIVF : public IVectorIndex
+{
+public:
+    FVectorIndexIVF(int32 InNumLists, int32 InNumProbes);
+
+    //~ Begin IVectorIndex Interface
+    virtual void Build(const FVectorStorage& Storage, EVectorDistanceMetric InMetric) override;
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void Compact(const FVectorStorage& Storage, TArrayView<const int32> RowRemap) override;
+    virtual void Search(const FVectorStorage& Storage, const float* Query, int32 K, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const override;
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) override;
+    virtual int32 Num() const override { return RowToList.Num(); }
+    virtual SIZE_T GetAllocatedSize() const override;
+    //~ End IVectorIndex Interface
+
+    /** Check whether the centroids have been trained */
+    bool IsTrained() const { return Centroids.Num() > 0; }
+
+private:
+    /** Training rows sampled per centroid */
+    static constexpr int32 MaxTrainingRowsPerList = 256;
+
+    /** Rows needed per centroid before training is attempted */
+    static constexpr int32 MinTrainingRowsPerList = 8;
+
+    /** Number of Lloyd iterations */
+    static constexpr int32 TrainingIterations = 16;
+
+    /** Seed for training sample selection so builds are reproducible */
+    static constexpr int32 TrainingSeed = 0x49564621;
+
+    /** List id of rows added before the centroids were trained */
+    static constexpr int32 UnassignedList = INDEX_NONE;
+
+    /** Bind the index to a metric */
+    void SetMetric(EVectorDistanceMetric InMetric);
+
+    /** Check that the lists cover NumRows rows, each in the list RowToList assigns it to */
+    bool HasValidStructure(int32 NumRows) const;
+
+    /** Forget the centroids and every row */
+    void Clear();
+
+    /** Train centroids with k-means over a sample of the stored rows */
+    void TrainCentroids(const FVectorStorage& Storage);
+
+    /** Get the list whose centroid ranks best for a vector */
+    int32 FindNearestList(const float* Vector) const;
+
+    /** Keep centroids on the unit sphere for the Cosine metric */
+    void NormalizeCentroid(float* Centroid) const;
+
+    int32 NumLists;
+
+    int32 NumProbes;
+
+    EVectorDistanceMetric Metric;
+
+    /** Kernel ranking the centroids; a dot product for Cosine, where the centroids are unit length and only their order matters */
+    const FVectorDistanceKernel* CentroidKernel;
+
+    /** Scores stored rows against queries */
+    FVectorRowScorer Scorer;
+
+    bool bHigherIsBetter;
+
+    /** One centroid per inverted list */
+    FVectorStorage Centroids;
+
+    /** Rows assigned to each list, in ascending row order */
+    TArray<TArray<int32>> Lists;
+
+    /** Rows added before training, scanned by every query */
+    TArray<int32> UnassignedRows;
+
+    /** List id of every row */
+    TArray<int32> RowToList;
+};
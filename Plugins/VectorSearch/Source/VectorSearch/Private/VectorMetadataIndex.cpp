@@ -0,0 +1,194 @@
+#include "VectorMetadataIndex.h"
+#include "VectorDatabaseTypes.h"
+#include "Algo/BinarySearch.h"
+#include <limits>
+
+namespace
+{
+    /** Column value of rows whose metadata has no number for the key */
+    constexpr double MissingNumber = std::numeric_limits<double>::quiet_NaN();
+
+    bool TryParseNumber(const FString& Value, double& OutNumber)
+    {
+        return !Value.IsEmpty() && LexTryParseString(OutNumber, *Value);
+    }
+}
+
+void FVectorMetadataIndex::AddRow(int32 Row, const TMap<FString, FString>& Metadata)
+{
+    check(Row == NumRows);
+
+    for (const TPair<FString, FString>& Pair : Metadata)
+    {
+        FKeyPostings& Postings = Keys.FindOrAdd(Pair.Key);
+        Postings.RowsByValue.FindOrAdd(Pair.Value).Add(Row);
+
+        double Number;
+        if (TryParseNumber(Pair.Value, Number))
+        {
+            if (Postings.NumericValues.Num() == 0)
+            {
+                // First numeric value for this key: earlier rows had none
+                Postings.NumericValues.Init(MissingNumber, Row);
+            }
+            Postings.NumericValues.Add(Number);
+        }
+    }
+
+    NumRows++;
+
+    // Keep every numeric column one value per row, including keys this row does not have
+    for (TPair<FString, FKeyPostings>& Key : Keys)
+    {
+        TArray<double>& Column = Key.Value.NumericValues;
+        if (Column.Num() > 0 && Column.Num() < NumRows)
+        {
+            Column.Add(MissingNumber);
+        }
+    }
+}
+
+void FVectorMetadataIndex::UpdateRow(int32 Row, const TMap<FString, FString>& OldMetadata, const TMap<FString, FString>& NewMetadata)
+{
+    check(Row < NumRows);
+
+    for (const TPair<FString, FString>& Pair : OldMetadata)
+    {
+        FKeyPostings* Postings = Keys.Find(Pair.Key);
+        TArray<int32>* Rows = Postings ? Postings->RowsByValue.Find(Pair.Value) : nullptr;
+        if (!Rows)
+        {
+            continue;
+        }
+
+        const int32 Index = Algo::LowerBound(*Rows, Row);
+        if (Rows->IsValidIndex(Index) && (*Rows)[Index] == Row)
+        {
+            Rows->RemoveAt(Index, 1, false);
+        }
+        if (Rows->Num() == 0)
+        {
+            Postings->RowsByValue.Remove(Pair.Value);
+        }
+        if (Postings->NumericValues.Num() > 0)
+        {
+            Postings->NumericValues[Row] = MissingNumber;
+        }
+    }
+
+    for (const TPair<FString, FString>& Pair : NewMetadata)
+    {
+        FKeyPostings& Postings = Keys.FindOrAdd(Pair.Key);
+        TArray<int32>& Rows = Postings.RowsByValue.FindOrAdd(Pair.Value);
+        Rows.Insert(Row, Algo::LowerBound(Rows, Row));
+
+        double Number;
+        if (TryParseNumber(Pair.Value, Number))
+        {
+            if (Postings.NumericValues.Num() == 0)
+            {
+                Postings.NumericValues.Init(MissingNumber, NumRows);
+            }
+            Postings.NumericValues[Row] = Number;
+        }
+    }
+
+    // Keys no row holds any more are dropped, so predicates on them fail as fast as on unknown keys
+    for (const TPair<FString, FString>& Pair : OldMetadata)
+    {
+        const FKeyPostings* Postings = Keys.Find(Pair.Key);
+        if (Postings && Postings->RowsByValue.Num() == 0)
+        {
+            Keys.Remove(Pair.Key);
+        }
+    }
+}
+
+void FVectorMetadataIndex::Empty()
+{
+    Keys.Empty();
+    NumRows = 0;
+}
+
+bool FVectorMetadataIndex::Evaluate(TArrayView<const FVectorMetadataPredicate> Predicates, TBitArray<>& OutRows) const
+{
+    if (Predicates.Num() == 0)
+    {
+        return false;
+    }
+
+    OutRows.Init(true, NumRows);
+
+    TBitArray<> Matches;
+    for (const FVectorMetadataPredicate& Predicate : Predicates)
+    {
+        Matches.Init(false, NumRows);
+        EvaluatePredicate(Predicate, Matches);
+        OutRows.CombineWithBitwiseAND(Matches, EBitwiseOperatorFlags::MaintainSize);
+    }
+
+    return true;
+}
+
+void FVectorMetadataIndex::EvaluatePredicate(const FVectorMetadataPredicate& Predicate, TBitArray<>& OutMatches) const
+{
+    const FKeyPostings* Postings = Keys.Find(Predicate.Key);
+    if (!Postings)
+    {
+        // No row has the key, so nothing matches
+        return;
+    }
+
+    auto SetRows = [&OutMatches](const TArray<int32>* Rows)
+    {
+        if (Rows)
+        {
+            for (const int32 Row : *Rows)
+            {
+                OutMatches[Row] = true;
+            }
+        }
+    };
+
+    switch (Predicate.Type)
+    {
+        case EVectorMetadataPredicateType::Equals:
+            SetRows(Postings->RowsByValue.Find(Predicate.Value));
+            break;
+
+        case EVectorMetadataPredicateType::InSet:
+            for (const FString& Value : Predicate.Values)
+            {
+                SetRows(Postings->RowsByValue.Find(Value));
+            }
+            break;
+
+        case EVectorMetadataPredicateType::Range:
+        {
+            // NaN compares false both ways, so rows without a numeric value never match
+            const TArray<double>& Column = Postings->NumericValues;
+            for (int32 Row = 0; Row < Column.Num(); ++Row)
+            {
+                if (Column[Row] >= Predicate.Min && Column[Row] <= Predicate.Max)
+                {
+                    OutMatches[Row] = true;
+                }
+            }
+            break;
+        }
+    }
+}
+
+SIZE_T FVectorMetadataIndex::GetAllocatedSize() const
+{
+    SIZE_T Size = Keys.GetAllocatedSize();
+    for (const TPair<FString, FKeyPostings>& Key : Keys)
+    {
+        Size += Key.Value.RowsByValue.GetAllocatedSize() + Key.Value.NumericValues.GetAllocatedSize();
+        for (const TPair<FString, TArray<int32>>& Value : Key.Value.RowsByValue)
+        {
+            Size += Value.Value.GetAllocatedSize();
+        }
+    }
+    return Size;
+}
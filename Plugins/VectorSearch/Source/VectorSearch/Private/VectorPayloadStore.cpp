@@ -0,0 +1,456 @@
+#include "VectorPayloadStore.h"
+#include "VectorDatabaseTypes.h"
+#include "UObject/Package.h"
+
+namespace
+{
+    const FString EmptyString;
+
+    const TArray<uint8> EmptyStructData;
+
+    const TMap<FString, FString> EmptyMetadata;
+}
+
+FVectorPayloadStore::~FVectorPayloadStore()
+{
+    Empty();
+}
+
+FVectorPayloadStore::FVectorPayloadStore(const FVectorPayloadStore& Other)
+{
+    *this = Other;
+}
+
+FVectorPayloadStore& FVectorPayloadStore::operator=(const FVectorPayloadStore& Other)
+{
+    if (this != &Other)
+    {
+        Empty();
+
+        Types = Other.Types;
+        ValueSlots = Other.ValueSlots;
+        MetadataSlots = Other.MetadataSlots;
+        Strings = Other.Strings;
+        Objects = Other.Objects;
+        StructTypes = Other.StructTypes;
+        MetadataMaps = Other.MetadataMaps;
+
+        StructValues.SetNum(StructTypes.Num());
+        for (int32 Slot = 0; Slot < StructTypes.Num(); ++Slot)
+        {
+            UScriptStruct* StructType = StructTypes[Slot];
+            const TArray<uint8>& Source = Other.StructValues[Slot];
+            if (StructType && Source.Num() > 0)
+            {
+                TArray<uint8>& Value = StructValues[Slot];
+                Value.SetNumUninitialized(StructType->GetStructureSize());
+                StructType->InitializeStruct(Value.GetData());
+                StructType->CopyScriptStruct(Value.GetData(), Source.GetData());
+            }
+        }
+    }
+    return *this;
+}
+
+FVectorPayloadStore& FVectorPayloadStore::operator=(FVectorPayloadStore&& Other)
+{
+    if (this != &Other)
+    {
+        Empty();
+
+        Types = MoveTemp(Other.Types);
+        ValueSlots = MoveTemp(Other.ValueSlots);
+        MetadataSlots = MoveTemp(Other.MetadataSlots);
+        Strings = MoveTemp(Other.Strings);
+        Objects = MoveTemp(Other.Objects);
+        StructTypes = MoveTemp(Other.StructTypes);
+        StructValues = MoveTemp(Other.StructValues);
+        MetadataMaps = MoveTemp(Other.MetadataMaps);
+    }
+    return *this;
+}
+
+int32 FVectorPayloadStore::AddRow(EEntryType Type, int32 ValueSlot, const TMap<FString, FString>& Metadata)
+{
+    Types.Add(Type);
+    ValueSlots.Add(ValueSlot);
+    MetadataSlots.Add(Metadata.Num() > 0 ? MetadataMaps.Add(Metadata) : INDEX_NONE);
+    return Types.Num() - 1;
+}
+
+int32 FVectorPayloadStore::AddString(const FString& Value, const TMap<FString, FString>& Metadata)
+{
+    return AddRow(EEntryType::String, Strings.Add(Value), Metadata);
+}
+
+int32 FVectorPayloadStore::AddObject(UObject* Value, const TMap<FString, FString>& Metadata)
+{
+    return AddRow(EEntryType::Object, Objects.Add(Value), Metadata);
+}
+
+int32 FVectorPayloadStore::AddStruct(UScriptStruct* StructType, const void* StructPtr, const TMap<FString, FString>& Metadata)
+{
+    const int32 Slot = StructTypes.Add(StructType);
+    TArray<uint8>& Value = StructValues.AddDefaulted_GetRef();
+
+    if (StructType && StructPtr)
+    {
+        // Keep a live instance so strings and arrays inside the struct are owned by the store
+        Value.SetNumUninitialized(StructType->GetStructureSize());
+        StructType->InitializeStruct(Value.GetData());
+        StructType->CopyScriptStruct(Value.GetData(), StructPtr);
+    }
+
+    return AddRow(EEntryType::Struct, Slot, Metadata);
+}
+
+int32 FVectorPayloadStore::AddFromWrapper(const UVectorEntryWrapper& Wrapper)
+{
+    switch (Wrapper.EntryType)
+    {
+        case EEntryType::Object:
+            return AddObject(Wrapper.ObjectValue, Wrapper.Metadata);
+
+        case EEntryType::Struct:
+            return AddStruct(Wrapper.StructType, Wrapper.StructData.Num() > 0 ? Wrapper.StructData.GetData() : nullptr, Wrapper.Metadata);
+
+        default:
+            return AddString(Wrapper.StringValue, Wrapper.Metadata);
+    }
+}
+
+const FString& FVectorPayloadStore::GetString(int32 Row) const
+{
+    return Types[Row] == EEntryType::String ? Strings[ValueSlots[Row]] : EmptyString;
+}
+
+UObject* FVectorPayloadStore::GetObject(int32 Row) const
+{
+    return Types[Row] == EEntryType::Object ? Objects[ValueSlots[Row]] : nullptr;
+}
+
+UScriptStruct* FVectorPayloadStore::GetStructType(int32 Row) const
+{
+    return Types[Row] == EEntryType::Struct ? StructTypes[ValueSlots[Row]] : nullptr;
+}
+
+const TArray<uint8>& FVectorPayloadStore::GetStructData(int32 Row) const
+{
+    return Types[Row] == EEntryType::Struct ? StructValues[ValueSlots[Row]] : EmptyStructData;
+}
+
+void* FVectorPayloadStore::GetMutableStructData(int32 Row)
+{
+    if (Types[Row] != EEntryType::Struct)
+    {
+        return nullptr;
+    }
+
+    TArray<uint8>& Value = StructValues[ValueSlots[Row]];
+    return Value.Num() > 0 ? Value.GetData() : nullptr;
+}
+
+const TMap<FString, FString>& FVectorPayloadStore::GetMetadata(int32 Row) const
+{
+    const int32 Slot = MetadataSlots[Row];
+    return Slot != INDEX_NONE ? MetadataMaps[Slot] : EmptyMetadata;
+}
+
+void FVectorPayloadStore::SetMetadata(int32 Row, const TMap<FString, FString>& Metadata)
+{
+    int32& Slot = MetadataSlots[Row];
+    if (Slot != INDEX_NONE)
+    {
+        MetadataMaps[Slot] = Metadata;
+    }
+    else if (Metadata.Num() > 0)
+    {
+        Slot = MetadataMaps.Add(Metadata);
+    }
+}
+
+UVectorEntryWrapper* FVectorPayloadStore::MakeWrapper(int32 Row, const FString& Category, UObject* Outer) const
+{
+    UVectorEntryWrapper* Wrapper = NewObject<UVectorEntryWrapper>(Outer ? Outer : GetTransientPackage());
+    Wrapper->EntryType = Types[Row];
+    Wrapper->Category = Category;
+    Wrapper->Metadata = GetMetadata(Row);
+
+    switch (Types[Row])
+    {
+        case EEntryType::String:
+            Wrapper->StringValue = GetString(Row);
+            break;
+
+        case EEntryType::Object:
+            Wrapper->ObjectValue = GetObject(Row);
+            break;
+
+        case EEntryType::Struct:
+            if (GetStructType(Row) && GetStructData(Row).Num() > 0)
+            {
+                Wrapper->SetStructData(GetStructType(Row), GetStructData(Row).GetData());
+            }
+            break;
+    }
+
+    return Wrapper;
+}
+
+void FVectorPayloadStore::DestroyStructValue(int32 Slot)
+{
+    TArray<uint8>& Value = StructValues[Slot];
+    if (StructTypes[Slot] && Value.Num() > 0)
+    {
+        StructTypes[Slot]->DestroyStruct(Value.GetData());
+    }
+    Value.Empty();
+    StructTypes[Slot] = nullptr;
+}
+
+void FVectorPayloadStore::Release(int32 Row)
+{
+    const int32 Slot = ValueSlots[Row];
+    switch (Types[Row])
+    {
+        case EEntryType::String:
+            Strings[Slot].Empty();
+            break;
+
+        case EEntryType::Object:
+            Objects[Slot] = nullptr;
+            break;
+
+        case EEntryType::Struct:
+            DestroyStructValue(Slot);
+            break;
+    }
+
+    if (MetadataSlots[Row] != INDEX_NONE)
+    {
+        MetadataMaps[MetadataSlots[Row]].Empty();
+        MetadataSlots[Row] = INDEX_NONE;
+    }
+}
+
+void FVectorPayloadStore::Compact(TArrayView<const int32> RowRemap)
+{
+    check(RowRemap.Num() == Num());
+
+    TArray<FString> KeptStrings;
+    TArray<UObject*> KeptObjects;
+    TArray<UScriptStruct*> KeptStructTypes;
+    TArray<TArray<uint8>> KeptStructValues;
+    TArray<TMap<FString, FString>> KeptMetadataMaps;
+
+    // Value columns are rebuilt in row order; struct instances move with their buffers, so nothing is re-copied
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < Types.Num(); ++Row)
+    {
+        const int32 Slot = ValueSlots[Row];
+
+        if (RowRemap[Row] == INDEX_NONE)
+        {
+            if (Types[Row] == EEntryType::Struct)
+            {
+                DestroyStructValue(Slot);
+            }
+            continue;
+        }
+
+        check(RowRemap[Row] == NumKept);
+
+        int32 KeptSlot;
+        switch (Types[Row])
+        {
+            case EEntryType::Object:
+                KeptSlot = KeptObjects.Add(Objects[Slot]);
+                break;
+
+            case EEntryType::Struct:
+                KeptSlot = KeptStructTypes.Add(StructTypes[Slot]);
+                KeptStructValues.Add(MoveTemp(StructValues[Slot]));
+                break;
+
+            default:
+                KeptSlot = KeptStrings.Add(MoveTemp(Strings[Slot]));
+                break;
+        }
+
+        const int32 MetadataSlot = MetadataSlots[Row];
+
+        Types[NumKept] = Types[Row];
+        ValueSlots[NumKept] = KeptSlot;
+        MetadataSlots[NumKept] = MetadataSlot != INDEX_NONE ? KeptMetadataMaps.Add(MoveTemp(MetadataMaps[MetadataSlot])) : INDEX_NONE;
+        NumKept++;
+    }
+
+    Types.SetNum(NumKept, false);
+    ValueSlots.SetNum(NumKept, false);
+    MetadataSlots.SetNum(NumKept, false);
+
+    Strings = MoveTemp(KeptStrings);
+    Objects = MoveTemp(KeptObjects);
+    StructTypes = MoveTemp(KeptStructTypes);
+    StructValues = MoveTemp(KeptStructValues);
+    MetadataMaps = MoveTemp(KeptMetadataMaps);
+}
+
+void FVectorPayloadStore::Reserve(int32 NumRows)
+{
+    Types.Reserve(NumRows);
+    ValueSlots.Reserve(NumRows);
+    MetadataSlots.Reserve(NumRows);
+}
+
+void FVectorPayloadStore::Empty()
+{
+    for (int32 Slot = 0; Slot < StructValues.Num(); ++Slot)
+    {
+        DestroyStructValue(Slot);
+    }
+
+    Types.Empty();
+    ValueSlots.Empty();
+    MetadataSlots.Empty();
+    Strings.Empty();
+    Objects.Empty();
+    StructTypes.Empty();
+    StructValues.Empty();
+    MetadataMaps.Empty();
+}
+
+void FVectorPayloadStore::Serialize(FArchive& Ar)
+{
+    if (Ar.IsLoading())
+    {
+        Empty();
+    }
+
+    Ar << Types;
+    Ar << ValueSlots;
+    Ar << MetadataSlots;
+    Ar << Strings;
+    Ar << Objects;
+    Ar << StructTypes;
+    Ar << MetadataMaps;
+
+    if (Ar.IsLoading())
+    {
+        StructValues.SetNum(StructTypes.Num());
+    }
+
+    for (int32 Slot = 0; Slot < StructTypes.Num() && !Ar.IsError(); ++Slot)
+    {
+        SerializeStructValue(Ar, Slot);
+    }
+
+    if (Ar.IsLoading() && (Ar.IsError() || !HasValidSlots()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("FVectorPayloadStore::Serialize: Payload data is corrupt"));
+        Ar.SetError();
+        Empty();
+    }
+}
+
+void FVectorPayloadStore::SerializeStructValue(FArchive& Ar, int32 Slot)
+{
+    UScriptStruct* StructType = StructTypes[Slot];
+    TArray<uint8>& Value = StructValues[Slot];
+
+    const int64 SizeOffset = Ar.Tell();
+    int64 Size = 0;
+    Ar << Size;
+    const int64 ValueOffset = Ar.Tell();
+
+    if (Ar.IsSaving())
+    {
+        if (StructType && Value.Num() > 0)
+        {
+            StructType->SerializeItem(Ar, Value.GetData(), nullptr);
+
+            const int64 EndOffset = Ar.Tell();
+            Size = EndOffset - ValueOffset;
+            Ar.Seek(SizeOffset);
+            Ar << Size;
+            Ar.Seek(EndOffset);
+        }
+    }
+    else if (Size > 0)
+    {
+        if (StructType)
+        {
+            Value.SetNumUninitialized(StructType->GetStructureSize());
+            StructType->InitializeStruct(Value.GetData());
+            StructType->SerializeItem(Ar, Value.GetData(), nullptr);
+        }
+
+        // Values whose type could not be found are skipped whole
+        Ar.Seek(ValueOffset + Size);
+    }
+}
+
+bool FVectorPayloadStore::HasValidSlots() const
+{
+    if (ValueSlots.Num() != Types.Num() || MetadataSlots.Num() != Types.Num() || StructValues.Num() != StructTypes.Num())
+    {
+        return false;
+    }
+
+    for (int32 Row = 0; Row < Types.Num(); ++Row)
+    {
+        const int32 Slot = ValueSlots[Row];
+        int32 NumSlots;
+        switch (Types[Row])
+        {
+            case EEntryType::String:
+                NumSlots = Strings.Num();
+                break;
+
+            case EEntryType::Object:
+                NumSlots = Objects.Num();
+                break;
+
+            case EEntryType::Struct:
+                NumSlots = StructTypes.Num();
+                break;
+
+            default:
+                return false;
+        }
+
+        if (Slot < 0 || Slot >= NumSlots)
+        {
+            return false;
+        }
+
+        if (MetadataSlots[Row] != INDEX_NONE && !MetadataMaps.IsValidIndex(MetadataSlots[Row]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FVectorPayloadStore::AddReferencedObjects(FReferenceCollector& Collector)
+{
+    Collector.AddReferencedObjects(Objects);
+    Collector.AddReferencedObjects(StructTypes);
+
+    // Struct values may hold object properties of their own, which only the struct's reflection knows about
+    for (int32 Slot = 0; Slot < StructTypes.Num(); ++Slot)
+    {
+        if (StructTypes[Slot] && StructValues[Slot].Num() > 0)
+        {
+            Collector.AddPropertyReferences(StructTypes[Slot], StructValues[Slot].GetData());
+        }
+    }
+}
+
+SIZE_T FVectorPayloadStore::GetAllocatedSize() const
+{
+    return Types.GetAllocatedSize() + ValueSlots.GetAllocatedSize() + MetadataSlots.GetAllocatedSize()
+        + Strings.GetAllocatedSize() + Objects.GetAllocatedSize() + StructTypes.GetAllocatedSize()
+        + StructValues.GetAllocatedSize() + MetadataMaps.GetAllocatedSize();
+}
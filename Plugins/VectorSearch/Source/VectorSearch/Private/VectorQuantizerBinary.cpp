@@ -0,0 +1,205 @@
+#include "VectorQuantizerBinary.h"
+#include "Async/ParallelFor.h"
+
+FVectorQuantizerBinary::FVectorQuantizerBinary()
+    : Dimension(0),
+      NumWords(0),
+      Metric(EVectorDistanceMetric::Euclidean),
+      NumRows(0)
+{
+}
+
+void FVectorQuantizerBinary::Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric)
+{
+    Metric = InMetric;
+
+    Dimension = 0;
+    NumWords = 0;
+    NumRows = 0;
+    Thresholds.Empty();
+    Codes.Empty();
+
+    // Means of a handful of rows are mostly noise; wait for AddRow to bring more data
+    if (Storage.Num() < MinTrainingRows)
+    {
+        return;
+    }
+
+    Dimension = Storage.GetDimension();
+    NumWords = FMath::DivideAndRoundUp(Dimension, 64);
+
+    // Centering on the mean keeps the bits balanced even when the embeddings are not zero-centred
+    TArray<double> Sums;
+    Sums.SetNumZeroed(Dimension);
+    TArray<float> Scratch;
+    for (int32 Row = 0; Row < Storage.Num(); ++Row)
+    {
+        const float* Vector = Storage.GetRowAsFloat(Row, Scratch);
+        for (int32 d = 0; d < Dimension; ++d)
+        {
+            Sums[d] += Vector[d];
+        }
+    }
+
+    Thresholds.SetNumUninitialized(Dimension);
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        Thresholds[d] = static_cast<float>(Sums[d] / Storage.Num());
+    }
+
+    NumRows = Storage.Num();
+    Codes.SetNumUninitialized(NumRows * NumWords);
+    ParallelFor(NumRows, [this, &Storage](int32 Row)
+    {
+        TArray<float> RowScratch;
+        Encode(Storage.GetRowAsFloat(Row, RowScratch), Codes.GetData() + static_cast<SIZE_T>(Row) * NumWords);
+    });
+}
+
+void FVectorQuantizerBinary::Encode(const float* Vector, uint64* OutCode) const
+{
+    for (int32 Word = 0; Word < NumWords; ++Word)
+    {
+        const int32 First = Word * 64;
+        const int32 Last = FMath::Min(First + 64, Dimension);
+
+        uint64 Bits = 0;
+        for (int32 d = First; d < Last; ++d)
+        {
+            Bits |= static_cast<uint64>(Vector[d] > Thresholds[d]) << (d - First);
+        }
+        OutCode[Word] = Bits;
+    }
+}
+
+void FVectorQuantizerBinary::AddRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        if (Storage.Num() >= MinTrainingRows)
+        {
+            // Enough data has arrived to learn the thresholds
+            Train(Storage, Metric);
+        }
+        return;
+    }
+
+    check(Row == NumRows);
+
+    TArray<float> Scratch;
+    Codes.AddUninitialized(NumWords);
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Codes.GetData() + static_cast<SIZE_T>(Row) * NumWords);
+    NumRows++;
+}
+
+void FVectorQuantizerBinary::UpdateRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(Row >= 0 && Row < NumRows);
+
+    TArray<float> Scratch;
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Codes.GetData() + static_cast<SIZE_T>(Row) * NumWords);
+}
+
+void FVectorQuantizerBinary::Compact(TArrayView<const int32> RowRemap)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(RowRemap.Num() == NumRows);
+
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        if (RowRemap[Row] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        check(RowRemap[Row] == NumKept);
+        FMemory::Memmove(Codes.GetData() + static_cast<SIZE_T>(NumKept) * NumWords, Codes.GetData() + static_cast<SIZE_T>(Row) * NumWords, NumWords * sizeof(uint64));
+        NumKept++;
+    }
+
+    NumRows = NumKept;
+    Codes.SetNum(NumRows * NumWords, false);
+}
+
+TUniquePtr<FVectorQuantizerQuery> FVectorQuantizerBinary::PrepareQuery(const float* Query) const
+{
+    check(IsTrained());
+
+    // Hamming distance is lower-is-better whatever the metric; ties resolve by row
+    TUniquePtr<FQuery> PreparedQuery = MakeUnique<FQuery>();
+    PreparedQuery->bHigherIsBetter = false;
+    PreparedQuery->Code.SetNumUninitialized(NumWords);
+    Encode(Query, PreparedQuery->Code.GetData());
+    return PreparedQuery;
+}
+
+void FVectorQuantizerBinary::ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const
+{
+    const uint64* QueryCode = static_cast<const FQuery&>(PreparedQuery).Code.GetData();
+
+    for (int32 Row = FirstRow; Row < EndRow; ++Row)
+    {
+        if (!Filter(Row))
+        {
+            continue;
+        }
+
+        const uint64* Code = Codes.GetData() + static_cast<SIZE_T>(Row) * NumWords;
+
+        int32 Distance = 0;
+        for (int32 Word = 0; Word < NumWords; ++Word)
+        {
+            Distance += FMath::CountBits(Code[Word] ^ QueryCode[Word]);
+        }
+
+        TopK.Add(Row, static_cast<float>(Distance));
+    }
+}
+
+void FVectorQuantizerBinary::Serialize(FArchive& Ar, const FVectorStorage& Storage)
+{
+    Ar << Metric;
+    Ar << Dimension;
+    Ar << NumRows;
+
+    if (Ar.IsLoading())
+    {
+        NumWords = FMath::DivideAndRoundUp(Dimension, 64);
+        if (Ar.IsError() || Dimension == 0 || Dimension != Storage.GetDimension() || NumRows != Storage.Num())
+        {
+            Ar.SetError();
+            Dimension = 0;
+            NumWords = 0;
+            NumRows = 0;
+            return;
+        }
+    }
+
+    Thresholds.BulkSerialize(Ar);
+    Codes.BulkSerialize(Ar);
+
+    if (Ar.IsLoading() && (Ar.IsError() || Thresholds.Num() != Dimension || Codes.Num() != NumRows * NumWords))
+    {
+        Ar.SetError();
+        Dimension = 0;
+        NumWords = 0;
+        NumRows = 0;
+        Thresholds.Empty();
+        Codes.Empty();
+    }
+}
+
+SIZE_T FVectorQuantizerBinary::GetAllocatedSize() const
+{
+    return Thresholds.GetAllocatedSize() + Codes.GetAllocatedSize();
+}
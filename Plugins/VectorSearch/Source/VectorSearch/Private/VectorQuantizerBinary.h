@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorQuantizer.h"
+#include "VectorDatabaseTypes.h"
+
+/**
+ * Binary quantizer with one bit per dimension.
+ * Each bit records whether a component lies above the trained per-dimension mean, so a 1536-dimension
+ * vector packs into 24 words. Scans rank rows by popcount Hamming distance, which is only a proxy for
+ * the metric, so the shortlist must always be rescored.
+ */
+class FVectorQuantizerBinary : public IVectorQuantizer
+{
+public:
+    FVectorQuantizerBinary();
+
+    //~ Begin IVectorQuantizer Interface
+    virtual void Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric) override;
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void Compact(TArrayView<const int32> RowRemap) override;
+    virtual TUniquePtr<FVectorQuantizerQuery> PrepareQuery(const float* Query) const override;
+    virtual void ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const override;
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) override;
+    virtual bool IsTrained() const override { return NumWords > 0; }
+    virtual bool RequiresRescore() const override { return true; }
+    virtual int32 Num() const override { return NumRows; }
+    virtual SIZE_T GetAllocatedSize() const override;
+    //~ End IVectorQuantizer Interface
+
+private:
+    /** Code of a query, compared against every row code */
+    class FQuery : public FVectorQuantizerQuery
+    {
+    public:
+        TArray<uint64> Code;
+    };
+
+    /** Rows needed before the thresholds are learned */
+    static constexpr int32 MinTrainingRows = 256;
+
+    /** Write the bits of a vector into OutCode (NumWords words) */
+    void Encode(const float* Vector, uint64* OutCode) const;
+
+    int32 Dimension;
+
+    int32 NumWords;
+
+    EVectorDistanceMetric Metric;
+
+    /** Per-dimension mean; components above it encode as 1 */
+    TArray<float> Thresholds;
+
+    /** One code of NumWords words per row */
+    TArray<uint64> Codes;
+
+    int32 NumRows;
+};
@@ -0,0 +1,433 @@
+#include "VectorQuantizerPQ.h"
+#include "VectorDistanceKernels.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    float SquaredDistance(const float* A, const float* B, int32 Dimension)
+    {
+        float Sum = 0.0f;
+        for (int32 d = 0; d < Dimension; ++d)
+        {
+            const float Diff = A[d] - B[d];
+            Sum += Diff * Diff;
+        }
+        return Sum;
+    }
+
+    int32 FindNearestCentroid(const float* Vector, const float* Centroids, int32 NumCentroids, int32 Dimension)
+    {
+        int32 BestCentroid = 0;
+        float BestDistance = TNumericLimits<float>::Max();
+        for (int32 Centroid = 0; Centroid < NumCentroids; ++Centroid)
+        {
+            const float Distance = SquaredDistance(Vector, Centroids + static_cast<SIZE_T>(Centroid) * Dimension, Dimension);
+            if (Distance < BestDistance)
+            {
+                BestDistance = Distance;
+                BestCentroid = Centroid;
+            }
+        }
+        return BestCentroid;
+    }
+}
+
+FVectorQuantizerPQ::FVectorQuantizerPQ(int32 InNumSubQuantizers)
+    : RequestedSubQuantizers(FMath::Max(InNumSubQuantizers, 0)),
+      NumSubQuantizers(0),
+      NumCentroids(0),
+      Dimension(0),
+      Metric(EVectorDistanceMetric::Euclidean),
+      bHigherIsBetter(false),
+      NumRows(0)
+{
+}
+
+void FVectorQuantizerPQ::Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric)
+{
+    Metric = InMetric;
+    bHigherIsBetter = VectorDistance::IsSimilarityMetric(InMetric);
+
+    NumCentroids = 0;
+    NumRows = 0;
+    Codebooks.Empty();
+    Codes.Empty();
+    ReconstructionNorms.Empty();
+
+    // Codebooks trained on a handful of rows would just memorize them; wait for AddRow to bring more data
+    if (Storage.Num() < MinTrainingRows)
+    {
+        return;
+    }
+
+    SetDimension(Storage.GetDimension());
+    NumCentroids = MaxCentroids;
+
+    // Partial Fisher-Yates shuffle: the first NumSamples entries become a uniform random sample
+    const int32 NumStorageRows = Storage.Num();
+    const int32 NumSamples = FMath::Min(NumStorageRows, NumCentroids * TrainingRowsPerCentroid);
+
+    FRandomStream Random(TrainingSeed);
+    TArray<int32> Samples;
+    Samples.SetNumUninitialized(NumStorageRows);
+    for (int32 i = 0; i < NumStorageRows; ++i)
+    {
+        Samples[i] = i;
+    }
+    for (int32 i = 0; i < NumSamples; ++i)
+    {
+        Samples.Swap(i, Random.RandRange(i, NumStorageRows - 1));
+    }
+    Samples.SetNum(NumSamples, false);
+
+    Codebooks.SetNumUninitialized(NumCentroids * Dimension);
+
+    // Subspaces are independent k-means problems
+    ParallelFor(NumSubQuantizers, [this, &Storage, &Samples, NumSamples](int32 Sub)
+    {
+        const int32 SubOffset = GetSubOffset(Sub);
+        const int32 SubDimension = GetSubDimension(Sub);
+
+        TArray<float> SubVectors;
+        TArray<float> Scratch;
+        SubVectors.SetNumUninitialized(NumSamples * SubDimension);
+        for (int32 i = 0; i < NumSamples; ++i)
+        {
+            const float* Vector = Storage.GetRowAsFloat(Samples[i], Scratch);
+            FMemory::Memcpy(SubVectors.GetData() + static_cast<SIZE_T>(i) * SubDimension, Vector + SubOffset, SubDimension * sizeof(float));
+        }
+
+        // Seed with the first samples, which are already in random order
+        float* Centroids = Codebooks.GetData() + static_cast<SIZE_T>(NumCentroids) * SubOffset;
+        FMemory::Memcpy(Centroids, SubVectors.GetData(), static_cast<SIZE_T>(NumCentroids) * SubDimension * sizeof(float));
+
+        FRandomStream SubRandom(TrainingSeed + Sub);
+        TArray<double> Sums;
+        TArray<int32> Counts;
+        for (int32 Iteration = 0; Iteration < TrainingIterations; ++Iteration)
+        {
+            Sums.SetNumZeroed(NumCentroids * SubDimension);
+            Counts.SetNumZeroed(NumCentroids);
+
+            for (int32 i = 0; i < NumSamples; ++i)
+            {
+                const float* SubVector = SubVectors.GetData() + static_cast<SIZE_T>(i) * SubDimension;
+                const int32 Centroid = FindNearestCentroid(SubVector, Centroids, NumCentroids, SubDimension);
+
+                double* Sum = Sums.GetData() + static_cast<SIZE_T>(Centroid) * SubDimension;
+                for (int32 d = 0; d < SubDimension; ++d)
+                {
+                    Sum[d] += SubVector[d];
+                }
+                Counts[Centroid]++;
+            }
+
+            for (int32 Centroid = 0; Centroid < NumCentroids; ++Centroid)
+            {
+                float* Target = Centroids + static_cast<SIZE_T>(Centroid) * SubDimension;
+
+                if (Counts[Centroid] == 0)
+                {
+                    // Reseed empty cells from a random sample so every code stays useful
+                    const float* Reseed = SubVectors.GetData() + static_cast<SIZE_T>(SubRandom.RandHelper(NumSamples)) * SubDimension;
+                    FMemory::Memcpy(Target, Reseed, SubDimension * sizeof(float));
+                }
+                else
+                {
+                    const double* Sum = Sums.GetData() + static_cast<SIZE_T>(Centroid) * SubDimension;
+                    const double InvCount = 1.0 / Counts[Centroid];
+                    for (int32 d = 0; d < SubDimension; ++d)
+                    {
+                        Target[d] = static_cast<float>(Sum[d] * InvCount);
+                    }
+                }
+            }
+        }
+    });
+
+    // Encode every row with the new codebooks
+    NumRows = NumStorageRows;
+    Codes.SetNumUninitialized(NumRows * NumSubQuantizers);
+    if (Metric == EVectorDistanceMetric::Cosine)
+    {
+        ReconstructionNorms.SetNumUninitialized(NumRows);
+    }
+
+    ParallelFor(NumRows, [this, &Storage](int32 Row)
+    {
+        TArray<float> Scratch;
+        uint8* Code = Codes.GetData() + static_cast<SIZE_T>(Row) * NumSubQuantizers;
+        Encode(Storage.GetRowAsFloat(Row, Scratch), Code);
+        if (ReconstructionNorms.Num() > 0)
+        {
+            ReconstructionNorms[Row] = ComputeReconstructionNorm(Code);
+        }
+    });
+}
+
+void FVectorQuantizerPQ::SetDimension(int32 InDimension)
+{
+    Dimension = InDimension;
+    NumSubQuantizers = RequestedSubQuantizers > 0 ? FMath::Min(RequestedSubQuantizers, Dimension) : FMath::Max(Dimension / 16, 1);
+
+    // Spread the dimensions as evenly as possible when they do not divide exactly
+    SubOffsets.SetNumUninitialized(NumSubQuantizers + 1);
+    for (int32 Sub = 0; Sub <= NumSubQuantizers; ++Sub)
+    {
+        SubOffsets[Sub] = static_cast<int32>(static_cast<int64>(Sub) * Dimension / NumSubQuantizers);
+    }
+}
+
+void FVectorQuantizerPQ::Encode(const float* Vector, uint8* OutCode) const
+{
+    for (int32 Sub = 0; Sub < NumSubQuantizers; ++Sub)
+    {
+        const int32 SubDimension = GetSubDimension(Sub);
+        OutCode[Sub] = static_cast<uint8>(FindNearestCentroid(Vector + GetSubOffset(Sub), GetCentroid(Sub, 0), NumCentroids, SubDimension));
+    }
+}
+
+float FVectorQuantizerPQ::ComputeReconstructionNorm(const uint8* Code) const
+{
+    float SquaredNorm = 0.0f;
+    for (int32 Sub = 0; Sub < NumSubQuantizers; ++Sub)
+    {
+        const float* Centroid = GetCentroid(Sub, Code[Sub]);
+        for (int32 d = 0; d < GetSubDimension(Sub); ++d)
+        {
+            SquaredNorm += Centroid[d] * Centroid[d];
+        }
+    }
+    return FMath::Sqrt(SquaredNorm);
+}
+
+void FVectorQuantizerPQ::AddRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        if (Storage.Num() >= MinTrainingRows)
+        {
+            // Enough data has arrived to learn the codebooks
+            Train(Storage, Metric);
+        }
+        return;
+    }
+
+    check(Row == NumRows);
+
+    TArray<float> Scratch;
+    Codes.AddUninitialized(NumSubQuantizers);
+    uint8* Code = Codes.GetData() + static_cast<SIZE_T>(Row) * NumSubQuantizers;
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Code);
+    if (Metric == EVectorDistanceMetric::Cosine)
+    {
+        ReconstructionNorms.Add(ComputeReconstructionNorm(Code));
+    }
+    NumRows++;
+}
+
+void FVectorQuantizerPQ::UpdateRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(Row >= 0 && Row < NumRows);
+
+    TArray<float> Scratch;
+    uint8* Code = Codes.GetData() + static_cast<SIZE_T>(Row) * NumSubQuantizers;
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Code);
+    if (ReconstructionNorms.Num() > 0)
+    {
+        ReconstructionNorms[Row] = ComputeReconstructionNorm(Code);
+    }
+}
+
+void FVectorQuantizerPQ::Compact(TArrayView<const int32> RowRemap)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(RowRemap.Num() == NumRows);
+
+    // Surviving rows only ever move towards the front, so codes can be packed in place
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        if (RowRemap[Row] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        check(RowRemap[Row] == NumKept);
+        FMemory::Memmove(Codes.GetData() + static_cast<SIZE_T>(NumKept) * NumSubQuantizers, Codes.GetData() + static_cast<SIZE_T>(Row) * NumSubQuantizers, NumSubQuantizers);
+        if (ReconstructionNorms.Num() > 0)
+        {
+            ReconstructionNorms[NumKept] = ReconstructionNorms[Row];
+        }
+        NumKept++;
+    }
+
+    NumRows = NumKept;
+    Codes.SetNum(NumRows * NumSubQuantizers, false);
+    if (ReconstructionNorms.Num() > 0)
+    {
+        ReconstructionNorms.SetNum(NumRows, false);
+    }
+}
+
+void FVectorQuantizerPQ::BuildDistanceTable(const float* Query, TArray<float>& OutTable) const
+{
+    OutTable.SetNumUninitialized(NumSubQuantizers * NumCentroids);
+
+    for (int32 Sub = 0; Sub < NumSubQuantizers; ++Sub)
+    {
+        const float* SubQuery = Query + GetSubOffset(Sub);
+        const int32 SubDimension = GetSubDimension(Sub);
+        float* Table = OutTable.GetData() + static_cast<SIZE_T>(Sub) * NumCentroids;
+
+        for (int32 Centroid = 0; Centroid < NumCentroids; ++Centroid)
+        {
+            const float* C = GetCentroid(Sub, Centroid);
+
+            // Partial terms that sum across subspaces: squared L2, L1 or dot product
+            float Partial = 0.0f;
+            switch (Metric)
+            {
+                case EVectorDistanceMetric::Euclidean:
+                    Partial = SquaredDistance(SubQuery, C, SubDimension);
+                    break;
+
+                case EVectorDistanceMetric::Manhattan:
+                    for (int32 d = 0; d < SubDimension; ++d)
+                    {
+                        Partial += FMath::Abs(SubQuery[d] - C[d]);
+                    }
+                    break;
+
+                default:
+                    for (int32 d = 0; d < SubDimension; ++d)
+                    {
+                        Partial += SubQuery[d] * C[d];
+                    }
+                    break;
+            }
+
+            Table[Centroid] = Partial;
+        }
+    }
+}
+
+TUniquePtr<FVectorQuantizerQuery> FVectorQuantizerPQ::PrepareQuery(const float* Query) const
+{
+    check(IsTrained());
+
+    TUniquePtr<FQuery> PreparedQuery = MakeUnique<FQuery>();
+    PreparedQuery->bHigherIsBetter = bHigherIsBetter;
+    BuildDistanceTable(Query, PreparedQuery->Table);
+
+    if (Metric == EVectorDistanceMetric::Cosine)
+    {
+        float QueryNorm = 0.0f;
+        for (int32 d = 0; d < Dimension; ++d)
+        {
+            QueryNorm += Query[d] * Query[d];
+        }
+        PreparedQuery->Norm = FMath::Sqrt(QueryNorm);
+    }
+    return PreparedQuery;
+}
+
+void FVectorQuantizerPQ::ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const
+{
+    const FQuery& Query = static_cast<const FQuery&>(PreparedQuery);
+    const float QueryNorm = Query.Norm;
+
+    for (int32 Row = FirstRow; Row < EndRow; ++Row)
+    {
+        if (!Filter(Row))
+        {
+            continue;
+        }
+
+        const uint8* Code = Codes.GetData() + static_cast<SIZE_T>(Row) * NumSubQuantizers;
+        const float* Table0 = Query.Table.GetData();
+
+        float Sum = 0.0f;
+        for (int32 Sub = 0; Sub < NumSubQuantizers; ++Sub)
+        {
+            Sum += Table0[Code[Sub]];
+            Table0 += NumCentroids;
+        }
+
+        switch (Metric)
+        {
+            case EVectorDistanceMetric::Euclidean:
+                Sum = FMath::Sqrt(Sum);
+                break;
+
+            case EVectorDistanceMetric::Cosine:
+            {
+                const float Norms = QueryNorm * ReconstructionNorms[Row];
+                Sum = Norms > 0.0f ? Sum / Norms : 0.0f;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        TopK.Add(Row, Sum);
+    }
+
+}
+
+void FVectorQuantizerPQ::Serialize(FArchive& Ar, const FVectorStorage& Storage)
+{
+    // Subspace boundaries follow from the dimension and the requested sub-quantizers, so they are not saved
+    int32 SavedSubQuantizers = RequestedSubQuantizers;
+    int32 SavedDimension = Dimension;
+    Ar << SavedSubQuantizers;
+    Ar << Metric;
+    Ar << NumCentroids;
+    Ar << SavedDimension;
+    Ar << NumRows;
+
+    if (Ar.IsLoading())
+    {
+        bHigherIsBetter = VectorDistance::IsSimilarityMetric(Metric);
+        if (Ar.IsError() || SavedSubQuantizers != RequestedSubQuantizers || NumCentroids != MaxCentroids
+            || SavedDimension != Storage.GetDimension() || NumRows != Storage.Num())
+        {
+            Ar.SetError();
+            NumCentroids = 0;
+            NumRows = 0;
+            return;
+        }
+        SetDimension(SavedDimension);
+    }
+
+    Codebooks.BulkSerialize(Ar);
+    Codes.BulkSerialize(Ar);
+    ReconstructionNorms.BulkSerialize(Ar);
+
+    // Every byte is a valid code with 256 centroids, so only the sizes need checking
+    if (Ar.IsLoading() && (Ar.IsError() || Codebooks.Num() != NumCentroids * Dimension || Codes.Num() != NumRows * NumSubQuantizers
+        || ReconstructionNorms.Num() != (Metric == EVectorDistanceMetric::Cosine ? NumRows : 0)))
+    {
+        Ar.SetError();
+        NumCentroids = 0;
+        NumRows = 0;
+        Codebooks.Empty();
+        Codes.Empty();
+        ReconstructionNorms.Empty();
+    }
+}
+
+SIZE_T FVectorQuantizerPQ::GetAllocatedSize() const
+{
+    return SubOffsets.GetAllocatedSize() + Codebooks.GetAllocatedSize() + Codes.GetAllocatedSize() + ReconstructionNorms.GetAllocatedSize();
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorQuantizer.h"
+#include "VectorDatabaseTypes.h"
+
+/**
+ * Product quantizer with 8-bit codes.
+ * The vector is split into NumSubQuantizers contiguous sub-vectors, each encoded as the index of its nearest
+ * centroid in a per-subspace codebook of up to 256 entries. Queries build an asymmetric distance (ADC) table
+ * holding the partial score of every centroid, so scoring a row is NumSubQuantizers table lookups.
+ */
+class FVectorQuantizerPQ : public IVectorQuantizer
+{
+public:
+    /** InNumSubQuantizers of 0 picks one sub-quantizer per 16 dimensions */
+    explicit FVectorQuantizerPQ(int32 InNumSubQuantizers);
+
+    //~ Begin IVectorQuantizer Interface
+    virtual void Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric) override;
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void Compact(TArrayView<const int32> RowRemap) override;
+    virtual TUniquePtr<FVectorQuantizerQuery> PrepareQuery(const float* Query) const override;
+    virtual void ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const override;
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) override;
+    virtual bool IsTrained() const override { return NumCentroids > 0; }
+    virtual int32 Num() const override { return NumRows; }
+    virtual SIZE_T GetAllocatedSize() const override;
+    //~ End IVectorQuantizer Interface
+
+private:
+    /** Distance table of a query, NumCentroids entries per subspace, and its norm for Cosine */
+    class FQuery : public FVectorQuantizerQuery
+    {
+    public:
+        TArray<float> Table;
+
+        float Norm = 0.0f;
+    };
+
+    /** Maximum centroids per subspace (8-bit codes) */
+    static constexpr int32 MaxCentroids = 256;
+
+    /** Training rows sampled per centroid */
+    static constexpr int32 TrainingRowsPerCentroid = 32;
+
+    /** Rows needed before training is attempted from AddRow */
+    static constexpr int32 MinTrainingRows = MaxCentroids * 4;
+
+    /** Number of Lloyd iterations per subspace */
+    static constexpr int32 TrainingIterations = 12;
+
+    /** Seed for training sample selection so builds are reproducible */
+    static constexpr int32 TrainingSeed = 0x50515A31;
+
+    /** Set the dimension and split it into subspaces */
+    void SetDimension(int32 InDimension);
+
+    /** Get the first dimension of a subspace */
+    int32 GetSubOffset(int32 Sub) const { return SubOffsets[Sub]; }
+
+    /** Get the number of dimensions in a subspace */
+    int32 GetSubDimension(int32 Sub) const { return SubOffsets[Sub + 1] - SubOffsets[Sub]; }
+
+    /** Get a centroid of a subspace */
+    const float* GetCentroid(int32 Sub, int32 Centroid) const
+    {
+        return Codebooks.GetData() + static_cast<SIZE_T>(NumCentroids) * SubOffsets[Sub] + static_cast<SIZE_T>(Centroid) * GetSubDimension(Sub);
+    }
+
+    /** Write the code of a vector into OutCode (NumSubQuantizers bytes) */
+    void Encode(const float* Vector, uint8* OutCode) const;
+
+    /** Get the norm of the vector a code decodes to */
+    float ComputeReconstructionNorm(const uint8* Code) const;
+
+    /** Fill the ADC table: partial score of every centroid of every subspace against the query */
+    void BuildDistanceTable(const float* Query, TArray<float>& OutTable) const;
+
+    int32 RequestedSubQuantizers;
+
+    int32 NumSubQuantizers;
+
+    int32 NumCentroids;
+
+    int32 Dimension;
+
+    EVectorDistanceMetric Metric;
+
+    bool bHigherIsBetter;
+
+    /** Subspace boundaries, NumSubQuantizers + 1 entries */
+    TArray<int32> SubOffsets;
+
+    /** Centroids of every subspace, subspace-major */
+    TArray<float> Codebooks;
+
+    /** One code of NumSubQuantizers bytes per row */
+    TArray<uint8> Codes;
+
+    /** Norm of every row's reconstruction, only kept for the Cosine metric */
+    TArray<float> ReconstructionNorms;
+
+    int32 NumRows;
+};
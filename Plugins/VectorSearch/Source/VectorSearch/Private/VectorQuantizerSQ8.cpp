@@ -0,0 +1,304 @@
+#include "VectorQuantizerSQ8.h"
+#include "VectorDistanceKernels.h"
+#include "Async/ParallelFor.h"
+
+FVectorQuantizerSQ8::FVectorQuantizerSQ8()
+    : Dimension(0),
+      Metric(EVectorDistanceMetric::Euclidean),
+      bHigherIsBetter(false),
+      NumRows(0)
+{
+}
+
+void FVectorQuantizerSQ8::Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric)
+{
+    Metric = InMetric;
+    bHigherIsBetter = VectorDistance::IsSimilarityMetric(InMetric);
+
+    Dimension = 0;
+    NumRows = 0;
+    Mins.Empty();
+    Scales.Empty();
+    Codes.Empty();
+    ReconstructionNorms.Empty();
+
+    // Ranges learned from a handful of rows would clamp most later ones; wait for AddRow to bring more data
+    if (Storage.Num() < MinTrainingRows)
+    {
+        return;
+    }
+
+    const int32 StorageDimension = Storage.GetDimension();
+
+    TArray<float> Maxs;
+    Mins.Init(TNumericLimits<float>::Max(), StorageDimension);
+    Maxs.Init(TNumericLimits<float>::Lowest(), StorageDimension);
+    TArray<float> Scratch;
+    for (int32 Row = 0; Row < Storage.Num(); ++Row)
+    {
+        const float* Vector = Storage.GetRowAsFloat(Row, Scratch);
+        for (int32 d = 0; d < StorageDimension; ++d)
+        {
+            Mins[d] = FMath::Min(Mins[d], Vector[d]);
+            Maxs[d] = FMath::Max(Maxs[d], Vector[d]);
+        }
+    }
+
+    Scales.SetNumUninitialized(StorageDimension);
+    for (int32 d = 0; d < StorageDimension; ++d)
+    {
+        Scales[d] = (Maxs[d] - Mins[d]) / MaxCode;
+    }
+
+    Dimension = StorageDimension;
+    NumRows = Storage.Num();
+    Codes.SetNumUninitialized(static_cast<int64>(NumRows) * Dimension);
+    if (Metric == EVectorDistanceMetric::Cosine)
+    {
+        ReconstructionNorms.SetNumUninitialized(NumRows);
+    }
+
+    ParallelFor(NumRows, [this, &Storage](int32 Row)
+    {
+        TArray<float> RowScratch;
+        uint8* Code = Codes.GetData() + static_cast<int64>(Row) * Dimension;
+        Encode(Storage.GetRowAsFloat(Row, RowScratch), Code);
+        if (ReconstructionNorms.Num() > 0)
+        {
+            ReconstructionNorms[Row] = ComputeReconstructionNorm(Code);
+        }
+    });
+}
+
+void FVectorQuantizerSQ8::Encode(const float* Vector, uint8* OutCode) const
+{
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        const float Level = Scales[d] > 0.0f ? (Vector[d] - Mins[d]) / Scales[d] : 0.0f;
+        OutCode[d] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Level), 0, 255));
+    }
+}
+
+float FVectorQuantizerSQ8::ComputeReconstructionNorm(const uint8* Code) const
+{
+    float SquaredNorm = 0.0f;
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        const float Value = Mins[d] + Scales[d] * Code[d];
+        SquaredNorm += Value * Value;
+    }
+    return FMath::Sqrt(SquaredNorm);
+}
+
+void FVectorQuantizerSQ8::AddRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        if (Storage.Num() >= MinTrainingRows)
+        {
+            // Enough data has arrived to learn the value ranges
+            Train(Storage, Metric);
+        }
+        return;
+    }
+
+    check(Row == NumRows);
+
+    TArray<float> Scratch;
+    Codes.AddUninitialized(Dimension);
+    uint8* Code = Codes.GetData() + static_cast<int64>(Row) * Dimension;
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Code);
+    if (Metric == EVectorDistanceMetric::Cosine)
+    {
+        ReconstructionNorms.Add(ComputeReconstructionNorm(Code));
+    }
+    NumRows++;
+}
+
+void FVectorQuantizerSQ8::UpdateRow(const FVectorStorage& Storage, int32 Row)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(Row >= 0 && Row < NumRows);
+
+    TArray<float> Scratch;
+    uint8* Code = Codes.GetData() + static_cast<int64>(Row) * Dimension;
+    Encode(Storage.GetRowAsFloat(Row, Scratch), Code);
+    if (ReconstructionNorms.Num() > 0)
+    {
+        ReconstructionNorms[Row] = ComputeReconstructionNorm(Code);
+    }
+}
+
+void FVectorQuantizerSQ8::Compact(TArrayView<const int32> RowRemap)
+{
+    if (!IsTrained())
+    {
+        return;
+    }
+
+    check(RowRemap.Num() == NumRows);
+
+    // Surviving rows only ever move towards the front, so codes can be packed in place
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        if (RowRemap[Row] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        check(RowRemap[Row] == NumKept);
+        FMemory::Memmove(Codes.GetData() + static_cast<int64>(NumKept) * Dimension, Codes.GetData() + static_cast<int64>(Row) * Dimension, Dimension);
+        if (ReconstructionNorms.Num() > 0)
+        {
+            ReconstructionNorms[NumKept] = ReconstructionNorms[Row];
+        }
+        NumKept++;
+    }
+
+    NumRows = NumKept;
+    Codes.SetNum(static_cast<int64>(NumRows) * Dimension, false);
+    if (ReconstructionNorms.Num() > 0)
+    {
+        ReconstructionNorms.SetNum(NumRows, false);
+    }
+}
+
+TUniquePtr<FVectorQuantizerQuery> FVectorQuantizerSQ8::PrepareQuery(const float* Query) const
+{
+    check(IsTrained());
+
+    // Decoded value is Mins[d] + Scales[d] * Code[d]. Fold that into per-query weights and offsets
+    // so the kernel works on raw bytes; constant dimensions only contribute to Base.
+    TUniquePtr<FQuery> PreparedQuery = MakeUnique<FQuery>();
+    PreparedQuery->bHigherIsBetter = bHigherIsBetter;
+    TArray<float>& Offsets = PreparedQuery->Offsets;
+    TArray<float>& Weights = PreparedQuery->Weights;
+    Offsets.SetNumUninitialized(Dimension);
+    Weights.SetNumUninitialized(Dimension);
+
+    float Base = 0.0f;
+    float QueryNorm = 0.0f;
+    for (int32 d = 0; d < Dimension; ++d)
+    {
+        const float Delta = Query[d] - Mins[d];
+        QueryNorm += Query[d] * Query[d];
+
+        switch (Metric)
+        {
+            case EVectorDistanceMetric::Euclidean:
+            case EVectorDistanceMetric::Manhattan:
+                if (Scales[d] > 0.0f)
+                {
+                    Offsets[d] = Delta / Scales[d];
+                    Weights[d] = Metric == EVectorDistanceMetric::Euclidean ? Scales[d] * Scales[d] : Scales[d];
+                }
+                else
+                {
+                    Offsets[d] = 0.0f;
+                    Weights[d] = 0.0f;
+                    Base += Metric == EVectorDistanceMetric::Euclidean ? Delta * Delta : FMath::Abs(Delta);
+                }
+                break;
+
+            default:
+                Offsets[d] = 0.0f;
+                Weights[d] = Query[d] * Scales[d];
+                Base += Query[d] * Mins[d];
+                break;
+        }
+    }
+    PreparedQuery->Base = Base;
+    PreparedQuery->Norm = FMath::Sqrt(QueryNorm);
+    return PreparedQuery;
+}
+
+void FVectorQuantizerSQ8::ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const
+{
+    const FQuery& Query = static_cast<const FQuery&>(PreparedQuery);
+    const float* Offsets = Query.Offsets.GetData();
+    const float* Weights = Query.Weights.GetData();
+    const float Base = Query.Base;
+    const float QueryNorm = Query.Norm;
+    const FVectorCodeKernel& CodeKernel = VectorDistance::GetCodeKernel();
+
+    for (int32 Row = FirstRow; Row < EndRow; ++Row)
+    {
+        if (!Filter(Row))
+        {
+            continue;
+        }
+
+        const uint8* Code = Codes.GetData() + static_cast<int64>(Row) * Dimension;
+
+        float Score;
+        switch (Metric)
+        {
+            case EVectorDistanceMetric::Euclidean:
+                Score = FMath::Sqrt(Base + CodeKernel.SquaredL2(Offsets, Weights, Code, Dimension));
+                break;
+
+            case EVectorDistanceMetric::Manhattan:
+                Score = Base + CodeKernel.L1(Offsets, Weights, Code, Dimension);
+                break;
+
+            case EVectorDistanceMetric::Cosine:
+            {
+                const float Norms = QueryNorm * ReconstructionNorms[Row];
+                Score = Norms > 0.0f ? (Base + CodeKernel.Dot(Weights, Code, Dimension)) / Norms : 0.0f;
+                break;
+            }
+
+            default:
+                Score = Base + CodeKernel.Dot(Weights, Code, Dimension);
+                break;
+        }
+
+        TopK.Add(Row, Score);
+    }
+}
+
+void FVectorQuantizerSQ8::Serialize(FArchive& Ar, const FVectorStorage& Storage)
+{
+    Ar << Metric;
+    Ar << Dimension;
+    Ar << NumRows;
+
+    if (Ar.IsLoading())
+    {
+        bHigherIsBetter = VectorDistance::IsSimilarityMetric(Metric);
+        if (Ar.IsError() || Dimension == 0 || Dimension != Storage.GetDimension() || NumRows != Storage.Num())
+        {
+            Ar.SetError();
+            Dimension = 0;
+            NumRows = 0;
+            return;
+        }
+    }
+
+    Mins.BulkSerialize(Ar);
+    Scales.BulkSerialize(Ar);
+    Codes.BulkSerialize(Ar);
+    ReconstructionNorms.BulkSerialize(Ar);
+
+    if (Ar.IsLoading() && (Ar.IsError() || Mins.Num() != Dimension || Scales.Num() != Dimension || Codes.Num() != static_cast<int64>(NumRows) * Dimension
+        || ReconstructionNorms.Num() != (Metric == EVectorDistanceMetric::Cosine ? NumRows : 0)))
+    {
+        Ar.SetError();
+        Dimension = 0;
+        NumRows = 0;
+        Mins.Empty();
+        Scales.Empty();
+        Codes.Empty();
+        ReconstructionNorms.Empty();
+    }
+}
+
+SIZE_T FVectorQuantizerSQ8::GetAllocatedSize() const
+{
+    return Mins.GetAllocatedSize() + Scales.GetAllocatedSize() + Codes.GetAllocatedSize() + ReconstructionNorms.GetAllocatedSize();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorQuantizer.h"
+#include "VectorDatabaseTypes.h"
+
+/**
+ * Scalar quantizer with one byte per dimension.
+ * Every dimension is mapped linearly from its trained [min, max] range onto 0..255. Queries fold the
+ * per-dimension decode into weights and offsets so rows are scored straight from their bytes.
+ * The codes sit next to the database's full-precision rows, which the rescoring pass reads; with the rows moved to a
+ * mapped file (UVectorDatabase::MoveVectorsToFile) the codes are all that stays in memory, a quarter of float32 rows.
+ */
+class FVectorQuantizerSQ8 : public IVectorQuantizer
+{
+public:
+    FVectorQuantizerSQ8();
+
+    //~ Begin IVectorQuantizer Interface
+    virtual void Train(const FVectorStorage& Storage, EVectorDistanceMetric InMetric) override;
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) override;
+    virtual void Compact(TArrayView<const int32> RowRemap) override;
+    virtual TUniquePtr<FVectorQuantizerQuery> PrepareQuery(const float* Query) const override;
+    virtual void ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const override;
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) override;
+    virtual bool IsTrained() const override { return Dimension > 0; }
+    virtual int32 Num() const override { return NumRows; }
+    virtual SIZE_T GetAllocatedSize() const override;
+    //~ End IVectorQuantizer Interface
+
+private:
+    /** Per-dimension weights and offsets a query folds the decode into, plus what constant dimensions contribute */
+    class FQuery : public FVectorQuantizerQuery
+    {
+    public:
+        TArray<float> Offsets;
+
+        TArray<float> Weights;
+
+        float Base = 0.0f;
+
+        float Norm = 0.0f;
+    };
+
+    /** Rows needed before the value ranges are learned; later rows outside them are clamped */
+    static constexpr int32 MinTrainingRows = 256;
+
+    /** Largest code value */
+    static constexpr float MaxCode = 255.0f;
+
+    /** Write the code of a vector into OutCode (Dimension bytes) */
+    void Encode(const float* Vector, uint8* OutCode) const;
+
+    /** Get the norm of the vector a code decodes to */
+    float ComputeReconstructionNorm(const uint8* Code) const;
+
+    int32 Dimension;
+
+    EVectorDistanceMetric Metric;
+
+    bool bHigherIsBetter;
+
+    /** Lower bound of every dimension */
+    TArray<float> Mins;
+
+    /** Value of one code step for every dimension, zero for constant dimensions */
+    TArray<float> Scales;
+
+    /** One code of Dimension bytes per row */
+    TArray64<uint8> Codes;
+
+    /** Norm of every row's reconstruction, only kept for the Cosine metric */
+    TArray<float> ReconstructionNorms;
+
+    int32 NumRows;
+};
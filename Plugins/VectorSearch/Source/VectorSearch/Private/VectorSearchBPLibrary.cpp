@@ -1,6 +1,7 @@
 #include "VectorSearchBPLibrary.h"
 #include "VectorSearch.h"
 #include "VectorSearchTypes.h"
+#include "VectorDatabaseFile.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "UObject/SavePackage.h"
 
@@ -9,57 +10,86 @@ UVectorDatabase* UVectorSearchBPLibrary::CreateVectorDatabase()
     return NewObject<UVectorDatabase>();
 }
 
-void UVectorSearchBPLibrary::AddStringEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, FString Entry, FString Category)
+int64 UVectorSearchBPLibrary::AddStringEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, FString Entry, FString Category)
 {
     if (Database)
     {
-        UVectorEntryWrapper* Wrapper = NewObject<UVectorEntryWrapper>();
-        Wrapper->StringValue = Entry;
-        Wrapper->EntryType = EEntryType::String;
-        Database->AddEntry(Vector, Wrapper, Category);
+        return Database->AddStringEntry(Vector, Entry, Category);
     }
+    return INDEX_NONE;
 }
 
-void UVectorSearchBPLibrary::AddObjectEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, UObject* Entry, FString Category)
+int64 UVectorSearchBPLibrary::AddObjectEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, UObject* Entry, FString Category)
 {
     if (Database && Entry)
     {
-        UVectorEntryWrapper* Wrapper = NewObject<UVectorEntryWrapper>();
-        Wrapper->ObjectValue = Entry;
-        Wrapper->EntryType = EEntryType::Object;
-        Database->AddEntry(Vector, Wrapper, Category);
+        return Database->AddObjectEntry(Vector, Entry, Category);
     }
+    return INDEX_NONE;
+}
+
+TArray<int64> UVectorSearchBPLibrary::AddStringEntriesToVectorDatabase(UVectorDatabase* Database, const TArray<float>& PackedVectors, const TArray<FString>& Entries, const TArray<FString>& Categories)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddStringEntriesToVectorDatabase: Invalid Database"));
+        return TArray<int64>();
+    }
+
+    if (Entries.Num() == 0)
+    {
+        return TArray<int64>();
+    }
+
+    if (PackedVectors.Num() % Entries.Num() != 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddStringEntriesToVectorDatabase: %d packed values do not split evenly into %d vectors"), PackedVectors.Num(), Entries.Num());
+        return TArray<int64>();
+    }
+
+    // Created inside the database so adding them does not need a Rename each
+    return Database->AddStringEntriesBulk(PackedVectors, PackedVectors.Num() / Entries.Num(), Entries, Categories);
+}
+
+TArray<int64> UVectorSearchBPLibrary::AddObjectEntriesToVectorDatabase(UVectorDatabase* Database, const TArray<float>& PackedVectors, const TArray<UObject*>& Entries, const TArray<FString>& Categories)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddObjectEntriesToVectorDatabase: Invalid Database"));
+        return TArray<int64>();
+    }
+
+    if (Entries.Num() == 0)
+    {
+        return TArray<int64>();
+    }
+
+    if (PackedVectors.Num() % Entries.Num() != 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddObjectEntriesToVectorDatabase: %d packed values do not split evenly into %d vectors"), PackedVectors.Num(), Entries.Num());
+        return TArray<int64>();
+    }
+
+    // Null objects keep their slot and come back as INDEX_NONE
+    return Database->AddObjectEntriesBulk(PackedVectors, PackedVectors.Num() / Entries.Num(), Entries, Categories);
 }
 
 TArray<FString> UVectorSearchBPLibrary::GetTopNStringMatches(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories)
 {
-    TArray<FString> Results;
     if (Database)
     {
-        TArray<UVectorEntryWrapper*> Matches = Database->GetTopNMatches(QueryVector, N, EEntryType::String, Categories);
-        for (UVectorEntryWrapper* Match : Matches)
-        {
-            Results.Add(Match->StringValue);
-        }
+        return Database->GetTopNStringMatches(QueryVector, N, Categories);
     }
-    return Results;
+    return TArray<FString>();
 }
 
 TArray<UObject*> UVectorSearchBPLibrary::GetTopNObjectMatches(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories)
 {
-    TArray<UObject*> Results;
     if (Database)
     {
-        TArray<UVectorEntryWrapper*> Matches = Database->GetTopNMatches(QueryVector, N, EEntryType::Object, Categories);
-        for (UVectorEntryWrapper* Match : Matches)
-        {
-            if (Match->ObjectValue)
-            {
-                Results.Add(Match->ObjectValue);
-            }
-        }
+        return Database->GetTopNObjectMatches(QueryVector, N, Categories);
     }
-    return Results;
+    return TArray<UObject*>();
 }
 
 void UVectorSearchBPLibrary::DeepCopyStruct(UScriptStruct* StructType, void* Dest, const void* Src)
@@ -170,6 +200,7 @@ DEFINE_FUNCTION(UVectorSearchBPLibrary::execAddStructEntryToVectorDatabase)
 
 
     P_NATIVE_BEGIN;
+    int64 Handle = INDEX_NONE;
     if (StructProperty)
     {
         TUniquePtr<uint8[]> NewStructInstance(new uint8[StructProperty->Struct->GetStructureSize()]);
@@ -180,10 +211,7 @@ DEFINE_FUNCTION(UVectorSearchBPLibrary::execAddStructEntryToVectorDatabase)
 
             if (Database)
             {
-                UVectorEntryWrapper* Wrapper = NewObject<UVectorEntryWrapper>();
-                Wrapper->SetStructData(StructProperty->Struct, NewStructInstance.Get());
-                Wrapper->EntryType = EEntryType::Struct;
-                Database->AddEntry(Vector, Wrapper, Category);
+                Handle = Database->AddStructEntry(Vector, StructProperty->Struct, NewStructInstance.Get(), Category);
             }
         }
         else
@@ -191,6 +219,7 @@ DEFINE_FUNCTION(UVectorSearchBPLibrary::execAddStructEntryToVectorDatabase)
             UE_LOG(LogTemp, Error, TEXT("Failed to allocate memory for new struct instance"));
         }
     }
+    *(int64*)RESULT_PARAM = Handle;
     P_NATIVE_END;
 }
 
@@ -296,6 +325,61 @@ bool UVectorSearchBPLibrary::RemoveEntryFromVectorDatabase(UVectorDatabase* Data
     return false;
 }
 
+bool UVectorSearchBPLibrary::RemoveEntryFromVectorDatabaseByHandle(UVectorDatabase* Database, int64 Handle)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RemoveEntryFromVectorDatabaseByHandle: Invalid Database"));
+        return false;
+    }
+
+    return Database->RemoveEntryByHandle(Handle);
+}
+
+bool UVectorSearchBPLibrary::UpdateVectorDatabaseEntryVector(UVectorDatabase* Database, int64 Handle, const TArray<float>& Vector)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("UpdateVectorDatabaseEntryVector: Invalid Database"));
+        return false;
+    }
+
+    return Database->UpdateEntryVector(Handle, Vector);
+}
+
+int32 UVectorSearchBPLibrary::UpdateVectorDatabaseEntryVectors(UVectorDatabase* Database, const TArray<FVectorEntryUpdate>& Updates)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("UpdateVectorDatabaseEntryVectors: Invalid Database"));
+        return 0;
+    }
+
+    return Database->UpdateEntryVectors(Updates);
+}
+
+bool UVectorSearchBPLibrary::VectorDatabaseContainsHandle(UVectorDatabase* Database, int64 Handle)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VectorDatabaseContainsHandle: Invalid Database"));
+        return false;
+    }
+
+    return Database->ContainsHandle(Handle);
+}
+
+bool UVectorSearchBPLibrary::SetVectorDatabaseEntryMetadata(UVectorDatabase* Database, int64 Handle, const TMap<FString, FString>& Metadata)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseEntryMetadata: Invalid Database"));
+        return false;
+    }
+
+    return Database->SetEntryMetadata(Handle, Metadata);
+}
+
 TArray<FVectorDatabaseEntry> UVectorSearchBPLibrary::GetTopNEntriesWithDetails(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories)
 {
     if (Database)
@@ -305,6 +389,35 @@ TArray<FVectorDatabaseEntry> UVectorSearchBPLibrary::GetTopNEntriesWithDetails(U
     return TArray<FVectorDatabaseEntry>();
 }
 
+TArray<FVectorDatabaseEntry> UVectorSearchBPLibrary::GetTopNEntriesFiltered(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const FVectorSearchFilter& Filter)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetTopNEntriesFiltered: Invalid Database"));
+        return TArray<FVectorDatabaseEntry>();
+    }
+
+    return Database->GetTopNEntriesFiltered(QueryVector, N, Filter);
+}
+
+TArray<FVectorSearchQueryResult> UVectorSearchBPLibrary::GetTopNMatchesBatch(UVectorDatabase* Database, const TArray<FVectorSearchQuery>& Queries, int32 N, const TArray<FString>& Categories)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetTopNMatchesBatch: Invalid Database"));
+        return TArray<FVectorSearchQueryResult>();
+    }
+
+    TArray<TArray<float>> QueryVectors;
+    QueryVectors.Reserve(Queries.Num());
+    for (const FVectorSearchQuery& Query : Queries)
+    {
+        QueryVectors.Add(Query.Vector);
+    }
+
+    return Database->GetTopNMatchesBatch(QueryVectors, N, Categories);
+}
+
 DEFINE_FUNCTION(UVectorSearchBPLibrary::execGetStructFromVectorDatabaseEntry)
 {
     P_GET_STRUCT_REF(FVectorDatabaseEntry, Entry);
@@ -429,6 +542,31 @@ bool UVectorSearchBPLibrary::LoadVectorDatabaseFromFile(UVectorDatabaseAsset* As
     return Asset->LoadFromFile(FilePath);
 }
 
+bool UVectorSearchBPLibrary::ExportVectorDatabaseToJsonFile(UVectorDatabaseAsset* Asset, const FString& FilePath)
+{
+    if (!Asset)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ExportVectorDatabaseToJsonFile: Invalid Asset"));
+        return false;
+    }
+
+    return Asset->ExportToJsonFile(FilePath);
+}
+
+UVectorDatabase* UVectorSearchBPLibrary::OpenVectorDatabaseFileMapped(const FString& FilePath)
+{
+    FVectorDatabaseFileContents Contents;
+    if (!VectorDatabaseFile::LoadMapped(FilePath, Contents))
+    {
+        UE_LOG(LogTemp, Error, TEXT("OpenVectorDatabaseFileMapped: Failed to open %s"), *FilePath);
+        return nullptr;
+    }
+
+    UVectorDatabase* Database = NewObject<UVectorDatabase>();
+    Database->ResetFromFileContents(Contents);
+    return Database;
+}
+
 TArray<FString> UVectorSearchBPLibrary::GetUniqueCategoriesFromDatabase(UVectorDatabase* Database)
 {
     if (!Database)
@@ -539,6 +677,17 @@ void UVectorSearchBPLibrary::NormalizeVectorsInDatabase(UVectorDatabase* Databas
     Database->NormalizeVectors();
 }
 
+bool UVectorSearchBPLibrary::AreVectorDatabaseVectorsNormalized(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AreVectorDatabaseVectorsNormalized: Invalid Database"));
+        return false;
+    }
+
+    return Database->AreVectorsNormalized();
+}
+
 FVectorDatabaseStats UVectorSearchBPLibrary::GetVectorDatabaseStats(UVectorDatabase* Database)
 {
     if (!Database)
@@ -550,6 +699,237 @@ FVectorDatabaseStats UVectorSearchBPLibrary::GetVectorDatabaseStats(UVectorDatab
     return Database->GetDatabaseStats();
 }
 
+void UVectorSearchBPLibrary::SetVectorDatabaseStoragePrecision(UVectorDatabase* Database, EVectorStoragePrecision Precision)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseStoragePrecision: Invalid Database"));
+        return;
+    }
+
+    Database->SetStoragePrecision(Precision);
+}
+
+EVectorStoragePrecision UVectorSearchBPLibrary::GetVectorDatabaseStoragePrecision(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetVectorDatabaseStoragePrecision: Invalid Database"));
+        return EVectorStoragePrecision::Float32;
+    }
+
+    return Database->GetStoragePrecision();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabaseIndexSettings(UVectorDatabase* Database, const FVectorIndexSettings& Settings)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseIndexSettings: Invalid Database"));
+        return;
+    }
+
+    Database->SetIndexSettings(Settings);
+}
+
+FVectorIndexSettings UVectorSearchBPLibrary::GetVectorDatabaseIndexSettings(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetVectorDatabaseIndexSettings: Invalid Database"));
+        return FVectorIndexSettings();
+    }
+
+    return Database->GetIndexSettings();
+}
+
+void UVectorSearchBPLibrary::RebuildVectorDatabaseIndex(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RebuildVectorDatabaseIndex: Invalid Database"));
+        return;
+    }
+
+    Database->RebuildIndex();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabaseQuantizationSettings(UVectorDatabase* Database, const FVectorQuantizationSettings& Settings)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseQuantizationSettings: Invalid Database"));
+        return;
+    }
+
+    Database->SetQuantizationSettings(Settings);
+}
+
+FVectorQuantizationSettings UVectorSearchBPLibrary::GetVectorDatabaseQuantizationSettings(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetVectorDatabaseQuantizationSettings: Invalid Database"));
+        return FVectorQuantizationSettings();
+    }
+
+    return Database->GetQuantizationSettings();
+}
+
+void UVectorSearchBPLibrary::RetrainVectorDatabaseQuantizer(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RetrainVectorDatabaseQuantizer: Invalid Database"));
+        return;
+    }
+
+    Database->RetrainQuantizer();
+}
+
+bool UVectorSearchBPLibrary::MoveVectorDatabaseVectorsToFile(UVectorDatabase* Database, const FString& FilePath)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("MoveVectorDatabaseVectorsToFile: Invalid Database"));
+        return false;
+    }
+
+    return Database->MoveVectorsToFile(FilePath);
+}
+
+void UVectorSearchBPLibrary::RebuildVectorDatabaseMetadataIndex(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RebuildVectorDatabaseMetadataIndex: Invalid Database"));
+        return;
+    }
+
+    Database->RebuildMetadataIndex();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabasePartitioned(UVectorDatabase* Database, bool bPartitioned)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabasePartitioned: Invalid Database"));
+        return;
+    }
+
+    Database->SetPartitioned(bPartitioned);
+}
+
+bool UVectorSearchBPLibrary::IsVectorDatabasePartitioned(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("IsVectorDatabasePartitioned: Invalid Database"));
+        return false;
+    }
+
+    return Database->IsPartitioned();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabaseMinRowsPerScanChunk(UVectorDatabase* Database, int32 MinRows)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseMinRowsPerScanChunk: Invalid Database"));
+        return;
+    }
+
+    Database->SetMinRowsPerScanChunk(MinRows);
+}
+
+int32 UVectorSearchBPLibrary::GetVectorDatabaseMinRowsPerScanChunk(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetVectorDatabaseMinRowsPerScanChunk: Invalid Database"));
+        return 0;
+    }
+
+    return Database->GetMinRowsPerScanChunk();
+}
+
+void UVectorSearchBPLibrary::CompactVectorDatabase(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("CompactVectorDatabase: Invalid Database"));
+        return;
+    }
+
+    Database->Compact();
+}
+
+bool UVectorSearchBPLibrary::CompactVectorDatabaseIfNeeded(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("CompactVectorDatabaseIfNeeded: Invalid Database"));
+        return false;
+    }
+
+    return Database->CompactIfNeeded();
+}
+
+bool UVectorSearchBPLibrary::DoesVectorDatabaseNeedCompaction(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("DoesVectorDatabaseNeedCompaction: Invalid Database"));
+        return false;
+    }
+
+    return Database->NeedsCompaction();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabaseCompactionThreshold(UVectorDatabase* Database, float Threshold)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseCompactionThreshold: Invalid Database"));
+        return;
+    }
+
+    Database->SetCompactionThreshold(Threshold);
+}
+
+float UVectorSearchBPLibrary::GetVectorDatabaseCompactionThreshold(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GetVectorDatabaseCompactionThreshold: Invalid Database"));
+        return 0.0f;
+    }
+
+    return Database->GetCompactionThreshold();
+}
+
+void UVectorSearchBPLibrary::SetVectorDatabaseAutoCompaction(UVectorDatabase* Database, bool bAutoCompaction)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SetVectorDatabaseAutoCompaction: Invalid Database"));
+        return;
+    }
+
+    Database->SetAutoCompaction(bAutoCompaction);
+}
+
+bool UVectorSearchBPLibrary::IsVectorDatabaseAutoCompactionEnabled(UVectorDatabase* Database)
+{
+    if (!Database)
+    {
+        UE_LOG(LogTemp, Error, TEXT("IsVectorDatabaseAutoCompactionEnabled: Invalid Database"));
+        return false;
+    }
+
+    return Database->IsAutoCompactionEnabled();
+}
+
 TArray<FString> UVectorSearchBPLibrary::GetUniqueCategoriesFromAsset(UVectorDatabaseAsset* Asset)
 {
     if (!Asset)
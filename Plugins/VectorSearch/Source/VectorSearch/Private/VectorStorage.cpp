@@ -0,0 +1,445 @@
+#include "VectorStorage.h"
+#include "VectorDatabaseTypes.h"
+#include "Hash/xxhash.h"
+
+namespace
+{
+    int32 GetPrecisionElementSize(EVectorStoragePrecision Precision)
+    {
+        return Precision == EVectorStoragePrecision::Float32 ? sizeof(float) : sizeof(uint16);
+    }
+
+    FORCEINLINE uint16 FloatToBFloat16(float Value)
+    {
+        uint32 Bits;
+        FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+
+        if ((Bits & 0x7FFFFFFF) > 0x7F800000)
+        {
+            // Keep NaNs quiet instead of letting rounding turn them into infinities
+            return static_cast<uint16>((Bits >> 16) | 0x0040);
+        }
+
+        // Round to nearest, ties to even
+        Bits += 0x7FFF + ((Bits >> 16) & 1);
+        return static_cast<uint16>(Bits >> 16);
+    }
+
+    FORCEINLINE float BFloat16ToFloat(uint16 Value)
+    {
+        const uint32 Bits = static_cast<uint32>(Value) << 16;
+        float Result;
+        FMemory::Memcpy(&Result, &Bits, sizeof(Result));
+        return Result;
+    }
+}
+
+FVectorStorage::FVectorStorage()
+    : Precision(EVectorStoragePrecision::Float32),
+      ElementSize(sizeof(float)),
+      Dimension(0),
+      Stride(0),
+      NumRows(0),
+      ExternalRows(nullptr),
+      NumNonUnitRows(0)
+{
+}
+
+void FVectorStorage::SetPrecision(EVectorStoragePrecision InPrecision)
+{
+    if (Precision == InPrecision)
+    {
+        return;
+    }
+
+    // Decode everything at the old precision, then re-encode at the new one
+    TArray64<float> Decoded;
+    Decoded.SetNumUninitialized(static_cast<int64>(NumRows) * Dimension);
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        DecodeRow(Row, Decoded.GetData() + static_cast<SIZE_T>(Row) * Dimension);
+    }
+
+    const int32 SavedRows = NumRows;
+    const int32 SavedDimension = Dimension;
+
+    Precision = InPrecision;
+    ElementSize = GetPrecisionElementSize(InPrecision);
+    Empty();
+
+    if (SavedRows > 0)
+    {
+        SetDimension(SavedDimension);
+        Reserve(SavedRows);
+        for (int32 Row = 0; Row < SavedRows; ++Row)
+        {
+            Add(TArrayView<const float>(Decoded.GetData() + static_cast<SIZE_T>(Row) * SavedDimension, SavedDimension));
+        }
+    }
+}
+
+void FVectorStorage::SetDimension(int32 InDimension)
+{
+    if (NumRows > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("FVectorStorage::SetDimension: Cannot change the dimension of a non-empty storage"));
+        return;
+    }
+
+    const int32 ElementsPerAlignment = Alignment / ElementSize;
+
+    Dimension = FMath::Max(InDimension, 0);
+    Stride = Align(Dimension, ElementsPerAlignment);
+}
+
+void FVectorStorage::Reserve(int32 NumRowsToReserve)
+{
+    if (Stride > 0 && NumRowsToReserve > 0)
+    {
+        Data.Reserve(GetRowsSize(NumRowsToReserve));
+        Norms.Reserve(NumRowsToReserve);
+    }
+}
+
+int32 FVectorStorage::Add(TArrayView<const float> Vector)
+{
+    if (Vector.Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+
+    if (NumRows == 0 && Dimension != Vector.Num())
+    {
+        SetDimension(Vector.Num());
+    }
+
+    if (Vector.Num() != Dimension)
+    {
+        return INDEX_NONE;
+    }
+
+    CopyExternalRows();
+
+    // Padding between Dimension and Stride stays zeroed
+    const int64 Offset = Data.AddZeroed(GetStrideInBytes());
+    EncodeRow(Vector.GetData(), Data.GetData() + Offset);
+
+    const int32 Row = NumRows++;
+    const float Norm = ComputeRowNorm(Row);
+    Norms.Add(Norm);
+    NumNonUnitRows += IsUnitNorm(Norm) ? 0 : 1;
+
+    return Row;
+}
+
+void FVectorStorage::SetRow(int32 Row, TArrayView<const float> Vector)
+{
+    check(Row >= 0 && Row < NumRows);
+
+    if (Vector.Num() != Dimension)
+    {
+        return;
+    }
+
+    CopyExternalRows();
+    EncodeRow(Vector.GetData(), Data.GetData() + GetRowsSize(Row));
+
+    NumNonUnitRows -= IsUnitNorm(Norms[Row]) ? 0 : 1;
+    Norms[Row] = ComputeRowNorm(Row);
+    NumNonUnitRows += IsUnitNorm(Norms[Row]) ? 0 : 1;
+}
+
+void FVectorStorage::RemoveAt(int32 Row)
+{
+    check(Row >= 0 && Row < NumRows);
+
+    CopyExternalRows();
+    Data.RemoveAt(GetRowsSize(Row), GetStrideInBytes(), false);
+    NumNonUnitRows -= IsUnitNorm(Norms[Row]) ? 0 : 1;
+    Norms.RemoveAt(Row, 1, false);
+    NumRows--;
+}
+
+void FVectorStorage::Compact(TArrayView<const int32> RowRemap)
+{
+    check(RowRemap.Num() == NumRows);
+
+    CopyExternalRows();
+
+    const int32 RowBytes = Stride * ElementSize;
+
+    // Surviving rows only ever move towards the front, so they can be packed in place
+    int32 NumKept = 0;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        if (RowRemap[Row] == INDEX_NONE)
+        {
+            NumNonUnitRows -= IsUnitNorm(Norms[Row]) ? 0 : 1;
+            continue;
+        }
+
+        check(RowRemap[Row] == NumKept);
+        if (NumKept != Row)
+        {
+            FMemory::Memcpy(Data.GetData() + static_cast<SIZE_T>(NumKept) * RowBytes, Data.GetData() + static_cast<SIZE_T>(Row) * RowBytes, RowBytes);
+            Norms[NumKept] = Norms[Row];
+        }
+        NumKept++;
+    }
+
+    NumRows = NumKept;
+    Data.SetNum(GetRowsSize(NumRows), false);
+    Norms.SetNum(NumRows, false);
+}
+
+void FVectorStorage::Empty()
+{
+    Data.Empty();
+    ExternalRows = nullptr;
+    ExternalMemory.Reset();
+    Norms.Empty();
+    NumNonUnitRows = 0;
+    NumRows = 0;
+    Dimension = 0;
+    Stride = 0;
+}
+
+bool FVectorStorage::LoadRawData(FArchive& Ar, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms)
+{
+    Empty();
+
+    if (InNumRows <= 0)
+    {
+        return !Ar.IsError();
+    }
+
+    check(RowNorms.Num() == 0 || RowNorms.Num() == InNumRows);
+
+    SetDimension(InDimension);
+    Data.SetNumUninitialized(GetRowsSize(InNumRows));
+    Ar.Serialize(Data.GetData(), Data.Num());
+
+    if (Ar.IsError())
+    {
+        Empty();
+        return false;
+    }
+
+    NumRows = InNumRows;
+    SetRowNorms(RowNorms);
+    return true;
+}
+
+void FVectorStorage::CopyRawData(const uint8* Rows, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms)
+{
+    Empty();
+
+    if (InNumRows <= 0)
+    {
+        return;
+    }
+
+    check(RowNorms.Num() == 0 || RowNorms.Num() == InNumRows);
+
+    SetDimension(InDimension);
+    Data.SetNumUninitialized(GetRowsSize(InNumRows));
+    FMemory::Memcpy(Data.GetData(), Rows, Data.Num());
+
+    NumRows = InNumRows;
+    SetRowNorms(RowNorms);
+}
+
+void FVectorStorage::AttachExternalRows(const TSharedRef<IVectorStorageMemory>& Memory, const uint8* Rows, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms)
+{
+    Empty();
+
+    if (InNumRows <= 0)
+    {
+        return;
+    }
+
+    check(IsAligned(Rows, Alignment));
+    check(RowNorms.Num() == 0 || RowNorms.Num() == InNumRows);
+
+    SetDimension(InDimension);
+    ExternalRows = Rows;
+    ExternalMemory = Memory;
+    NumRows = InNumRows;
+    SetRowNorms(RowNorms);
+}
+
+void FVectorStorage::SetRowNorms(TArrayView<const float> RowNorms)
+{
+    if (RowNorms.Num() > 0)
+    {
+        Norms.Reset();
+        Norms.Append(RowNorms.GetData(), RowNorms.Num());
+    }
+    else
+    {
+        Norms.SetNumUninitialized(NumRows);
+        for (int32 Row = 0; Row < NumRows; ++Row)
+        {
+            Norms[Row] = ComputeRowNorm(Row);
+        }
+    }
+
+    NumNonUnitRows = 0;
+    for (const float Norm : Norms)
+    {
+        NumNonUnitRows += IsUnitNorm(Norm) ? 0 : 1;
+    }
+}
+
+uint64 FVectorStorage::ComputeChecksum() const
+{
+    FXxHash64Builder Builder;
+    Builder.Update(&Dimension, sizeof(Dimension));
+    Builder.Update(&Precision, sizeof(Precision));
+
+    const SIZE_T RowBytes = static_cast<SIZE_T>(Dimension) * ElementSize;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        Builder.Update(GetRawRowData(Row), RowBytes);
+    }
+
+    return Builder.Finalize().Hash;
+}
+
+void FVectorStorage::CopyExternalRows()
+{
+    if (!ExternalRows)
+    {
+        return;
+    }
+
+    const int64 NumBytes = GetRowsSize(NumRows);
+    Data.SetNumUninitialized(NumBytes);
+    FMemory::Memcpy(Data.GetData(), ExternalRows, NumBytes);
+
+    ExternalRows = nullptr;
+    ExternalMemory.Reset();
+}
+
+void FVectorStorage::EncodeRow(const float* Vector, uint8* OutRow) const
+{
+    switch (Precision)
+    {
+        case EVectorStoragePrecision::Float16:
+        {
+            FFloat16* Elements = reinterpret_cast<FFloat16*>(OutRow);
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Elements[i] = FFloat16(Vector[i]);
+            }
+            break;
+        }
+
+        case EVectorStoragePrecision::BFloat16:
+        {
+            FVectorBFloat16* Elements = reinterpret_cast<FVectorBFloat16*>(OutRow);
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                Elements[i].Encoded = FloatToBFloat16(Vector[i]);
+            }
+            break;
+        }
+
+        default:
+            FMemory::Memcpy(OutRow, Vector, Dimension * sizeof(float));
+            break;
+    }
+}
+
+void FVectorStorage::DecodeRow(int32 Row, float* OutVector) const
+{
+    const uint8* RowData = GetRawRowData(Row);
+
+    switch (Precision)
+    {
+        case EVectorStoragePrecision::Float16:
+        {
+            const FFloat16* Elements = reinterpret_cast<const FFloat16*>(RowData);
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                OutVector[i] = Elements[i].GetFloat();
+            }
+            break;
+        }
+
+        case EVectorStoragePrecision::BFloat16:
+        {
+            const FVectorBFloat16* Elements = reinterpret_cast<const FVectorBFloat16*>(RowData);
+            for (int32 i = 0; i < Dimension; ++i)
+            {
+                OutVector[i] = BFloat16ToFloat(Elements[i].Encoded);
+            }
+            break;
+        }
+
+        default:
+            FMemory::Memcpy(OutVector, RowData, Dimension * sizeof(float));
+            break;
+    }
+}
+
+float FVectorStorage::ComputeRowNorm(int32 Row) const
+{
+    TArray<float> Scratch;
+    const float* Vector = GetRowAsFloat(Row, Scratch);
+
+    float SquaredNorm = 0.0f;
+    for (int32 i = 0; i < Dimension; ++i)
+    {
+        SquaredNorm += Vector[i] * Vector[i];
+    }
+    return FMath::Sqrt(SquaredNorm);
+}
+
+const float* FVectorStorage::GetRowAsFloat(int32 Row, TArray<float>& Scratch) const
+{
+    if (ElementSize == sizeof(float))
+    {
+        return GetRowData(Row);
+    }
+
+    Scratch.SetNumUninitialized(Dimension, false);
+    DecodeRow(Row, Scratch.GetData());
+    return Scratch.GetData();
+}
+
+TArray<float> FVectorStorage::CopyRow(int32 Row) const
+{
+    TArray<float> Result;
+    Result.SetNumUninitialized(Dimension);
+    DecodeRow(Row, Result.GetData());
+    return Result;
+}
+
+bool FVectorStorage::RowEquals(int32 Row, TArrayView<const float> Vector) const
+{
+    if (Vector.Num() != Dimension)
+    {
+        return false;
+    }
+
+    if (ElementSize == sizeof(float))
+    {
+        const float* RowData = GetRowData(Row);
+        for (int32 i = 0; i < Dimension; ++i)
+        {
+            if (RowData[i] != Vector[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Compare encoded elements so values that round to the same half-precision value match
+    TArray<uint8> Encoded;
+    Encoded.SetNumUninitialized(Dimension * ElementSize);
+    EncodeRow(Vector.GetData(), Encoded.GetData());
+
+    return FMemory::Memcmp(GetRawRowData(Row), Encoded.GetData(), Dimension * ElementSize) == 0;
+}
@@ -0,0 +1,28 @@
+#include "VectorTopK.h"
+
+void FVectorTopK::Reset(int32 InK, bool bInHigherIsBetter)
+{
+    K = FMath::Max(InK, 0);
+    bHigherIsBetter = bInHigherIsBetter;
+    // K can be far larger than the hits a query ever finds, so the heap grows on demand past a small reservation
+    Heap.Reset(FMath::Min(K, MaxReservedHits));
+}
+
+void FVectorTopK::Merge(const FVectorTopK& Other)
+{
+    for (const FVectorSearchHit& Hit : Other.Heap)
+    {
+        Add(Hit.Row, Hit.Distance);
+    }
+}
+
+void FVectorTopK::GetSortedHits(TArray<FVectorSearchHit>& OutHits) const
+{
+    OutHits = Heap;
+
+    // The heap predicate orders worst-first, so sorting by its inverse yields best-first
+    const FWorseFirst WorseFirst(bHigherIsBetter);
+    OutHits.Sort([&WorseFirst](const FVectorSearchHit& A, const FVectorSearchHit& B) {
+        return WorseFirst(B, A);
+    });
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Category filter compiled for one query: a bitset over interned category IDs.
+ * An unrestricted filter accepts every row without looking at the bits.
+ */
+class VECTORSEARCH_API FVectorCategoryFilter
+{
+public:
+    FVectorCategoryFilter()
+        : bAcceptAll(true)
+    {
+    }
+
+    /** Check whether rows in a category pass the filter */
+    bool Accepts(int32 CategoryId) const
+    {
+        return bAcceptAll || (CategoryId < Bits.Num() && Bits[CategoryId]);
+    }
+
+    /** Check whether the filter lets every row through */
+    bool AcceptsAll() const { return bAcceptAll; }
+
+private:
+    friend class FVectorCategoryTable;
+
+    TBitArray<> Bits;
+
+    bool bAcceptAll;
+};
+
+/**
+ * Interns category names to dense integer IDs so rows can store and compare a category as an int32.
+ * Names compare case-insensitively, like the FString comparisons they replace.
+ */
+class VECTORSEARCH_API FVectorCategoryTable
+{
+public:
+    /** Get the ID of a category, adding it if it has not been seen before */
+    int32 Intern(const FString& Category);
+
+    /** Get the ID of a category, or INDEX_NONE if it has never been interned */
+    int32 Find(const FString& Category) const;
+
+    /** Get the name of an interned category */
+    const FString& GetName(int32 CategoryId) const { return Names[CategoryId]; }
+
+    /** Get the number of interned categories */
+    int32 Num() const { return Names.Num(); }
+
+    /** Forget every category */
+    void Empty();
+
+    /** Build the filter for a query. An empty list accepts every category, as the query functions always have. */
+    FVectorCategoryFilter CompileFilter(const TArray<FString>& Categories) const;
+
+private:
+    TArray<FString> Names;
+
+    TMap<FString, int32> Ids;
+};
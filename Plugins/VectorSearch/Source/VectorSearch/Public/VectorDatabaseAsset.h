@@ -2,9 +2,14 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "Serialization/BulkData.h"
 #include "VectorDatabaseTypes.h"
 #include "VectorDatabaseAsset.generated.h"
 
+struct FVectorDatabaseFileContents;
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnVectorDatabaseLoaded, UVectorDatabase*, Database);
+
 /**
  * Asset class for storing and loading vector databases
  * Provides efficient serialization and persistence of vector databases
@@ -15,10 +20,6 @@ class VECTORSEARCH_API UVectorDatabaseAsset : public UDataAsset
     GENERATED_BODY()
 
 public:
-    /** The vector database entries stored in this asset */
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Vector Database")
-    TArray<FVectorDatabaseEntry> Entries;
-
     /** Metadata about the database */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
     FString DatabaseName;
@@ -36,11 +37,33 @@ public:
     FDateTime LastModifiedDate;
 
     /** Vector dimension for all entries in this database */
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Vector Database")
     int32 VectorDimension;
 
-    /** Categories present in this database */
+    /** Element type the vectors are stored with, in the asset and once loaded into a database */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Vector Database")
+    EVectorStoragePrecision StoragePrecision;
+
+    /** Distance metric databases loaded from this asset use */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    EVectorDistanceMetric DistanceMetric;
+
+    /**
+     * Index databases loaded from this asset use. The index saved with the asset is restored when it was built with
+     * these settings over the stored vectors; changing them makes loading build the index again.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    FVectorIndexSettings IndexSettings;
+
+    /**
+     * Quantization databases loaded from this asset use. Like the index, the quantizer saved with the asset is restored
+     * when it was trained with these settings over the stored vectors, and trained again otherwise.
+     */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    FVectorQuantizationSettings QuantizationSettings;
+
+    /** Categories present in this database. Rows refer to them by index, so they are only changed by saving or loading a database. */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Vector Database")
     TArray<FString> Categories;
 
     /** Save a vector database to this asset */
@@ -51,14 +74,35 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     UVectorDatabase* LoadToVectorDatabase() const;
 
-    /** Save the database to a file */
+    /**
+     * Load a vector database from this asset without blocking on the vector block. The block is streamed from disk
+     * in the background and OnLoaded runs on the game thread once the database is built; the saved index and
+     * quantizer, which are much smaller, are read then. Falls back to LoadToVectorDatabase when the block is
+     * already in memory or cannot be streamed.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    void LoadToVectorDatabaseAsync(const FOnVectorDatabaseLoaded& OnLoaded);
+
+    /** Save the database to a binary database file */
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     bool SaveToFile(const FString& FilePath);
 
-    /** Load the database from a file */
+    /** Load the database from a binary database file. Files that are not in the binary format are read as JSON exports. */
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     bool LoadFromFile(const FString& FilePath);
 
+    /** Export the database to a human-readable JSON file. Much larger and slower than SaveToFile. */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    bool ExportToJsonFile(const FString& FilePath);
+
+    /** Import the database from a JSON file written by ExportToJsonFile */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    bool ImportFromJsonFile(const FString& FilePath);
+
+    /** Get the number of entries stored in this asset */
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    int32 GetNumberOfEntries() const;
+
     /** Get all unique categories in the database */
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     TArray<FString> GetUniqueCategories() const;
@@ -71,8 +115,12 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     TArray<FVectorDatabaseEntry> GetEntriesForCategory(const FString& Category) const;
 
-    /** Deep copy a struct from source to destination */
-    static void DeepCopyStruct(UScriptStruct* StructType, void* Dest, const void* Src);
+    /**
+     * Entries of assets saved before vectors and payloads were stored as sections. Only read on load, where
+     * PostLoad moves them into the sections; empty otherwise.
+     */
+    UPROPERTY(BlueprintReadOnly, Category = "Vector Database", meta = (DeprecatedProperty, DeprecationMessage = "Entries are no longer kept in the asset and are always empty. Use GetEntriesForCategory or LoadToVectorDatabase instead."))
+    TArray<FVectorDatabaseEntry> Entries;
 
     /** Constructor */
     UVectorDatabaseAsset();
@@ -80,7 +128,99 @@ public:
     /** Initialize the asset */
     virtual void PostInitProperties() override;
 
+    /** Save or load the vector and payload sections after the tagged properties */
+    virtual void Serialize(FArchive& Ar) override;
+
+    /** Move the entries of assets saved before the sections existed into them */
+    virtual void PostLoad() override;
+
+    /** Report the objects referenced by the payloads to the garbage collector */
+    static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
 #if WITH_EDITOR
     virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+    /** Build the index and quantizer cooked builds ship with, or fetch them from the derived data cache */
+    virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+    virtual bool IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform) override;
+    virtual void ClearAllCachedCookedPlatformData() override;
+
+    /** Make sure the search structures are cached before a cook writes them */
+    virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
+private:
+    /** Build a database from the sections. StreamedRows, when given, hold the vector block read by LoadToVectorDatabaseAsync. */
+    UVectorDatabase* CreateVectorDatabase(const uint8* StreamedRows) const;
+
+    /**
+     * Copy the sections into the layout of a database file. Returns false if the vector block does not match the payloads.
+     * StreamedRows, when given, hold the vector block read by LoadToVectorDatabaseAsync.
+     */
+    bool GatherFileContents(FVectorDatabaseFileContents& OutContents, const uint8* StreamedRows = nullptr) const;
+
+    /** Replace the sections with those of a database file, taking over its payloads */
+    void ApplyFileContents(FVectorDatabaseFileContents& Contents);
+
+    /**
+     * Copy the vector block out of the bulk data, or out of StreamedRows when given. Returns false if it does not match the payloads.
+     * Blocks read from disk are not kept in memory, so the asset only holds the rows while they are copied.
+     */
+    bool LoadVectors(FVectorStorage& OutVectors, const uint8* StreamedRows = nullptr) const;
+
+    /** Pack the entries of an asset saved before the sections existed into the sections, then drop them */
+    void MigrateEntries();
+
+#if WITH_EDITOR
+    /** Check whether databases loaded from this asset build an index or a quantizer */
+    bool HasSearchStructures() const;
+
+    /**
+     * Get the derived data cache key of the index and quantizer built over the rows with checksum InVectorChecksum and the current settings.
+     * Query-time settings such as EfSearch or NumProbes are left out, since they do not change what is built.
+     */
+    FString GetSearchStructuresKey(uint64 InVectorChecksum) const;
+
+    /** Replace the saved index and quantizer of Contents with those cached under Key. Returns false if the cache does not hold them. */
+    bool FetchSearchStructures(const FString& Key, FVectorDatabaseFileContents& Contents) const;
+
+    /** Store the index and quantizer of a database loaded from this asset under Key, also returning them */
+    void StoreSearchStructures(const FString& Key, const UVectorDatabase& Database, uint64 InVectorChecksum, TArray<uint8>& OutIndexData, TArray<uint8>& OutQuantizerData) const;
+
+    /** Replace the saved index and quantizer with those built for the current vectors and settings, going through the derived data cache */
+    void CacheSearchStructures();
+#endif
+
+    /**
+     * The vector block: every row at StoragePrecision in the layout of FVectorStorage::GetRawData.
+     * Stored outside the export so cooked builds stream it from disk the first time a database is loaded from the asset.
+     * Mutable because loads, which are const, drop the payload from memory again once it has been copied.
+     */
+    mutable FByteBulkData VectorBulkData;
+
+    /** The index saved by UVectorDatabase::ExportFileContents, stored and loaded like the vector block; empty when there is none */
+    mutable FByteBulkData IndexBulkData;
+
+    /** The quantizer saved by UVectorDatabase::ExportFileContents, stored and loaded like the vector block; empty when there is none */
+    mutable FByteBulkData QuantizerBulkData;
+
+    /** L2 norm of every row, so loading does not have to read every row to compute them */
+    TArray<float> RowNorms;
+
+    /** FVectorStorage::ComputeChecksum of the vector block, so the saved index and quantizer are matched without reading every row; 0 when unknown */
+    uint64 VectorChecksum;
+
+    /** Index into Categories of every row, INDEX_NONE for rows without a category */
+    TArray<int32> RowCategories;
+
+    /** Payload of every row; object values and struct types are serialized as references of the package */
+    FVectorPayloadStore Payloads;
+
+#if WITH_EDITORONLY_DATA
+    /** Whether the saved index and quantizer were last replaced by CacheSearchStructures and still match the sections and settings */
+    bool bSearchStructuresCached;
+
+    /** GetSearchStructuresKey of the saved index and quantizer, so loads only go to the derived data cache once the settings changed; empty when unknown */
+    FString SavedSearchStructuresKey;
 #endif
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorDatabaseTypes.h"
+
+/** Versions of the binary database file format. Files of any version up to Latest can be read. */
+enum class EVectorDatabaseFileVersion : int32
+{
+    Initial = 1,
+
+    /** The cached norm of every row is stored, so mapped files do not have to read every row on open */
+    RowNorms,
+
+    /** The index settings and the index built over the vectors are stored, so opening a file does not rebuild it */
+    Index,
+
+    /** The quantization settings and the trained quantizer are stored, so opening a file does not train it again */
+    Quantizer,
+
+    /** The checksum of the vector block is stored, so the saved index and quantizer are matched without reading every row */
+    VectorChecksum,
+
+    VersionPlusOne,
+    Latest = VersionPlusOne - 1
+};
+
+/**
+ * Everything a database file holds, in the layout the database keeps in memory,
+ * so files are read and written one section at a time instead of one entry at a time.
+ */
+struct VECTORSEARCH_API FVectorDatabaseFileContents
+{
+    FVectorDatabaseFileContents();
+
+    FString DatabaseName;
+
+    FString Description;
+
+    FDateTime CreationDate;
+
+    FDateTime LastModifiedDate;
+
+    EVectorDistanceMetric DistanceMetric;
+
+    /** Names of the categories referenced by RowCategories */
+    TArray<FString> Categories;
+
+    /** Index into Categories of each row, INDEX_NONE for rows without a category */
+    TArray<int32> RowCategories;
+
+    /** Vector of each row, at the precision it is written with */
+    FVectorStorage Vectors;
+
+    /**
+     * FVectorStorage::ComputeChecksum of Vectors, computed once when the rows are saved so loading can match the saved
+     * index and quantizer against it without reading every row. 0 when unknown.
+     */
+    uint64 VectorChecksum;
+
+    /** Payload of each row */
+    FVectorPayloadStore Payloads;
+
+    /** Index the database builds over Vectors */
+    FVectorIndexSettings IndexSettings;
+
+    /** The index built over Vectors with IndexSettings, as saved by UVectorDatabase::ExportFileContents; empty when there is none */
+    TArray<uint8> IndexData;
+
+    /** Quantizer the database keeps over Vectors */
+    FVectorQuantizationSettings QuantizationSettings;
+
+    /** The quantizer trained over Vectors with QuantizationSettings, as saved by UVectorDatabase::ExportFileContents; empty when there is none */
+    TArray<uint8> QuantizerData;
+};
+
+/**
+ * Binary vector database files. All values are little-endian and laid out as:
+ * - a fixed-size header: magic, version, dimension, distance metric, storage precision, row count, row stride, section offsets
+ *   and the checksum of the vector block
+ * - the name, description and dates of the database, the category names and the category of each row
+ * - the payload section: entry types, strings, object and struct type paths, struct values and metadata
+ * - the L2 norm of every row
+ * - the index settings and the saved index, tagged with the checksum of the vectors it was built over
+ * - the quantization settings and the saved quantizer, tagged the same way
+ * - the vector block: every row at the storage precision, padded to the storage stride, starting on an FVectorStorage::Alignment boundary
+ */
+namespace VectorDatabaseFile
+{
+    /** Check whether a file starts with the magic number of the binary format */
+    VECTORSEARCH_API bool IsDatabaseFile(const FString& FilePath);
+
+    /** Write Contents to a file, replacing it. Returns false if the file cannot be written. */
+    VECTORSEARCH_API bool Save(const FString& FilePath, const FVectorDatabaseFileContents& Contents);
+
+    /** Read a file into OutContents. Returns false if the file cannot be read or is not a valid database file. */
+    VECTORSEARCH_API bool Load(const FString& FilePath, FVectorDatabaseFileContents& OutContents);
+
+    /**
+     * Read a file into OutContents without copying its vector block: the vectors are memory-mapped read-only and
+     * pages are read from disk as queries first touch them, so processes opening the same file share them in the
+     * page cache. The file stays open until the storage is emptied or modified, which copies the rows into memory.
+     * Returns false if the file cannot be read or mapped.
+     */
+    VECTORSEARCH_API bool LoadMapped(const FString& FilePath, FVectorDatabaseFileContents& OutContents);
+
+    /**
+     * Write the rows of Vectors to a scratch file, replacing it, and read them back in place from a memory map of it,
+     * so they no longer take memory of their own: pages are read from disk when a row is touched and can be evicted again.
+     * The file must not be the one Vectors is already mapped from. Returns false, leaving Vectors unchanged, if the file
+     * cannot be written or mapped.
+     */
+    VECTORSEARCH_API bool MoveRowsToFile(const FString& FilePath, FVectorStorage& Vectors);
+}
@@ -1,7 +1,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "UObject/NoExportTypes.h"
+#include "VectorStorage.h"
+#include "VectorTopK.h"
+#include "VectorCategoryTable.h"
+#include "VectorMetadataIndex.h"
+#include "VectorIndex.h"
+#include "VectorQuantizer.h"
+#include "VectorPayloadStore.h"
 #include "VectorDatabaseTypes.generated.h"
 
 UENUM(BlueprintType)
@@ -21,6 +29,121 @@ enum class EVectorDistanceMetric : uint8
     DotProduct UMETA(DisplayName = "Dot Product")
 };
 
+UENUM(BlueprintType)
+enum class EVectorStoragePrecision : uint8
+{
+    Float32 UMETA(DisplayName = "32-bit Float"),
+    Float16 UMETA(DisplayName = "16-bit Float (fp16)"),
+    BFloat16 UMETA(DisplayName = "16-bit Brain Float (bf16)")
+};
+
+UENUM(BlueprintType)
+enum class EVectorIndexType : uint8
+{
+    None UMETA(DisplayName = "None (Exact Search)"),
+    HNSW UMETA(DisplayName = "HNSW Graph"),
+    IVF UMETA(DisplayName = "IVF (Inverted File)")
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorIndexSettings
+{
+    GENERATED_BODY()
+
+    FVectorIndexSettings()
+        : IndexType(EVectorIndexType::None),
+          M(16),
+          EfConstruction(200),
+          EfSearch(64),
+          NumLists(256),
+          NumProbes(8),
+          MinEntriesForIndex(1000),
+          ExactScanSelectivity(0.05f)
+    {
+    }
+
+    /** Approximate index used to answer queries, or None for exact linear scans */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    EVectorIndexType IndexType;
+
+    /** HNSW: links per node on the upper layers (layer 0 keeps twice as many) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|HNSW", meta = (ClampMin = "2", ClampMax = "128"))
+    int32 M;
+
+    /** HNSW: candidate list size while inserting; higher builds a better graph more slowly */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|HNSW", meta = (ClampMin = "1"))
+    int32 EfConstruction;
+
+    /** HNSW: candidate list size while querying; higher trades speed for recall */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|HNSW", meta = (ClampMin = "1"))
+    int32 EfSearch;
+
+    /** IVF: number of k-means centroids, each owning one inverted list */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|IVF", meta = (ClampMin = "1"))
+    int32 NumLists;
+
+    /** IVF: number of lists scanned per query; higher trades speed for recall */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|IVF", meta = (ClampMin = "1"))
+    int32 NumProbes;
+
+    /** Queries on databases smaller than this use an exact scan even when an index exists */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database", meta = (ClampMin = "0"))
+    int32 MinEntriesForIndex;
+
+    /** Filtered queries estimated to match less than this fraction of the entries skip the index and scan the matching entries exactly */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float ExactScanSelectivity;
+};
+
+UENUM(BlueprintType)
+enum class EVectorQuantizationType : uint8
+{
+    None UMETA(DisplayName = "None (Full Precision)"),
+    Product UMETA(DisplayName = "Product Quantization"),
+    Scalar8 UMETA(DisplayName = "Int8 Scalar Quantization"),
+    Binary UMETA(DisplayName = "Binary Quantization")
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorQuantizationSettings
+{
+    GENERATED_BODY()
+
+    FVectorQuantizationSettings()
+        : QuantizationType(EVectorQuantizationType::None),
+          NumSubQuantizers(0),
+          bRescore(true),
+          RescoreMultiplier(4)
+    {
+    }
+
+    /**
+     * Compressed copy of the vectors scanned by exact queries, or None to scan full-precision rows.
+     * The codes are kept next to the full-precision rows, which rescoring, the index, updates and saving still read,
+     * so on its own quantization makes scans cheaper but adds memory. Move the rows to a mapped file
+     * (UVectorDatabase::MoveVectorsToFile) to keep only the codes in memory.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    EVectorQuantizationType QuantizationType;
+
+    /** PQ: number of 8-bit sub-codes per vector; 0 uses one per 16 dimensions */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database|Product Quantization", meta = (ClampMin = "0"))
+    int32 NumSubQuantizers;
+
+    /** Re-rank the quantized shortlist with exact distances against the full-precision vectors (always on for Binary) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    bool bRescore;
+
+    /**
+     * Shortlist size as a multiple of N when rescoring. Each step costs N more exact distance computations per query,
+     * which stay small next to the scan itself, and recovers true neighbours the codes ranked just outside the shortlist.
+     * The default of 4 is enough for Int8 and PQ codes to return the exact top N on typical embeddings; Binary codes
+     * lose far more ordering and usually want 10 to 20.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database", meta = (ClampMin = "1", EditCondition = "bRescore"))
+    int32 RescoreMultiplier;
+};
+
 UCLASS(BlueprintType)
 class VECTORSEARCH_API UVectorEntryWrapper : public UObject
 {
@@ -80,6 +203,10 @@ struct VECTORSEARCH_API FVectorDatabaseResult
 
     UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
     TMap<FString, FString> Metadata;
+
+    /** Stable handle of the matched entry, valid until the entry is removed */
+    UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
+    int64 Handle = INDEX_NONE;
 };
 
 USTRUCT(BlueprintType)
@@ -90,6 +217,10 @@ struct VECTORSEARCH_API FVectorDatabaseEntry
     UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
     float Distance;
 
+    /** Stable handle of the entry, valid until the entry is removed */
+    UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
+    int64 Handle = INDEX_NONE;
+
     UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
     TArray<float> Vector;
 
@@ -97,6 +228,101 @@ struct VECTORSEARCH_API FVectorDatabaseEntry
     UVectorEntryWrapper* Entry;
 };
 
+UENUM(BlueprintType)
+enum class EVectorMetadataPredicateType : uint8
+{
+    Equals UMETA(DisplayName = "Equals"),
+    InSet UMETA(DisplayName = "In Set"),
+    Range UMETA(DisplayName = "Numeric Range")
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorMetadataPredicate
+{
+    GENERATED_BODY()
+
+    FVectorMetadataPredicate()
+        : Type(EVectorMetadataPredicateType::Equals),
+          Min(0.0),
+          Max(0.0)
+    {
+    }
+
+    /** Metadata key the predicate tests */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    FString Key;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    EVectorMetadataPredicateType Type;
+
+    /** Equals: the value the key must hold */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    FString Value;
+
+    /** In Set: the key must hold one of these values */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TArray<FString> Values;
+
+    /** Numeric Range: inclusive lower bound of the key's numeric value */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    double Min;
+
+    /** Numeric Range: inclusive upper bound of the key's numeric value */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    double Max;
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorSearchFilter
+{
+    GENERATED_BODY()
+
+    /** Only match entries in one of these categories; empty matches every category */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TArray<FString> Categories;
+
+    /** Only match entries whose Metadata holds every one of these key/value pairs */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TMap<FString, FString> RequiredMetadata;
+
+    /** Only match entries whose Metadata passes every one of these predicates */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TArray<FVectorMetadataPredicate> MetadataPredicates;
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorSearchQuery
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TArray<float> Vector;
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorEntryUpdate
+{
+    GENERATED_BODY()
+
+    /** Handle of the entry to move */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    int64 Handle = INDEX_NONE;
+
+    /** New vector of the entry, with the database's dimension */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vector Database")
+    TArray<float> Vector;
+};
+
+USTRUCT(BlueprintType)
+struct VECTORSEARCH_API FVectorSearchQueryResult
+{
+    GENERATED_BODY()
+
+    /** Matches for one query, best first */
+    UPROPERTY(BlueprintReadOnly, Category = "Vector Database")
+    TArray<FVectorDatabaseEntry> Matches;
+};
+
 USTRUCT(BlueprintType)
 struct VECTORSEARCH_API FVectorDatabaseStats
 {
@@ -124,6 +350,9 @@ struct VECTORSEARCH_API FVectorDatabaseStats
     TMap<FString, int32> CategoryCounts;
 };
 
+struct FVectorPartitionSelection;
+struct FVectorDatabaseFileContents;
+
 UCLASS(BlueprintType, Blueprintable)
 class VECTORSEARCH_API UVectorDatabase : public UObject
 {
@@ -133,21 +362,61 @@ public:
     UVectorDatabase();
     virtual ~UVectorDatabase();
 
-    /** Add a string entry to the database */
-    void AddEntry(const TArray<float>& Vector, UVectorEntryWrapper* Entry, const FString& Category);
+    /** Report the object values, struct types and struct object properties held by entry payloads */
+    static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+    /**
+     * Add an entry to the database, copying the wrapper's payload. The wrapper is not kept, so later edits to it do not reach the database.
+     * Returns a handle that identifies the entry until it is removed, or INDEX_NONE on failure.
+     */
+    int64 AddEntry(const TArray<float>& Vector, UVectorEntryWrapper* Entry, const FString& Category);
+
+    /** Add a string entry to the database. Returns a handle that identifies the entry until it is removed, or INDEX_NONE on failure. */
+    int64 AddStringEntry(const TArray<float>& Vector, const FString& Value, const FString& Category, const TMap<FString, FString>& Metadata = TMap<FString, FString>());
+
+    /** Add an object entry to the database. Returns a handle that identifies the entry until it is removed, or INDEX_NONE on failure. */
+    int64 AddObjectEntry(const TArray<float>& Vector, UObject* Value, const FString& Category, const TMap<FString, FString>& Metadata = TMap<FString, FString>());
     
-    /** Add a struct entry to the database */
-    void AddStructEntry(const TArray<float>& Vector, UScriptStruct* StructType, const void* StructPtr, const FString& Category);
+    /** Add a struct entry to the database. Returns a handle that identifies the entry until it is removed, or INDEX_NONE on failure. */
+    int64 AddStructEntry(const TArray<float>& Vector, UScriptStruct* StructType, const void* StructPtr, const FString& Category);
+
+    /**
+     * Add many entries at once. Vectors and Entries are parallel arrays; Categories holds one category per entry,
+     * a single category shared by all of them, or none. Storage is reserved once and indexes are extended once at the end.
+     * Returns the handle of every entry, INDEX_NONE for entries that were rejected.
+     */
+    TArray<int64> AddEntriesBulk(const TArray<TArray<float>>& InVectors, const TArray<UVectorEntryWrapper*>& InEntries, const TArray<FString>& Categories);
+
+    /** AddEntriesBulk taking the vectors packed back to back, Dimension floats per entry */
+    TArray<int64> AddEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<UVectorEntryWrapper*>& InEntries, const TArray<FString>& Categories);
+
+    /** AddEntriesBulk for string entries, without creating a wrapper per entry */
+    TArray<int64> AddStringEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<FString>& Values, const TArray<FString>& Categories);
+
+    /** AddEntriesBulk for object entries, without creating a wrapper per entry. Null objects are rejected. */
+    TArray<int64> AddObjectEntriesBulk(TArrayView<const float> PackedVectors, int32 Dimension, const TArray<UObject*>& Values, const TArray<FString>& Categories);
 
-    /** Get the top N matches for a query vector */
+    /** Get the top N matches for a query vector, as transient wrappers holding a copy of each payload */
     TArray<UVectorEntryWrapper*> GetTopNMatches(const TArray<float>& QueryVector, int32 N, EEntryType EntryType, const TArray<FString>& Categories) const;
 
+    /** Get the values of the top N string matches for a query vector */
+    TArray<FString> GetTopNStringMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const;
+
+    /** Get the values of the top N object matches for a query vector */
+    TArray<UObject*> GetTopNObjectMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const;
+
     /** Get the top N struct matches for a query vector */
     TArray<FVectorDatabaseResult> GetTopNStructMatches(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const;
 
     /** Get the top N entries with details for a query vector */
     TArray<FVectorDatabaseEntry> GetTopNEntriesWithDetails(const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories) const;
 
+    /** Get the top N entries with details that pass a category and metadata filter. Indexes apply the filter while they search. */
+    TArray<FVectorDatabaseEntry> GetTopNEntriesFiltered(const TArray<float>& QueryVector, int32 N, const FVectorSearchFilter& Filter) const;
+
+    /** Get the top N entries with details for each of several query vectors, sharing one pass over the stored vectors */
+    TArray<FVectorSearchQueryResult> GetTopNMatchesBatch(const TArray<TArray<float>>& QueryVectors, int32 N, const TArray<FString>& Categories) const;
+
     /** Get all vector entries in the database */
     TArray<FVectorDatabaseEntry> GetAllVectorEntries(const TArray<FString>& Categories) const;
 
@@ -166,6 +435,47 @@ public:
     /** Remove an entry from the database */
     bool RemoveEntry(const TArray<float>& Vector, bool bRemoveAllOccurrences = false, float RemovalRange = 0.0f);
 
+    /** Remove the entry a handle refers to. Returns false if the handle is unknown or already removed. */
+    bool RemoveEntryByHandle(int64 Handle);
+
+    /** Overwrite the vector of an entry in place, keeping its handle, payload and category. Indexes are updated incrementally. */
+    bool UpdateEntryVector(int64 Handle, const TArray<float>& NewVector);
+
+    /** Overwrite the vectors of many entries at once. Returns the number of entries updated. */
+    int32 UpdateEntryVectors(const TArray<FVectorEntryUpdate>& Updates);
+
+    /** Replace the Metadata of an entry and re-index it. Returns false if the handle is unknown or already removed. */
+    bool SetEntryMetadata(int64 Handle, const TMap<FString, FString>& Metadata);
+
+    /** Check whether a handle refers to an entry that is still in the database */
+    bool ContainsHandle(int64 Handle) const;
+
+    /**
+     * Physically drop removed entries and renumber the remaining rows. Removal never compacts synchronously, since a pass
+     * touches every row: with auto compaction on, the removal that crosses the compaction threshold schedules
+     * CompactIfNeeded for the next core ticker tick, so a burst of removals pays for a single pass. Call this, or
+     * CompactIfNeeded, to pick the moment yourself, e.g. at a loading screen before the threshold is reached.
+     */
+    void Compact();
+
+    /** Check whether the removed rows make up at least the compaction threshold of the database */
+    bool NeedsCompaction() const;
+
+    /** Compact if NeedsCompaction. Returns true if a compaction ran. */
+    bool CompactIfNeeded();
+
+    /** Set the fraction of removed rows at which NeedsCompaction reports true; 0 makes it never report true */
+    void SetCompactionThreshold(float InThreshold);
+
+    /** Get the fraction of removed rows at which NeedsCompaction reports true */
+    float GetCompactionThreshold() const;
+
+    /** Turn compacting on the tick after the threshold is crossed on or off; with it off, compaction is left to the caller */
+    void SetAutoCompaction(bool bInAutoCompaction);
+
+    /** Check whether crossing the compaction threshold schedules a compaction by itself */
+    bool IsAutoCompactionEnabled() const;
+
     /** Get database statistics */
     FVectorDatabaseStats GetDatabaseStats() const;
 
@@ -187,6 +497,29 @@ public:
     /** Clear all entries from the database */
     void ClearDatabase();
 
+    /**
+     * Replace every entry with the rows of a database file, taking over its vector storage and payloads instead of
+     * adding them one entry at a time, and adopt its distance metric, index settings and quantization settings. Vectors
+     * mapped from the file stay mapped. Contents is left empty. The saved index and quantizer are restored if they were
+     * built with the same settings and version over exactly these vectors; otherwise they are built again.
+     */
+    void ResetFromFileContents(FVectorDatabaseFileContents& Contents);
+
+    /**
+     * Copy every live entry into the sections of a database file, along with the distance metric, the index and the
+     * quantizer and their settings: the vector storage and payload columns are copied whole and removed rows are
+     * compacted out of the copies, which are hashed once into OutContents.VectorChecksum. Rows whose category is empty get no category. The database itself is left untouched.
+     */
+    void ExportFileContents(FVectorDatabaseFileContents& OutContents) const;
+
+    /**
+     * Save the index and the quantizer in the form ExportFileContents writes them, without copying the rows.
+     * VectorChecksum is FVectorStorage::ComputeChecksum of the rows, as the caller saved it alongside them.
+     * Returns false if removed rows are still waiting for compaction, since the saved structures would not cover
+     * exactly the exported rows.
+     */
+    bool SaveSearchStructures(uint64 VectorChecksum, TArray<uint8>& OutIndexData, TArray<uint8>& OutQuantizerData) const;
+
     /** Check if the database is empty */
     bool IsEmpty() const;
 
@@ -199,17 +532,197 @@ public:
     /** Normalize all vectors in the database */
     void NormalizeVectors();
 
+    /** Check whether every stored vector is unit length, in which case Cosine queries reduce to a dot product per row */
+    bool AreVectorsNormalized() const;
+
+    /** Change the element type of the stored vectors, converting existing entries */
+    void SetStoragePrecision(EVectorStoragePrecision InPrecision);
+
+    /** Get the element type of the stored vectors */
+    EVectorStoragePrecision GetStoragePrecision() const;
+
+    /** Configure the approximate index and (re)build it over the current entries */
+    void SetIndexSettings(const FVectorIndexSettings& InSettings);
+
+    /** Get the current index settings */
+    const FVectorIndexSettings& GetIndexSettings() const;
+
+    /** Rebuild the approximate index from scratch over the current entries */
+    void RebuildIndex();
+
+    /** Check if an approximate index is attached and will be used by queries */
+    bool HasIndex() const;
+
+    /** Configure vector quantization and (re)train it over the current entries */
+    void SetQuantizationSettings(const FVectorQuantizationSettings& InSettings);
+
+    /** Get the current quantization settings */
+    const FVectorQuantizationSettings& GetQuantizationSettings() const;
+
+    /** Retrain the quantizer from scratch over the current entries */
+    void RetrainQuantizer();
+
+    /** Check if a trained quantizer is attached and will be used by exact queries */
+    bool HasQuantizer() const;
+
+    /**
+     * Keep only the quantizer codes in memory: write the full-precision rows to a scratch file at FilePath and read them
+     * in place from a memory map of it from now on. Scans then read the codes alone, and the rows are paged in only where
+     * something still needs them: rescoring reads the shortlist, results read the rows they return, and index walks read
+     * the rows they visit. Turn bRescore off to skip the shortlist reads (Binary always rescores).
+     * Adding, updating or compacting entries copies every row back into memory; call this again afterwards.
+     * Returns false, leaving the rows in memory, if the file cannot be written or mapped.
+     */
+    bool MoveVectorsToFile(const FString& FilePath);
+
+    /** Check whether the full-precision rows are read from a mapped file rather than held in memory */
+    bool AreVectorsInFile() const;
+
+    /** Re-index the Metadata of every entry from scratch */
+    void RebuildMetadataIndex();
+
+    /** Keep a row list per category and entry type so filtered queries only visit the rows that can match */
+    void SetPartitioned(bool bInPartitioned);
+
+    /** Check if per-category and per-entry-type row lists are maintained */
+    bool IsPartitioned() const;
+
+    /** Set the smallest number of rows an exact or quantized scan hands to one worker thread; 0 keeps scans on the calling thread */
+    void SetMinRowsPerScanChunk(int32 InMinRows);
+
+    /** Get the smallest number of rows an exact or quantized scan hands to one worker thread */
+    int32 GetMinRowsPerScanChunk() const;
+
+    /** Get the contiguous vector storage backing this database */
+    const FVectorStorage& GetVectorStorage() const { return Vectors; }
+
+    /** Get the payload of every row, in the same row order as the vector storage */
+    const FVectorPayloadStore& GetPayloads() const { return Payloads; }
+
 private:
-    UPROPERTY()
-    TArray<UVectorEntryWrapper*> Entries;
+    /** Payload of each row, held natively instead of as one UObject per entry */
+    FVectorPayloadStore Payloads;
+
+    /** Row-major vector data; row i belongs to payload row i */
+    FVectorStorage Vectors;
+
+    /** Handle of each row */
+    TArray<int64> RowHandles;
+
+    /** Row of every handle still in the database */
+    TMap<int64, int32> HandleRows;
+
+    /** Rows removed since the last compaction. Their data stays in place until then but queries never return them. */
+    TBitArray<> RemovedRows;
+
+    int32 NumRemovedRows;
+
+    /** Handle given to the next entry added; handles are never reused */
+    int64 NextHandle;
 
-    TArray<TArray<float>> Vectors;
+    float CompactionThreshold;
+
+    bool bAutoCompaction;
+
+    /** Compaction scheduled on the core ticker by the removal that crossed the threshold; reset once it runs */
+    FTSTicker::FDelegateHandle CompactionTickerHandle;
+
+    /** Interned names of every category added so far */
+    FVectorCategoryTable CategoryTable;
+
+    /** Category ID of each row, captured when the entry is added */
+    TArray<int32> RowCategories;
+
+    /** Inverted index over the Metadata of every entry, captured when the entry is added */
+    FVectorMetadataIndex MetadataIndex;
 
     EVectorDistanceMetric DistanceMetric;
 
-    float CalculateDistance(const TArray<float>& Vec1, const TArray<float>& Vec2) const;
+    FVectorIndexSettings IndexSettings;
+
+    /** Approximate index over Vectors, null when IndexType is None */
+    TUniquePtr<IVectorIndex> Index;
+
+    FVectorQuantizationSettings QuantizationSettings;
+
+    /** Compressed codes of Vectors, null when QuantizationType is None */
+    TUniquePtr<IVectorQuantizer> Quantizer;
+
+    /** Exact scans over fewer than twice this many rows stay single-threaded */
+    int32 MinRowsPerScanChunk;
+
+    bool bPartitioned;
+
+    /** Ascending rows of each (category, entry type) partition, indexed by CategoryId * entry type count + entry type */
+    TArray<TArray<int32>> PartitionRows;
+
+    float CalculateDistance(const float* Vec1, const float* Vec2, int32 Dimension) const;
+
+    /** Score Query against every row in [FirstRow, EndRow) accepted by Filter, batching rows through the SIMD kernel for the current metric. Query must be prepared by FVectorRowScorer. */
+    void ScanRows(const float* Query, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, TFunctionRef<void(int32 Row, float Distance)> Visitor) const;
+
+    /** Score every prepared query against every row in [FirstRow, EndRow) accepted by Filter, one cache-sized tile of rows at a time */
+    void ScanRowsBatch(TArrayView<const float* const> Queries, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, TArrayView<FVectorTopK> OutTopK) const;
+
+    /** Split the rows into chunks for parallel exact scans; returns the number of chunks */
+    int32 GetNumScanChunks(int32& OutRowsPerChunk) const;
+
+    /** Exact top-N over all rows for a prepared query, split across worker threads when the database is large enough */
+    void ScanTopRows(const float* Query, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const;
+
+    /** Approximate top-N over the quantizer codes of all rows, split across worker threads like ScanTopRows */
+    void ScanQuantizedRows(const float* Query, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const;
+
+    /** FindTopRows for several queries at once. Exact scans share each tile of rows between all queries. */
+    void FindTopRowsBatch(const TArray<TArray<float>>& QueryVectors, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<TArray<FVectorSearchHit>>& OutHits) const;
+
+    /** Collect the N best rows accepted by Filter, best first. Shared by all top-N query functions. Partitions, when given, hold every row Filter can accept. */
+    void FindTopRows(const TArray<float>& QueryVector, int32 N, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits, const FVectorPartitionSelection* Partitions = nullptr) const;
+
+    /** Exact top-N for a prepared query over the rows of the selected partitions only */
+    void ScanPartitionRows(const float* Query, int32 N, const FVectorPartitionSelection& Partitions, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const;
+
+    /** Gather the partitions matching a query's filters. Returns false when the query has to consider every row. */
+    bool SelectPartitions(const FVectorCategoryFilter& CategoryFilter, TOptional<EEntryType> EntryType, FVectorPartitionSelection& OutSelection) const;
+
+    void RebuildPartitions();
+
+    /**
+     * Replace the index with one saved by ExportFileContents. VectorChecksum is the checksum saved with the current
+     * rows. Returns false, leaving no index, if it does not match the settings, version or vectors.
+     */
+    bool RestoreIndex(const TArray<uint8>& IndexData, uint64 VectorChecksum);
+
+    /** Replace the quantizer with one saved by ExportFileContents. Returns false, leaving no quantizer, if it does not match the settings, version or vectors. */
+    bool RestoreQuantizer(const TArray<uint8>& QuantizerData, uint64 VectorChecksum);
+
+    /** Check that a vector can be added to the database, logging why not under the caller's name */
+    bool CanAddVector(TArrayView<const float> Vector, const TCHAR* Caller) const;
+
+    /** Add the vector of the payload row just appended to Payloads, updating the index and quantizer */
+    int64 InsertRow(TArrayView<const float> Vector, const FString& Category);
+
+    /** Append the vector of the payload row just appended to Payloads and extend every per-row structure, but not the index or quantizer */
+    int64 AppendRow(TArrayView<const float> Vector, const FString& Category);
+
+    /** Shared implementation of the bulk add functions. AddPayload appends the payload of an accepted entry to Payloads. */
+    TArray<int64> AppendEntries(int32 NumEntries, const TArray<FString>& Categories, TFunctionRef<bool(int32 Index)> IsValidEntry,
+                                TFunctionRef<TArrayView<const float>(int32 Index)> GetVector, TFunctionRef<void(int32 Index)> AddPayload);
+
+    /** Build the detailed result for a row, with a transient wrapper holding a copy of its payload */
+    FVectorDatabaseEntry MakeEntryResult(int32 Row, float Distance) const;
+
+    /** Mark a row as removed and release its payload. The row itself is only dropped by Compact. */
+    void RemoveRow(int32 Row);
+
+    /** Schedule CompactIfNeeded on the next core ticker tick if auto compaction is on and none is pending */
+    void ScheduleCompaction();
+
+    /** Estimate the fraction of rows a filter accepts from an evenly spaced sample */
+    float EstimateFilterSelectivity(TFunctionRef<bool(int32 Row)> Filter) const;
 
-    bool ShouldIncludeEntry(const UVectorEntryWrapper* Entry, const TArray<FString>& Categories) const;
+    /** Number of rows in each interned category, indexed by category ID */
+    TArray<int32> CountRowsPerCategory() const;
 
     void UpdateVectorDimension();
 };
\ No newline at end of file
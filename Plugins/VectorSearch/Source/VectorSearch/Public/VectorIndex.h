@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorStorage.h"
+#include "VectorTopK.h"
+
+enum class EVectorDistanceMetric : uint8;
+
+/** Versions of the structures written by IVectorIndex::Serialize. Saved indexes of any other version are rebuilt instead of loaded. */
+enum class EVectorIndexVersion : int32
+{
+    Initial = 1,
+
+    VersionPlusOne,
+    Latest = VersionPlusOne - 1
+};
+
+/**
+ * Interface for approximate nearest neighbour indexes attached to a UVectorDatabase.
+ * Indexes refer to vectors by their row in the database's FVectorStorage and never own vector data.
+ */
+class VECTORSEARCH_API IVectorIndex
+{
+public:
+    virtual ~IVectorIndex() {}
+
+    /** Discard the current structure and index every row of Storage using Metric */
+    virtual void Build(const FVectorStorage& Storage, EVectorDistanceMetric Metric) = 0;
+
+    /** Index a row that was just appended to Storage */
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) = 0;
+
+    /** Re-index a row whose values were just overwritten in Storage */
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) = 0;
+
+    /**
+     * Drop rows and renumber the rest. RowRemap holds the new row of every current row, or INDEX_NONE for rows
+     * being dropped; surviving rows keep their order. Called before Storage itself is compacted.
+     */
+    virtual void Compact(const FVectorStorage& Storage, TArrayView<const int32> RowRemap) = 0;
+
+    /** Find up to K rows accepted by Filter, best first */
+    virtual void Search(const FVectorStorage& Storage, const float* Query, int32 K, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutHits) const = 0;
+
+    /**
+     * Save or load the structure built over Storage, along with the metric and the build parameters it depends on.
+     * Loading replaces the current structure. It flags Ar with an error and leaves the index empty if the structure
+     * was built with other parameters than this index was created with, or does not cover exactly the rows of Storage.
+     */
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) = 0;
+
+    /** Get the number of rows covered by the index */
+    virtual int32 Num() const = 0;
+
+    /** Get the number of bytes allocated by the index structure */
+    virtual SIZE_T GetAllocatedSize() const = 0;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVectorMetadataPredicate;
+
+/**
+ * Per-key inverted index over entry metadata.
+ * String values map to ascending posting lists of rows; values that parse as numbers are also kept
+ * in a dense per-row column so range predicates are a single linear pass.
+ */
+class VECTORSEARCH_API FVectorMetadataIndex
+{
+public:
+    /** Index the metadata of a row that was just appended */
+    void AddRow(int32 Row, const TMap<FString, FString>& Metadata);
+
+    /** Re-index a row whose metadata changed from OldMetadata to NewMetadata, touching only the keys of either */
+    void UpdateRow(int32 Row, const TMap<FString, FString>& OldMetadata, const TMap<FString, FString>& NewMetadata);
+
+    /** Forget every row */
+    void Empty();
+
+    /** Get the number of rows indexed */
+    int32 Num() const { return NumRows; }
+
+    /**
+     * Combine predicates into a bitset with one bit per row, set where the row passes all of them.
+     * Returns false, leaving OutRows untouched, when there are no predicates.
+     */
+    bool Evaluate(TArrayView<const FVectorMetadataPredicate> Predicates, TBitArray<>& OutRows) const;
+
+    /** Get the number of bytes allocated by the posting lists and columns */
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FKeyPostings
+    {
+        /** Rows holding each value, ascending */
+        TMap<FString, TArray<int32>> RowsByValue;
+
+        /** Numeric value of every row, NaN where the key is missing or not a number. Empty until a numeric value is seen. */
+        TArray<double> NumericValues;
+    };
+
+    /** Set the bits of every row passing one predicate */
+    void EvaluatePredicate(const FVectorMetadataPredicate& Predicate, TBitArray<>& OutMatches) const;
+
+    TMap<FString, FKeyPostings> Keys;
+
+    int32 NumRows = 0;
+};
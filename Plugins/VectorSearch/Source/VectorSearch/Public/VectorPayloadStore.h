@@ -0,0 +1,124 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UVectorEntryWrapper;
+class FReferenceCollector;
+class FArchive;
+enum class EEntryType : uint8;
+
+/**
+ * Columnar storage for the payloads of database rows, owned by the database instead of one UObject per entry.
+ * Each row records its entry type and a slot in the value column of that type; metadata maps are only
+ * allocated for rows that have metadata. Object values, struct types and object properties inside struct
+ * values are reported to the garbage collector by the owner through AddReferencedObjects.
+ */
+class VECTORSEARCH_API FVectorPayloadStore
+{
+public:
+    FVectorPayloadStore() = default;
+    ~FVectorPayloadStore();
+
+    /** Struct values are live struct instances, so copies initialize and copy each one through its struct type */
+    FVectorPayloadStore(const FVectorPayloadStore& Other);
+    FVectorPayloadStore& operator=(const FVectorPayloadStore& Other);
+
+    /** Moving hands the struct instances over without copying them */
+    FVectorPayloadStore(FVectorPayloadStore&& Other) = default;
+    FVectorPayloadStore& operator=(FVectorPayloadStore&& Other);
+
+    /** Get the number of rows */
+    int32 Num() const { return Types.Num(); }
+
+    /** Append a string row. Returns the row index. */
+    int32 AddString(const FString& Value, const TMap<FString, FString>& Metadata);
+
+    /** Append an object row. Returns the row index. */
+    int32 AddObject(UObject* Value, const TMap<FString, FString>& Metadata);
+
+    /** Append a struct row holding a copy of the struct at StructPtr. Returns the row index. */
+    int32 AddStruct(UScriptStruct* StructType, const void* StructPtr, const TMap<FString, FString>& Metadata);
+
+    /** Append a row holding a copy of a wrapper's payload. Returns the row index. */
+    int32 AddFromWrapper(const UVectorEntryWrapper& Wrapper);
+
+    EEntryType GetType(int32 Row) const { return Types[Row]; }
+
+    /** Get the value of a string row, empty for any other type */
+    const FString& GetString(int32 Row) const;
+
+    /** Get the value of an object row, null for any other type */
+    UObject* GetObject(int32 Row) const;
+
+    /** Get the struct type of a struct row, null for any other type */
+    UScriptStruct* GetStructType(int32 Row) const;
+
+    /** Get the struct instance of a struct row, empty for any other type */
+    const TArray<uint8>& GetStructData(int32 Row) const;
+
+    /** Get the struct instance of a struct row for editing in place, null for any other type */
+    void* GetMutableStructData(int32 Row);
+
+    const TMap<FString, FString>& GetMetadata(int32 Row) const;
+
+    void SetMetadata(int32 Row, const TMap<FString, FString>& Metadata);
+
+    /** Create a wrapper holding a copy of a row's payload, outered to Outer or to the transient package */
+    UVectorEntryWrapper* MakeWrapper(int32 Row, const FString& Category, UObject* Outer = nullptr) const;
+
+    /** Free the value and metadata of a removed row. The row keeps its place until Compact. */
+    void Release(int32 Row);
+
+    /** Drop rows and renumber the rest. RowRemap holds the new row of every current row, or INDEX_NONE for rows being dropped. */
+    void Compact(TArrayView<const int32> RowRemap);
+
+    void Reserve(int32 NumRows);
+
+    /** Remove every row */
+    void Empty();
+
+    /**
+     * Save or load every row. Object values and struct types go through Ar's object serialization, so archives
+     * that cannot hold object references need a proxy that writes them as paths. Loading replaces the current rows
+     * and flags Ar with an error if the data is inconsistent.
+     */
+    void Serialize(FArchive& Ar);
+
+    /** Report object values, struct types and the object properties of struct values to the garbage collector */
+    void AddReferencedObjects(FReferenceCollector& Collector);
+
+    /** Get the number of bytes allocated by the columns, excluding string and struct contents */
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    /** Append a row to the row columns; returns its index */
+    int32 AddRow(EEntryType Type, int32 ValueSlot, const TMap<FString, FString>& Metadata);
+
+    /** Destroy the struct instance held in a struct column slot */
+    void DestroyStructValue(int32 Slot);
+
+    /** Save or load the struct instance of a struct column slot, prefixed with its size so values of missing types can be skipped */
+    void SerializeStructValue(FArchive& Ar, int32 Slot);
+
+    /** Check that every row's slots point inside their columns */
+    bool HasValidSlots() const;
+
+    TArray<EEntryType> Types;
+
+    /** Slot of each row's value in the column of its type */
+    TArray<int32> ValueSlots;
+
+    /** Slot of each row in MetadataMaps, INDEX_NONE when the row has no metadata */
+    TArray<int32> MetadataSlots;
+
+    TArray<FString> Strings;
+
+    TArray<UObject*> Objects;
+
+    TArray<UScriptStruct*> StructTypes;
+
+    /** Initialized struct instances, one per struct slot */
+    TArray<TArray<uint8>> StructValues;
+
+    TArray<TMap<FString, FString>> MetadataMaps;
+};
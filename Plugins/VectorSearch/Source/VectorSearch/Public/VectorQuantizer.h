@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorStorage.h"
+#include "VectorTopK.h"
+
+enum class EVectorDistanceMetric : uint8;
+
+/** Versions of the codes written by IVectorQuantizer::Serialize. Saved quantizers of any other version are trained again instead of loaded. */
+enum class EVectorQuantizerVersion : int32
+{
+    Initial = 1,
+
+    /** Int8 codes are counted with 64 bits so databases past 2^31 code bytes can be saved */
+    LargeScalarCodes,
+
+    VersionPlusOne,
+    Latest = VersionPlusOne - 1
+};
+
+/** Per-query state a quantizer builds once, such as PQ distance tables, and every scanned row range then reads */
+class FVectorQuantizerQuery
+{
+public:
+    virtual ~FVectorQuantizerQuery() = default;
+
+    /** Whether scan scores rank higher values first */
+    bool bHigherIsBetter = false;
+};
+
+/**
+ * Interface for compressed shadow copies of the database vectors.
+ * A quantizer keeps one compact code per storage row and answers approximate scans over the codes;
+ * the database rescores the shortlist it returns against the full-precision rows.
+ */
+class VECTORSEARCH_API IVectorQuantizer
+{
+public:
+    virtual ~IVectorQuantizer() {}
+
+    /** Learn the code parameters from Storage using Metric, then encode every row */
+    virtual void Train(const FVectorStorage& Storage, EVectorDistanceMetric Metric) = 0;
+
+    /** Encode a row that was just appended to Storage. Trains first if enough rows have accumulated. */
+    virtual void AddRow(const FVectorStorage& Storage, int32 Row) = 0;
+
+    /** Re-encode a row whose values were just overwritten in Storage. Safe to call concurrently for different rows. */
+    virtual void UpdateRow(const FVectorStorage& Storage, int32 Row) = 0;
+
+    /** Drop rows and renumber the rest. RowRemap holds the new row of every current row, or INDEX_NONE for rows being dropped. */
+    virtual void Compact(TArrayView<const int32> RowRemap) = 0;
+
+    /** Build the state ScanRows reads for Query. The quantizer must be trained. */
+    virtual TUniquePtr<FVectorQuantizerQuery> PrepareQuery(const float* Query) const = 0;
+
+    /**
+     * Approximately score the rows in [FirstRow, EndRow) accepted by Filter and offer them to TopK, which must rank in
+     * the direction PreparedQuery reports. Safe to call concurrently on disjoint ranges with their own collectors.
+     */
+    virtual void ScanRows(const FVectorQuantizerQuery& PreparedQuery, int32 FirstRow, int32 EndRow, TFunctionRef<bool(int32 Row)> Filter, FVectorTopK& TopK) const = 0;
+
+    /** Approximately rank the rows accepted by Filter and return up to NumCandidates of them, best first, on the calling thread */
+    void Scan(const float* Query, int32 NumCandidates, TFunctionRef<bool(int32 Row)> Filter, TArray<FVectorSearchHit>& OutCandidates) const
+    {
+        OutCandidates.Reset();
+
+        if (!IsTrained() || NumCandidates <= 0)
+        {
+            return;
+        }
+
+        const TUniquePtr<FVectorQuantizerQuery> PreparedQuery = PrepareQuery(Query);
+        FVectorTopK TopK(NumCandidates, PreparedQuery->bHigherIsBetter);
+        ScanRows(*PreparedQuery, 0, Num(), Filter, TopK);
+        TopK.GetSortedHits(OutCandidates);
+    }
+
+    /**
+     * Save or load the trained code parameters and the code of every row of Storage, along with the metric they were
+     * trained for. Loading replaces the current codes. It flags Ar with an error and leaves the quantizer untrained if
+     * the codes were trained with other parameters than this quantizer was created with, or do not encode exactly the
+     * rows of Storage.
+     */
+    virtual void Serialize(FArchive& Ar, const FVectorStorage& Storage) = 0;
+
+    /** Check whether the code parameters have been learned and every row is encoded */
+    virtual bool IsTrained() const = 0;
+
+    /** Check whether scan scores are only a ranking proxy and must always be rescored */
+    virtual bool RequiresRescore() const { return false; }
+
+    /** Get the number of encoded rows */
+    virtual int32 Num() const = 0;
+
+    /** Get the number of bytes used by codes and code parameters */
+    virtual SIZE_T GetAllocatedSize() const = 0;
+};
@@ -15,13 +15,21 @@ public:
     static UVectorDatabase* CreateVectorDatabase();
 
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
-    static void AddStringEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, FString Entry, FString Category);
+    static int64 AddStringEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, FString Entry, FString Category);
 
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
-    static void AddObjectEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, UObject* Entry, FString Category);
+    static int64 AddObjectEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, UObject* Entry, FString Category);
+
+    /** Add many string entries in one call. PackedVectors holds the vectors back to back; Categories holds one per entry, one for all, or none. */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database", meta = (AutoCreateRefTerm = "Categories"))
+    static TArray<int64> AddStringEntriesToVectorDatabase(UVectorDatabase* Database, const TArray<float>& PackedVectors, const TArray<FString>& Entries, const TArray<FString>& Categories);
+
+    /** Add many object entries in one call. PackedVectors holds the vectors back to back; Categories holds one per entry, one for all, or none. */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database", meta = (AutoCreateRefTerm = "Categories"))
+    static TArray<int64> AddObjectEntriesToVectorDatabase(UVectorDatabase* Database, const TArray<float>& PackedVectors, const TArray<UObject*>& Entries, const TArray<FString>& Categories);
 
     UFUNCTION(BlueprintCallable, CustomThunk, Category = "Vector Database", meta = (CustomStructureParam = "StructValue"))
-    static void AddStructEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, const int32& StructValue, FString Category);
+    static int64 AddStructEntryToVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, const int32& StructValue, FString Category);
 
     UFUNCTION(BlueprintCallable, Category = "Vector Database", meta = (AutoCreateRefTerm = "Categories"))
     static TArray<FString> GetTopNStringMatches(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories);
@@ -47,9 +55,30 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static bool RemoveEntryFromVectorDatabase(UVectorDatabase* Database, const TArray<float>& Vector, bool bRemoveAllOccurrences = false, float RemovalRange = 0.0f);
 
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool RemoveEntryFromVectorDatabaseByHandle(UVectorDatabase* Database, int64 Handle);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool UpdateVectorDatabaseEntryVector(UVectorDatabase* Database, int64 Handle, const TArray<float>& Vector);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static int32 UpdateVectorDatabaseEntryVectors(UVectorDatabase* Database, const TArray<FVectorEntryUpdate>& Updates);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static bool VectorDatabaseContainsHandle(UVectorDatabase* Database, int64 Handle);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool SetVectorDatabaseEntryMetadata(UVectorDatabase* Database, int64 Handle, const TMap<FString, FString>& Metadata);
+
     UFUNCTION(BlueprintCallable, Category = "Vector Database", meta = (AutoCreateRefTerm = "Categories"))
     static TArray<FVectorDatabaseEntry> GetTopNEntriesWithDetails(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const TArray<FString>& Categories);
 
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static TArray<FVectorDatabaseEntry> GetTopNEntriesFiltered(UVectorDatabase* Database, const TArray<float>& QueryVector, int32 N, const FVectorSearchFilter& Filter);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database", meta = (AutoCreateRefTerm = "Categories"))
+    static TArray<FVectorSearchQueryResult> GetTopNMatchesBatch(UVectorDatabase* Database, const TArray<FVectorSearchQuery>& Queries, int32 N, const TArray<FString>& Categories);
+
     UFUNCTION(BlueprintCallable, CustomThunk, Category = "Vector Database", meta = (CustomStructureParam = "OutStruct"))
     static void GetStructFromVectorDatabaseEntry(const FVectorDatabaseEntry& Entry, int32& OutStruct);
 
@@ -65,6 +94,14 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static bool LoadVectorDatabaseFromFile(UVectorDatabaseAsset* Asset, const FString& FilePath);
 
+    /** Write the asset to a human-readable JSON file; Save Vector Database To File writes the much smaller binary format */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool ExportVectorDatabaseToJsonFile(UVectorDatabaseAsset* Asset, const FString& FilePath);
+
+    /** Open a binary database file read-only without loading its vectors: they are memory-mapped and read from disk as queries touch them. Returns null on failure. */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static UVectorDatabase* OpenVectorDatabaseFileMapped(const FString& FilePath);
+
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static TArray<FString> GetUniqueCategoriesFromDatabase(UVectorDatabase* Database);
 
@@ -95,9 +132,77 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static void NormalizeVectorsInDatabase(UVectorDatabase* Database);
 
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static bool AreVectorDatabaseVectorsNormalized(UVectorDatabase* Database);
+
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static FVectorDatabaseStats GetVectorDatabaseStats(UVectorDatabase* Database);
 
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseStoragePrecision(UVectorDatabase* Database, EVectorStoragePrecision Precision);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static EVectorStoragePrecision GetVectorDatabaseStoragePrecision(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseIndexSettings(UVectorDatabase* Database, const FVectorIndexSettings& Settings);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static FVectorIndexSettings GetVectorDatabaseIndexSettings(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void RebuildVectorDatabaseIndex(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseQuantizationSettings(UVectorDatabase* Database, const FVectorQuantizationSettings& Settings);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static FVectorQuantizationSettings GetVectorDatabaseQuantizationSettings(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void RetrainVectorDatabaseQuantizer(UVectorDatabase* Database);
+
+    /** Keep only the quantizer codes in memory by moving the full-precision rows to a memory-mapped scratch file; adding or updating entries copies them back */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool MoveVectorDatabaseVectorsToFile(UVectorDatabase* Database, const FString& FilePath);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void RebuildVectorDatabaseMetadataIndex(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabasePartitioned(UVectorDatabase* Database, bool bPartitioned);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static bool IsVectorDatabasePartitioned(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseMinRowsPerScanChunk(UVectorDatabase* Database, int32 MinRows);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static int32 GetVectorDatabaseMinRowsPerScanChunk(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void CompactVectorDatabase(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static bool CompactVectorDatabaseIfNeeded(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static bool DoesVectorDatabaseNeedCompaction(UVectorDatabase* Database);
+
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseCompactionThreshold(UVectorDatabase* Database, float Threshold);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static float GetVectorDatabaseCompactionThreshold(UVectorDatabase* Database);
+
+    /** Compact on the tick after removals cross the compaction threshold (on by default); turn off to only compact when you call Compact Vector Database */
+    UFUNCTION(BlueprintCallable, Category = "Vector Database")
+    static void SetVectorDatabaseAutoCompaction(UVectorDatabase* Database, bool bAutoCompaction);
+
+    UFUNCTION(BlueprintPure, Category = "Vector Database")
+    static bool IsVectorDatabaseAutoCompactionEnabled(UVectorDatabase* Database);
+
     UFUNCTION(BlueprintCallable, Category = "Vector Database")
     static TArray<FString> GetUniqueCategoriesFromAsset(UVectorDatabaseAsset* Asset);
 
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16.h"
+
+enum class EVectorStoragePrecision : uint8;
+
+/** A bfloat16 value: the upper 16 bits of an IEEE single-precision float */
+struct FVectorBFloat16
+{
+    uint16 Encoded;
+};
+
+/** Owner of read-only row memory a storage reads in place, such as a memory-mapped file region. Kept alive for as long as a storage uses it. */
+class IVectorStorageMemory
+{
+public:
+    virtual ~IVectorStorageMemory() = default;
+};
+
+/**
+ * Contiguous, row-major storage for fixed-dimension vectors.
+ * All rows live in a single aligned buffer; each row starts on an Alignment boundary
+ * and consecutive rows are GetStride() elements apart. Elements are float32, fp16 or bf16
+ * depending on the precision; values are always read and written as floats.
+ * The L2 norm of every row is cached as it is written, so cosine scoring only needs a dot product per row.
+ * Rows can also be read in place from external memory (see AttachExternalRows); they are copied into the
+ * storage's own buffer the first time the storage is modified.
+ */
+struct VECTORSEARCH_API FVectorStorage
+{
+public:
+    /** Alignment in bytes of the buffer and of the start of every row */
+    static constexpr int32 Alignment = 64;
+
+    /** Largest distance of a row norm from 1 for the row to count as unit length */
+    static constexpr float UnitNormTolerance = 1e-3f;
+
+    FVectorStorage();
+
+    /** Get the number of rows stored */
+    int32 Num() const { return NumRows; }
+
+    /** Get the dimension shared by every row, 0 while the storage is empty */
+    int32 GetDimension() const { return Dimension; }
+
+    /** Get the distance in elements between the start of two consecutive rows */
+    int32 GetStride() const { return Stride; }
+
+    /** Get the distance in bytes between the start of two consecutive rows */
+    int32 GetStrideInBytes() const { return Stride * ElementSize; }
+
+    /** Get the element type of the rows */
+    EVectorStoragePrecision GetPrecision() const { return Precision; }
+
+    /** Change the element type, converting any rows already stored */
+    void SetPrecision(EVectorStoragePrecision InPrecision);
+
+    /** Fix the row dimension. Only valid while the storage is empty. */
+    void SetDimension(int32 InDimension);
+
+    /** Reserve memory for the given number of rows (the dimension must be set) */
+    void Reserve(int32 NumRowsToReserve);
+
+    /** Append a row. The first row fixes the dimension. Returns the row index, or INDEX_NONE on dimension mismatch. */
+    int32 Add(TArrayView<const float> Vector);
+
+    /** Overwrite the values of a row */
+    void SetRow(int32 Row, TArrayView<const float> Vector);
+
+    /** Remove a row, shifting all following rows down by one */
+    void RemoveAt(int32 Row);
+
+    /** Drop many rows in one pass. RowRemap holds the new row of every current row, or INDEX_NONE for rows being dropped. */
+    void Compact(TArrayView<const int32> RowRemap);
+
+    /** Remove all rows and reset the dimension. The precision is kept. */
+    void Empty();
+
+    /** Get a pointer to the first element of a row, whatever the precision */
+    const uint8* GetRawRowData(int32 Row) const
+    {
+        check(Row >= 0 && Row < NumRows);
+        return GetRowBuffer() + static_cast<SIZE_T>(Row) * Stride * ElementSize;
+    }
+
+    /** Get a pointer to the first element of a row. Only valid for Float32 storage. */
+    const float* GetRowData(int32 Row) const
+    {
+        check(ElementSize == sizeof(float));
+        return reinterpret_cast<const float*>(GetRawRowData(Row));
+    }
+
+    /** Get a writable pointer to the first element of a row. Only valid for Float32 storage; writes through it do not update the cached norm. */
+    float* GetRowData(int32 Row)
+    {
+        check(ElementSize == sizeof(float));
+        CopyExternalRows();
+        return reinterpret_cast<float*>(const_cast<uint8*>(GetRawRowData(Row)));
+    }
+
+    /** Get a row as floats: points straight into Float32 storage, otherwise decodes the row into Scratch */
+    const float* GetRowAsFloat(int32 Row, TArray<float>& Scratch) const;
+
+    /** Convert a row to floats (Dimension elements) */
+    void DecodeRow(int32 Row, float* OutVector) const;
+
+    /** Copy a row out into a standalone array */
+    TArray<float> CopyRow(int32 Row) const;
+
+    /** Check whether a row holds exactly the given values once they are rounded to the storage precision */
+    bool RowEquals(int32 Row, TArrayView<const float> Vector) const;
+
+    /** Get the L2 norm of a row, as stored (after rounding to the storage precision) */
+    float GetRowNorm(int32 Row) const
+    {
+        check(Row >= 0 && Row < NumRows);
+        return Norms[Row];
+    }
+
+    /** Get the cached L2 norm of every row */
+    TArrayView<const float> GetRowNorms() const { return Norms; }
+
+    /** Check whether every row has unit length, so cosine similarity equals the dot product with a unit query */
+    bool AreRowsNormalized() const { return NumNonUnitRows == 0; }
+
+    /** Get the base of the row buffer. Only valid for Float32 storage. */
+    const float* GetData() const
+    {
+        check(ElementSize == sizeof(float));
+        return reinterpret_cast<const float*>(GetRowBuffer());
+    }
+
+    /** Get the row buffer as bytes: Num() rows of GetStrideInBytes() bytes each, padding included */
+    TArrayView64<const uint8> GetRawData() const { return TArrayView64<const uint8>(GetRowBuffer(), GetRowsSize(NumRows)); }
+
+    /**
+     * Replace every row with InNumRows rows read from Ar in the layout GetRawData exposes, at the current precision.
+     * RowNorms holds the norm of every row, or is empty to recompute them from the loaded rows.
+     * Returns false and leaves the storage empty if Ar fails.
+     */
+    bool LoadRawData(FArchive& Ar, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms = TArrayView<const float>());
+
+    /** Replace every row with a copy of InNumRows rows at Rows, in the layout GetRawData exposes. RowNorms is used as in LoadRawData. */
+    void CopyRawData(const uint8* Rows, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms = TArrayView<const float>());
+
+    /**
+     * Replace every row with InNumRows rows read in place from Rows, in the layout GetRawData exposes at the current precision.
+     * Rows must start on an Alignment boundary and stay valid while Memory is alive; the storage keeps Memory until it
+     * is emptied or modified. RowNorms holds the norm of every row, or is empty to compute them, which reads every row.
+     */
+    void AttachExternalRows(const TSharedRef<IVectorStorageMemory>& Memory, const uint8* Rows, int32 InDimension, int32 InNumRows, TArrayView<const float> RowNorms);
+
+    /** Hash the dimension, the precision and the elements of every row, ignoring row padding, to identify the stored vectors */
+    uint64 ComputeChecksum() const;
+
+    /** Check whether the rows are read in place from external memory rather than from the storage's own buffer */
+    bool HasExternalRows() const { return ExternalRows != nullptr; }
+
+    /** Get the number of bytes allocated for vector data; external rows are not counted */
+    SIZE_T GetAllocatedSize() const { return Data.GetAllocatedSize() + Norms.GetAllocatedSize(); }
+
+private:
+    /** Convert Dimension floats into the storage element type */
+    void EncodeRow(const float* Vector, uint8* OutRow) const;
+
+    /** Compute the L2 norm of a row from its stored elements */
+    float ComputeRowNorm(int32 Row) const;
+
+    /** Take over the norms of freshly loaded rows, or compute them when RowNorms is empty */
+    void SetRowNorms(TArrayView<const float> RowNorms);
+
+    static bool IsUnitNorm(float Norm) { return FMath::Abs(Norm - 1.0f) <= UnitNormTolerance; }
+
+    /** Get the size in bytes of the given number of rows. 64-bit, since large databases hold more than 2 GiB of rows. */
+    int64 GetRowsSize(int32 InNumRows) const { return static_cast<int64>(InNumRows) * Stride * ElementSize; }
+
+    /** Get the start of the rows, external or owned */
+    const uint8* GetRowBuffer() const { return ExternalRows ? ExternalRows : Data.GetData(); }
+
+    /** Copy external rows into Data so they can be modified, and let go of the external memory */
+    void CopyExternalRows();
+
+    /** Heap policy for Data: every allocation is aligned for row access */
+    struct FRowMalloc
+    {
+        static void* Realloc(void* Ptr, SIZE_T Size, uint32 InAlignment = DEFAULT_ALIGNMENT)
+        {
+            return FMemory::Realloc(Ptr, Size, FMath::Max<uint32>(InAlignment, Alignment));
+        }
+
+        static void Free(void* Ptr)
+        {
+            FMemory::Free(Ptr);
+        }
+    };
+
+    /** Owned rows, with a 64-bit size so the buffer can grow past 2 GiB */
+    TArray<uint8, TSizedHeapAllocator<64, FRowMalloc>> Data;
+
+    /** Rows read in place instead of Data, null when the storage owns its rows */
+    const uint8* ExternalRows;
+
+    /** Keeps ExternalRows alive */
+    TSharedPtr<IVectorStorageMemory> ExternalMemory;
+
+    EVectorStoragePrecision Precision;
+
+    /** Size in bytes of one element for the current precision */
+    int32 ElementSize;
+
+    int32 Dimension;
+
+    int32 Stride;
+
+    int32 NumRows;
+
+    /** L2 norm of each row */
+    TArray<float> Norms;
+
+    /** Number of rows whose norm is not within UnitNormTolerance of 1 */
+    int32 NumNonUnitRows;
+};
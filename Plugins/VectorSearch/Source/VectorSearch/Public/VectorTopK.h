@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A scored row returned by a search */
+struct FVectorSearchHit
+{
+    /** Row index in the database storage */
+    int32 Row;
+
+    /** Metric value for the row (a distance or a similarity, depending on the metric) */
+    float Distance;
+
+    FVectorSearchHit()
+        : Row(INDEX_NONE),
+          Distance(0.0f)
+    {
+    }
+
+    FVectorSearchHit(int32 InRow, float InDistance)
+        : Row(InRow),
+          Distance(InDistance)
+    {
+    }
+};
+
+/**
+ * Bounded top-K collector.
+ * Keeps only the K best hits seen so far in a heap whose top is the current worst hit,
+ * so each candidate costs O(1) to reject and O(log K) to accept.
+ */
+class VECTORSEARCH_API FVectorTopK
+{
+public:
+    FVectorTopK()
+        : K(0),
+          bHigherIsBetter(false)
+    {
+    }
+
+    FVectorTopK(int32 InK, bool bInHigherIsBetter)
+    {
+        Reset(InK, bInHigherIsBetter);
+    }
+
+    /** Clear the collector and set how many hits to keep and which direction is better */
+    void Reset(int32 InK, bool bInHigherIsBetter);
+
+    /** Offer a candidate; it is kept only if it ranks among the best K so far */
+    void Add(int32 Row, float Distance)
+    {
+        if (Heap.Num() < K)
+        {
+            Heap.HeapPush(FVectorSearchHit(Row, Distance), FWorseFirst(bHigherIsBetter));
+        }
+        else if (K > 0 && IsBetter(Distance, Row, Heap.HeapTop()))
+        {
+            Heap.HeapPopDiscard(FWorseFirst(bHigherIsBetter), false);
+            Heap.HeapPush(FVectorSearchHit(Row, Distance), FWorseFirst(bHigherIsBetter));
+        }
+    }
+
+    /** Check whether a candidate with this value could still enter the result */
+    bool WouldAccept(float Distance) const
+    {
+        if (Heap.Num() < K)
+        {
+            return K > 0;
+        }
+        return bHigherIsBetter ? Distance > Heap.HeapTop().Distance : Distance < Heap.HeapTop().Distance;
+    }
+
+    /** Check whether the collector already holds K hits */
+    bool IsFull() const { return Heap.Num() >= K; }
+
+    /** Get the worst hit currently kept. Only valid when Num() > 0. */
+    const FVectorSearchHit& GetWorst() const { return Heap.HeapTop(); }
+
+    /** Get the number of hits currently kept */
+    int32 Num() const { return Heap.Num(); }
+
+    /** Get the maximum number of hits kept */
+    int32 GetK() const { return K; }
+
+    /** Check which direction ranks better */
+    bool IsHigherBetter() const { return bHigherIsBetter; }
+
+    /** Offer every hit from another collector */
+    void Merge(const FVectorTopK& Other);
+
+    /** Copy the kept hits out, best first. The collector is left untouched. */
+    void GetSortedHits(TArray<FVectorSearchHit>& OutHits) const;
+
+private:
+    /** Most hits Reset reserves room for up front */
+    static constexpr int32 MaxReservedHits = 1024;
+
+    /** Heap predicate placing the worst hit at the top; ties are broken on row index for deterministic results */
+    struct FWorseFirst
+    {
+        bool bHigherIsBetter;
+
+        explicit FWorseFirst(bool bInHigherIsBetter)
+            : bHigherIsBetter(bInHigherIsBetter)
+        {
+        }
+
+        bool operator()(const FVectorSearchHit& A, const FVectorSearchHit& B) const
+        {
+            if (A.Distance != B.Distance)
+            {
+                return bHigherIsBetter ? A.Distance < B.Distance : A.Distance > B.Distance;
+            }
+            return A.Row > B.Row;
+        }
+    };
+
+    bool IsBetter(float Distance, int32 Row, const FVectorSearchHit& Other) const
+    {
+        return FWorseFirst(bHigherIsBetter)(Other, FVectorSearchHit(Row, Distance));
+    }
+
+    TArray<FVectorSearchHit> Heap;
+
+    int32 K;
+
+    bool bHigherIsBetter;
+};
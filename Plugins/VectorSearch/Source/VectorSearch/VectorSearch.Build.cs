@@ -47,6 +47,12 @@ public class VectorSearch : ModuleRules
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
+
+		// Assets cache the index and quantizer they cook with in the derived data cache
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
 		
 		
 		DynamicallyLoadedModuleNames.AddRange(